@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GattClient.h"
+
+// Stands in for a probe's GATT server on the host: has the temperature
+// characteristic at `handles` and counts the round trips made to it.
+class FakeGattClient final : public GattClient {
+public:
+  explicit FakeGattClient(const ProbeHandles &handles, bool is_supported = true)
+      : handles_(handles), is_supported_(is_supported) {}
+
+  bool discover(ProbeHandles *handles) override {
+    ++discover_count;
+    round_trips += kDiscoveryRoundTrips;
+    if (handles_.value_handle == 0) {
+      return false;
+    }
+    *handles = handles_;
+    return true;
+  }
+
+  bool isSupported() override {
+    ++round_trips; // Reads the device name
+    return is_supported_;
+  }
+
+  bool enableNotify(const ProbeHandles &handles) override {
+    ++round_trips;
+    is_subscribed = handles.value_handle == handles_.value_handle &&
+                    handles.cccd_handle == handles_.cccd_handle;
+    return is_subscribed;
+  }
+
+  // Service, characteristics and descriptors, one request each.
+  static constexpr int kDiscoveryRoundTrips = 3;
+
+  int discover_count = 0;
+  int round_trips = 0;
+  bool is_subscribed = false;
+
+private:
+  const ProbeHandles handles_;
+  const bool is_supported_;
+};
@@ -0,0 +1,112 @@
+#include "LogDecoder.h"
+#include "BinaryLogger.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Reverses the Consistent Overhead Byte Stuffing of a frame without its
+// delimiter. Returns false if the frame is malformed.
+bool decodeFrame(const std::vector<uint8_t> &frame,
+                 std::vector<uint8_t> &record) {
+  record.clear();
+  for (size_t index = 0; index < frame.size();) {
+    uint8_t code = frame[index++];
+    if (code == 0 || index + code - 1 > frame.size()) {
+      return false;
+    }
+    record.insert(record.end(), &frame[index], &frame[index] + code - 1);
+    index += code - 1;
+    if (code != 0xFF && index != frame.size()) {
+      record.push_back(0);
+    }
+  }
+  return true;
+}
+
+template <typename T> T readValue(const std::vector<uint8_t> &record) {
+  T value;
+  std::memcpy(&value, &record[1], sizeof(value));
+  return value;
+}
+
+} // namespace
+
+LogDecoder::LogDecoder(Resolver resolve) : resolve_(std::move(resolve)) {}
+
+std::string LogDecoder::decode(const uint8_t *data, size_t size) {
+  std::string text;
+  for (const uint8_t *it = data; it != data + size; ++it) {
+    if (*it != 0) {
+      frame_.push_back(*it);
+      continue;
+    }
+    if (!frame_.empty()) {
+      decodeRecord(text);
+    }
+    frame_.clear();
+  }
+  return text;
+}
+
+void LogDecoder::decodeRecord(std::string &text) {
+  using Tag = BinaryLogger::Tag;
+
+  std::vector<uint8_t> record;
+  if (!decodeFrame(frame_, record) || record.empty()) {
+    ++error_count_;
+    return;
+  }
+
+  size_t payload_size = record.size() - 1;
+  char buffer[32];
+  switch (static_cast<Tag>(record[0])) {
+  case Tag::kLiteral:
+    if (payload_size == sizeof(uint32_t)) {
+      uint32_t address = readValue<uint32_t>(record);
+      if (auto literal = resolve_(address)) {
+        text += *literal;
+      } else {
+        snprintf(buffer, sizeof(buffer), "<literal 0x%08x>", address);
+        text += buffer;
+      }
+      return;
+    }
+    break;
+  case Tag::kText:
+    if (payload_size <= BinaryLogger::kMaxTextLength) {
+      text.append(record.begin() + 1, record.end());
+      return;
+    }
+    break;
+  case Tag::kLong:
+    if (payload_size == sizeof(int32_t)) {
+      text += std::to_string(readValue<int32_t>(record));
+      return;
+    }
+    break;
+  case Tag::kUnsignedLong:
+    if (payload_size == sizeof(uint32_t)) {
+      text += std::to_string(readValue<uint32_t>(record));
+      return;
+    }
+    break;
+  case Tag::kFloat:
+    if (payload_size == sizeof(float)) {
+      // Same as Arduino's Print::print(float).
+      snprintf(buffer, sizeof(buffer), "%.2f", readValue<float>(record));
+      text += buffer;
+      return;
+    }
+    break;
+  case Tag::kLost:
+    if (payload_size == sizeof(uint32_t)) {
+      snprintf(buffer, sizeof(buffer), "<%u records lost>",
+               readValue<uint32_t>(record));
+      text += buffer;
+      return;
+    }
+    break;
+  }
+  ++error_count_;
+}
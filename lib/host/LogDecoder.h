@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Turns the stream of a BinaryLogger back into text. String literals are
+// looked up by address through `resolve`, typically in the firmware ELF.
+class LogDecoder {
+public:
+  using Resolver = std::function<std::optional<std::string>(uint32_t)>;
+
+  explicit LogDecoder(Resolver resolve);
+
+  // Decodes the complete records in `data` and returns their text. Bytes of
+  // a trailing partial record are kept for the next call.
+  std::string decode(const uint8_t *data, size_t size);
+
+  // Records that could not be decoded, e.g. from joining mid-record.
+  size_t getErrorCount() const { return error_count_; }
+
+private:
+  void decodeRecord(std::string &text);
+
+  Resolver resolve_;
+  std::vector<uint8_t> frame_;
+  size_t error_count_ = 0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Logger.h"
+
+// Discards everything, and disables logging so that log statements skip
+// formatting their arguments. Never changes after construction, so one
+// instance can serve any number of threads.
+class NullLogger final : public Logger {
+public:
+  NullLogger() { setLevel(LogLevel::kNone); }
+
+  void log(const char *, size_t) override {}
+  void log(long) override {}
+  void log(unsigned long) override {}
+  void log(float) override {}
+};
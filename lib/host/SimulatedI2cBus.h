@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Clock.h"
+#include "I2cBus.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Stands in for an I2C controller on the host: each write completes
+// `latency_ms` after it started, by the given clock, and may be made to fail.
+class SimulatedI2cBus final : public I2cBus {
+public:
+  struct Transfer {
+    uint8_t address;
+    std::vector<uint8_t> data;
+  };
+
+  SimulatedI2cBus(const Clock &clock, uint32_t latency_ms)
+      : clock_(clock), latency_ms_(latency_ms) {}
+
+  // The next writes end with these instead of kOk, in order.
+  void failNext(Status status) { failures_.push_back(status); }
+
+  bool startWrite(uint8_t address, const uint8_t *data,
+                  size_t size) override {
+    if (getStatus() == Status::kBusy || size > kMaxWriteSize) {
+      return false;
+    }
+    started_.push_back({address, std::vector<uint8_t>(data, data + size)});
+    start_ms_ = clock_.millis();
+    is_busy_ = true;
+    return true;
+  }
+
+  Status getStatus() override {
+    if (is_busy_ && clock_.millis() - start_ms_ >= latency_ms_) {
+      is_busy_ = false;
+      status_ = Status::kOk;
+      if (!failures_.empty()) {
+        status_ = failures_.front();
+        failures_.pop_front();
+      } else {
+        completed_.push_back(started_.back());
+      }
+    }
+    return is_busy_ ? Status::kBusy : status_;
+  }
+
+  // Every write started, and every one that succeeded.
+  const std::vector<Transfer> &getStarted() const { return started_; }
+  const std::vector<Transfer> &getCompleted() const { return completed_; }
+
+private:
+  const Clock &clock_;
+  const uint32_t latency_ms_;
+
+  std::deque<Status> failures_;
+  std::vector<Transfer> started_;
+  std::vector<Transfer> completed_;
+  uint32_t start_ms_ = 0;
+  bool is_busy_ = false;
+  Status status_ = Status::kOk;
+};
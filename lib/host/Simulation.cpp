@@ -0,0 +1,134 @@
+#include "Simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+Simulation::Simulation(const Scenario &scenario, Logger &log,
+                       TraceWriter *trace)
+    : scenario_(scenario), context_{clock_, log}, trace_(trace),
+      plant_(scenario.plant),
+      stove_(scenario.throttle, scenario.stove.base_power_ratio),
+      rng_(scenario.seed), traced_dial_pin_(dial_pin_, trace),
+      traced_potentiometer_(potentiometer_, trace),
+      traced_bypass_pin_(bypass_pin_, trace),
+      traced_thermometer_(thermometer_, trace),
+      actuator_(context_, traced_potentiometer_, traced_bypass_pin_,
+                scenario.throttle),
+      dial_(context_, traced_dial_pin_, scenario.throttle),
+      beeper_(context_, buzzer_),
+      regression_(context_), kalman_(context_, scenario.kalman),
+      estimator_(scenario.estimator == EstimatorType::kKalman
+                     ? static_cast<TemperatureEstimator &>(kalman_)
+                     : regression_),
+      traced_estimator_(estimator_, trace),
+      controller_(context_, estimator_, scenario.thermal),
+      autotuner_(context_, scenario.autotune_config),
+      supervisor_(context_, dial_, actuator_, controller_, beeper_, estimator_,
+                  traced_thermometer_, autotuner_, scenario.stove,
+                  scenario.throttle) {
+  // As the firmware does in setup().
+  actuator_.setBypass();
+
+  if (trace_) {
+    TraceHeader header;
+    header.estimator = scenario.estimator == EstimatorType::kKalman;
+    header.kalman = scenario.kalman;
+    header.thermal = scenario.thermal;
+    header.stove = scenario.stove;
+    header.throttle = scenario.throttle;
+    header.autotune = scenario.autotune_config;
+    trace_->header(header);
+  }
+}
+
+void Simulation::step() {
+  const uint32_t now_ms = clock_.millis();
+  const StoveConfig &stove = scenario_.stove;
+  const ThrottleConfig &throttle = scenario_.throttle;
+
+  if (scenario_.autotune && now_ms >= kFlickStartMs && now_ms < kFlickEndMs) {
+    dial_pin_.value = throttle.max;
+  } else if (now_ms < kActivationMs) {
+    dial_pin_.value = (throttle.boil + 1.0f) / 2;
+  } else {
+    float position = (scenario_.target_temp - stove.min_temp_c) /
+                     (stove.max_temp_c - stove.min_temp_c);
+    dial_pin_.value = std::clamp(position, 0.0f, 1.0f) * throttle.max;
+  }
+
+  if (trace_) {
+    trace_->update(now_ms);
+  }
+  supervisor_.update();
+  if (trace_) {
+    trace_->state(supervisor_.getState());
+  }
+
+  stove_.setKnob(isBypass() ? dial_pin_.value : potentiometer_.value);
+  plant_.setPower(stove_.getPower());
+  plant_.step(kTickMs);
+
+  if (!thermometer_.is_started) {
+    next_probe_ms_ = now_ms;
+  } else if (static_cast<int32_t>(now_ms - next_probe_ms_) >= 0) {
+    std::uniform_real_distribution<float> noise(-scenario_.plant.probe_noise,
+                                                scenario_.plant.probe_noise);
+    traced_estimator_.addReading(plant_.getProbeTemp() + noise(rng_), now_ms);
+    next_probe_ms_ += scenario_.plant.probe_period_ms;
+  }
+
+  float temp = plant_.getTemp();
+  float error = temp - scenario_.target_temp;
+  result_.energy_wh += plant_.getBurnerPowerW() * kTickMs / 3600e3f;
+  result_.final_temp = temp;
+  if (result_.rise_time_ms == 0 && error > -1.0f) {
+    result_.rise_time_ms = now_ms;
+  }
+  if (result_.rise_time_ms != 0) {
+    result_.overshoot = std::max(result_.overshoot, error);
+    squared_error_sum_ += error * error;
+    ++error_samples_;
+    result_.rms_error = std::sqrt(squared_error_sum_ / error_samples_);
+  }
+
+  if (TemperatureEstimator::Estimate estimate = estimator_.getEstimate();
+      estimate.count != 0) {
+    float estimate_error = estimate.getValue(now_ms) - plant_.getProbeTemp();
+    squared_estimate_error_sum_ += estimate_error * estimate_error;
+    ++estimate_error_samples_;
+    result_.estimate_rms_error =
+        std::sqrt(squared_estimate_error_sum_ / estimate_error_samples_);
+  }
+
+  clock_.advance(kTickMs);
+}
+
+SimulationResult Simulation::run() {
+  while (clock_.millis() < scenario_.duration_ms) {
+    step();
+  }
+  return result_;
+}
+
+std::vector<SimulationResult>
+runScenarios(const std::vector<Scenario> &scenarios, Logger &log) {
+  std::vector<SimulationResult> results(scenarios.size());
+  std::atomic<size_t> next_index{0};
+
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < scenarios.size(); i = next_index++) {
+      results[i] = Simulation(scenarios[i], log).run();
+    }
+  };
+
+  std::vector<std::thread> threads(
+      std::max(1u, std::thread::hardware_concurrency()));
+  for (auto &thread : threads) {
+    thread = std::thread(worker);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return results;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "AnalogReadPin.h"
+#include "Beeper.h"
+#include "Buzzer.h"
+#include "Context.h"
+#include "DigitalWritePin.h"
+#include "KalmanEstimator.h"
+#include "Potentiometer.h"
+#include "RelayAutotuner.h"
+#include "StoveActuator.h"
+#include "StoveDial.h"
+#include "StoveSupervisor.h"
+#include "ThermalController.h"
+#include "ThermalPlant.h"
+#include "Thermometer.h"
+#include "Trace.h"
+#include "TracingDevices.h"
+#include "TrendAnalyzer.h"
+#include "VirtualClock.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+enum class EstimatorType { kRegression, kKalman };
+
+// A cooking session: the operator turns the knob to auto, then to the target.
+struct Scenario {
+  PlantConfig plant;
+  EstimatorType estimator = EstimatorType::kRegression;
+  KalmanConfig kalman;
+  ThermalConfig thermal;
+  bool autotune = false; // Flick the knob off auto and back to start one
+  AutotuneConfig autotune_config;
+  StoveConfig stove;
+  ThrottleConfig throttle;
+  float target_temp = 90.0f;                   // Set with the knob (°C)
+  uint32_t duration_ms = 2 * 60 * 60 * 1000;   // Session length
+  uint32_t seed = 1;                           // Probe noise
+};
+
+struct SimulationResult {
+  uint32_t rise_time_ms = 0; // First time within 1°C of target, 0 if never
+  float overshoot = 0.0f;    // Peak temperature above target (°C)
+  float rms_error = 0.0f;    // Error after the rise (°C)
+  float estimate_rms_error = 0.0f; // Estimate against the noise-free probe
+  float energy_wh = 0.0f;    // Burner output over the session
+  float final_temp = 0.0f;
+};
+
+// Runs the real control stack against a ThermalPlant on a virtual clock.
+// Simulations share no state, so any number can run on parallel threads.
+class Simulation {
+  class DialPin final : public AnalogReadPin {
+  public:
+    float read() const override { return value; }
+    float value = 0.0f;
+  };
+
+  class SimPotentiometer final : public Potentiometer {
+  public:
+    void setValue(float new_value) override { value = new_value; }
+    float value = 0.0f;
+  };
+
+  class BypassPin final : public DigitalWritePin {
+  public:
+    void set(PinState new_state) const override { state = new_state; }
+    mutable PinState state = PinState::Low;
+  };
+
+  class SilentBuzzer final : public Buzzer {
+  public:
+    void play(const Pattern &) override {}
+    void stop() override {}
+  };
+
+  class SimThermometer final : public Thermometer {
+  public:
+    void start() override { is_started = true; }
+    void stop() override { is_started = false; }
+    bool connected() override { return is_started; }
+    bool is_started = false;
+  };
+
+public:
+  // Period of the firmware main loop.
+  static constexpr uint32_t kTickMs = 10;
+  // How long the operator holds the knob at auto before setting the target.
+  static constexpr uint32_t kActivationMs = 4000;
+  // When the operator flicks the knob off auto for an autotune.
+  static constexpr uint32_t kFlickStartMs = 1000;
+  static constexpr uint32_t kFlickEndMs = 1500;
+
+  // Records the session to `trace` if given.
+  Simulation(const Scenario &scenario, Logger &log,
+             TraceWriter *trace = nullptr);
+
+  // Advances the session by one main loop iteration.
+  void step();
+  SimulationResult run();
+
+  uint32_t getTimeMs() const { return clock_.millis(); }
+  const ThermalPlant &getPlant() const { return plant_; }
+  const ThermalController &getController() const { return controller_; }
+  float getKnob() const { return dial_pin_.value; }
+  bool isBypass() const { return bypass_pin_.state == PinState::Low; }
+  const SimulationResult &getResult() const { return result_; }
+
+private:
+  const Scenario scenario_;
+  VirtualClock clock_;
+  const Context context_;
+  TraceWriter *const trace_;
+
+  ThermalPlant plant_;
+  StoveModel stove_;
+  std::minstd_rand rng_;
+  uint32_t next_probe_ms_ = 0;
+
+  DialPin dial_pin_;
+  SimPotentiometer potentiometer_;
+  BypassPin bypass_pin_;
+  SilentBuzzer buzzer_;
+  SimThermometer thermometer_;
+  TracingDialPin traced_dial_pin_;
+  TracingPotentiometer traced_potentiometer_;
+  TracingBypassPin traced_bypass_pin_;
+  TracingThermometer traced_thermometer_;
+
+  StoveActuator actuator_;
+  StoveDial dial_;
+  Beeper beeper_;
+  TrendAnalyzer regression_;
+  KalmanEstimator kalman_;
+  TemperatureEstimator &estimator_;
+  TracingEstimator traced_estimator_;
+  ThermalController controller_;
+  RelayAutotuner autotuner_;
+  StoveSupervisor supervisor_;
+
+  SimulationResult result_;
+  double squared_error_sum_ = 0.0;
+  uint32_t error_samples_ = 0;
+  double squared_estimate_error_sum_ = 0.0;
+  uint32_t estimate_error_samples_ = 0;
+};
+
+// Runs every scenario to completion, spread over all cores. The logger is
+// shared by all threads.
+std::vector<SimulationResult>
+runScenarios(const std::vector<Scenario> &scenarios, Logger &log);
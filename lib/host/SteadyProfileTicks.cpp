@@ -0,0 +1,10 @@
+#include "Profiler.h"
+#include <chrono>
+
+// Nanoseconds on the host, wrapping like the DWT counter does.
+uint32_t readProfileTicks() {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "AnalogReadPin.h"
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+// Stands in for a sampling pin on the host: hands out queued blocks of
+// synthetic samples, one per readBlock(), as a DMA double buffer would.
+class SyntheticAnalogReadPin final : public AnalogReadPin {
+public:
+  void pushBlock(std::vector<float> block) {
+    blocks_.push_back(std::move(block));
+  }
+
+  // The newest sample handed out.
+  float read() const override { return last_; }
+
+  size_t readBlock(float *samples, size_t size) const override {
+    if (blocks_.empty()) {
+      return 0;
+    }
+    const std::vector<float> &block = blocks_.front();
+    size_t count = std::min(size, block.size());
+    // Like a short destination, keeps the newest samples.
+    std::copy(block.end() - count, block.end(), samples);
+    if (count > 0) {
+      last_ = samples[count - 1];
+    }
+    blocks_.pop_front();
+    return count;
+  }
+
+private:
+  mutable std::deque<std::vector<float>> blocks_;
+  mutable float last_ = 0.0f;
+};
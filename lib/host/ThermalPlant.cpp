@@ -0,0 +1,51 @@
+#include "ThermalPlant.h"
+#include <algorithm>
+#include <cmath>
+
+StoveModel::StoveModel(const ThrottleConfig &throttle_config,
+                       float base_power_ratio)
+    : config_(throttle_config), base_power_ratio_(base_power_ratio) {}
+
+void StoveModel::setKnob(float value) {
+  if (value > config_.boost) {
+    if (is_armed_) {
+      boost_ = std::min(boost_ + 1, config_.num_boosts);
+    }
+    is_armed_ = false;
+  } else if (value < config_.arm) {
+    is_armed_ = true;
+  }
+
+  if (value < config_.max) {
+    level_ = value < config_.min ? 0.0f : value / config_.max;
+    boost_ = 0;
+  } else {
+    level_ = 1.0f;
+  }
+}
+
+float StoveModel::getPower() const {
+  float boost_power = config_.num_boosts > 0
+                          ? static_cast<float>(boost_) / config_.num_boosts
+                          : 0.0f;
+  return level_ * base_power_ratio_ +
+         boost_power * (1.0f - base_power_ratio_);
+}
+
+ThermalPlant::ThermalPlant(const PlantConfig &config)
+    : config_(config), temp_(config.ambient_temp),
+      probe_temp_(config.ambient_temp) {}
+
+void ThermalPlant::step(uint32_t dt_ms) {
+  float target_w = std::clamp(power_, 0.0f, 1.0f) * config_.max_power_w;
+  burner_w_ += (target_w - burner_w_) *
+               (1.0f - std::exp(-(dt_ms / config_.burner_lag_ms)));
+
+  float loss_w = (temp_ - config_.ambient_temp) * config_.heat_loss_w_per_k;
+  float heat_j = (burner_w_ * config_.efficiency - loss_w) * dt_ms / 1000.0f;
+  temp_ = std::min(temp_ + heat_j / config_.heat_capacity_j_per_k,
+                   config_.boiling_temp);
+
+  probe_temp_ += (temp_ - probe_temp_) *
+                 (1.0f - std::exp(-(dt_ms / config_.probe_lag_ms)));
+}
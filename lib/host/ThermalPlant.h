@@ -0,0 +1,61 @@
+#pragma once
+
+#include "StoveThrottle.h"
+#include <cstdint>
+
+// Physical parameters of a pot on a burner, observed through a probe.
+struct PlantConfig {
+  float max_power_w = 2000.0f;           // Burner output at full boost (W)
+  float efficiency = 0.8f;               // Share of the output into the pot
+  float burner_lag_ms = 15000.0f;        // Time constant of the burner (ms)
+  float heat_capacity_j_per_k = 9000.0f; // Pot and contents, 2 l of water (J/K)
+  float heat_loss_w_per_k = 8.0f;        // Loss to the surroundings (W/K)
+  float boiling_temp = 100.0f;           // Contents do not heat beyond (°C)
+  float probe_lag_ms = 4000.0f;          // Time constant of the probe (ms)
+  uint32_t probe_period_ms = 1000;       // Interval between notifications
+  float probe_noise = 0.05f;             // Peak noise of a probe reading (°C)
+  float ambient_temp = 20.0f;            // Ambient and initial temperature (°C)
+};
+
+// The stove electronics behind the knob: the signal maps linearly to a level
+// up to max, each swing from below arm to above boost adds a boost, and
+// dropping below max cancels them.
+class StoveModel {
+public:
+  StoveModel(const ThrottleConfig &throttle_config, float base_power_ratio);
+
+  void setKnob(float value);
+
+  // Fraction of the maximum burner power currently requested.
+  float getPower() const;
+
+private:
+  const ThrottleConfig config_;
+  const float base_power_ratio_;
+
+  float level_ = 0.0f;
+  uint32_t boost_ = 0;
+  bool is_armed_ = false;
+};
+
+// Lumped thermal model: the burner output lags the requested power, the pot
+// integrates it minus losses, and the probe lags the pot contents.
+class ThermalPlant {
+public:
+  explicit ThermalPlant(const PlantConfig &config);
+
+  void setPower(float power) { power_ = power; }
+  void step(uint32_t dt_ms);
+
+  float getTemp() const { return temp_; }
+  float getProbeTemp() const { return probe_temp_; }
+  float getBurnerPowerW() const { return burner_w_; }
+
+private:
+  const PlantConfig config_;
+
+  float power_ = 0.0f;
+  float burner_w_ = 0.0f;
+  float temp_;
+  float probe_temp_;
+};
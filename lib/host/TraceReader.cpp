@@ -0,0 +1,142 @@
+#include "TraceReader.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Payload size by tag, 0 for unknown tags.
+size_t getPayloadSize(TraceTag tag) {
+  switch (tag) {
+  case TraceTag::kTime:
+    return 4;
+  case TraceTag::kTick:
+    return 2;
+  case TraceTag::kReading:
+    return 8;
+  case TraceTag::kDial:
+  case TraceTag::kTarget:
+  case TraceTag::kPotentiometer:
+  case TraceTag::kLost:
+    return 4;
+  case TraceTag::kConnected:
+  case TraceTag::kBypass:
+  case TraceTag::kState:
+    return 1;
+  }
+  return 0;
+}
+
+template <typename T> T load(const uint8_t *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+} // namespace
+
+std::string TraceRecord::toString() const {
+  char text[64];
+  switch (tag) {
+  case TraceTag::kTime:
+  case TraceTag::kTick:
+    snprintf(text, sizeof(text), "update at %ums", time_ms);
+    break;
+  case TraceTag::kReading:
+    snprintf(text, sizeof(text), "reading %.9g at %ums", value, time_ms);
+    break;
+  case TraceTag::kDial:
+    snprintf(text, sizeof(text), "dial %.9g", value);
+    break;
+  case TraceTag::kConnected:
+    snprintf(text, sizeof(text), "connected %u", integer);
+    break;
+  case TraceTag::kTarget:
+    snprintf(text, sizeof(text), "target %.9g", value);
+    break;
+  case TraceTag::kPotentiometer:
+    snprintf(text, sizeof(text), "potentiometer %.9g", value);
+    break;
+  case TraceTag::kBypass:
+    snprintf(text, sizeof(text), "bypass %s", integer ? "high" : "low");
+    break;
+  case TraceTag::kState:
+    snprintf(text, sizeof(text), "state %s",
+             StoveSupervisor::getStateName(
+                 static_cast<StoveSupervisor::State>(integer)));
+    break;
+  case TraceTag::kLost:
+    snprintf(text, sizeof(text), "%u records lost", integer);
+    break;
+  }
+  return text;
+}
+
+bool TraceReader::readHeader(TraceHeader *header) {
+  if (size_ - offset_ < sizeof(TraceHeader)) {
+    error_ = "Truncated header";
+    return false;
+  }
+  std::memcpy(static_cast<void *>(header), data_ + offset_, sizeof(*header));
+  if (header->magic != kTraceMagic) {
+    error_ = "Not a trace";
+    return false;
+  }
+  if (header->version != kTraceVersion || header->size != sizeof(TraceHeader)) {
+    error_ = "Unsupported trace version";
+    return false;
+  }
+  offset_ += sizeof(TraceHeader);
+  return true;
+}
+
+bool TraceReader::next(TraceRecord *record) {
+  if (offset_ == size_) {
+    return false;
+  }
+  const uint8_t *data = data_ + offset_;
+  TraceTag tag = static_cast<TraceTag>(data[0]);
+  size_t payload_size = getPayloadSize(tag);
+  if (payload_size == 0) {
+    error_ = "Unknown record";
+    return false;
+  }
+  if (size_ - offset_ < 1 + payload_size) {
+    error_ = "Truncated record";
+    return false;
+  }
+
+  *record = {};
+  record->tag = tag;
+  record->data = data;
+  record->size = 1 + payload_size;
+  const uint8_t *payload = data + 1;
+  switch (tag) {
+  case TraceTag::kTime:
+    time_ms_ = load<uint32_t>(payload);
+    record->time_ms = time_ms_;
+    break;
+  case TraceTag::kTick:
+    time_ms_ += load<uint16_t>(payload);
+    record->time_ms = time_ms_;
+    break;
+  case TraceTag::kReading:
+    record->value = load<float>(payload);
+    record->time_ms = load<uint32_t>(payload + 4);
+    break;
+  case TraceTag::kDial:
+  case TraceTag::kTarget:
+  case TraceTag::kPotentiometer:
+    record->value = load<float>(payload);
+    break;
+  case TraceTag::kLost:
+    record->integer = load<uint32_t>(payload);
+    break;
+  case TraceTag::kConnected:
+  case TraceTag::kBypass:
+  case TraceTag::kState:
+    record->integer = payload[0];
+    break;
+  }
+  offset_ += record->size;
+  return true;
+}
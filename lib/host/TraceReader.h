@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Trace.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// One decoded trace record.
+struct TraceRecord {
+  TraceTag tag = TraceTag::kLost;
+  uint32_t time_ms = 0;  // kTime, kTick: of the update; kReading
+  float value = 0.0f;    // kReading, kDial, kTarget, kPotentiometer
+  uint32_t integer = 0;  // kConnected, kBypass, kState, kLost
+  const uint8_t *data = nullptr; // The encoded record
+  size_t size = 0;
+
+  bool isUpdate() const {
+    return tag == TraceTag::kTime || tag == TraceTag::kTick;
+  }
+  bool isOutput() const {
+    return tag == TraceTag::kPotentiometer || tag == TraceTag::kBypass ||
+           tag == TraceTag::kState;
+  }
+  std::string toString() const;
+};
+
+// Decodes a trace in place, typically from a memory-mapped file.
+class TraceReader {
+public:
+  TraceReader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  // Checks and copies the header at the start of the trace.
+  bool readHeader(TraceHeader *header);
+
+  // Returns false at the end of the trace, or on an error.
+  bool next(TraceRecord *record);
+
+  // Describes why the last call failed, or nullptr.
+  const char *getError() const { return error_; }
+  size_t getOffset() const { return offset_; }
+
+private:
+  const uint8_t *const data_;
+  const size_t size_;
+  size_t offset_ = 0;
+  uint32_t time_ms_ = 0;
+  const char *error_ = nullptr;
+};
@@ -0,0 +1,270 @@
+#include "TraceReplay.h"
+#include "Beeper.h"
+#include "Buzzer.h"
+#include "KalmanEstimator.h"
+#include "RelayAutotuner.h"
+#include "StoveActuator.h"
+#include "StoveDial.h"
+#include "StoveSupervisor.h"
+#include "ThermalController.h"
+#include "TraceReader.h"
+#include "TracingDevices.h"
+#include "TrendAnalyzer.h"
+#include "VectorTraceWriter.h"
+#include "VirtualClock.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <thread>
+
+namespace {
+
+constexpr size_t kMaxDiffs = 10;
+
+// Plays back recorded samples, holding the last one.
+template <typename T> class Playback {
+public:
+  void push(T value) { pending_.push_back(value); }
+  T next() {
+    if (!pending_.empty()) {
+      value_ = pending_.front();
+      pending_.pop_front();
+    }
+    return value_;
+  }
+
+private:
+  std::deque<T> pending_;
+  T value_ = {};
+};
+
+class ReplayDialPin final : public AnalogReadPin {
+public:
+  float read() const override { return samples.next(); }
+  mutable Playback<float> samples;
+};
+
+class ReplayThermometer final : public Thermometer {
+public:
+  void start() override {}
+  void stop() override {}
+  bool connected() override { return samples.next(); }
+  Playback<bool> samples;
+};
+
+class NullPotentiometer final : public Potentiometer {
+public:
+  void setValue(float) override {}
+};
+
+class NullPin final : public DigitalWritePin {
+public:
+  void set(PinState) const override {}
+};
+
+class SilentBuzzer final : public Buzzer {
+public:
+  void play(const Pattern &) override {}
+  void stop() override {}
+};
+
+// The control stack as the firmware builds it, with the outputs traced the
+// same way.
+class Replay {
+public:
+  Replay(const TraceHeader &header, Logger &log)
+      : context_{clock_, log},
+        potentiometer_(null_potentiometer_, &outputs_),
+        bypass_pin_(null_pin_, &outputs_),
+        actuator_(context_, potentiometer_, bypass_pin_, header.throttle),
+        dial_(context_, dial_pin_, header.throttle),
+        beeper_(context_, buzzer_), regression_(context_),
+        kalman_(context_, header.kalman),
+        estimator_(header.estimator == 1
+                       ? static_cast<TemperatureEstimator &>(kalman_)
+                       : regression_),
+        controller_(context_, estimator_, header.thermal),
+        autotuner_(context_, header.autotune),
+        supervisor_(context_, dial_, actuator_, controller_, beeper_,
+                    estimator_, thermometer_, autotuner_, header.stove,
+                    header.throttle) {
+    // As in setup(), before the recording starts.
+    actuator_.setBypass();
+    outputs_.header(header);
+    outputs_offset_ = outputs_.getData().size();
+  }
+
+  ReplayResult run(TraceReader &reader);
+
+private:
+  void replayUpdate(uint32_t time_ms, const std::vector<TraceRecord> &span,
+                    ReplayResult &result);
+  void applyInput(const TraceRecord &record);
+
+  VirtualClock clock_;
+  const Context context_;
+  VectorTraceWriter outputs_;
+  size_t outputs_offset_ = 0;
+
+  ReplayDialPin dial_pin_;
+  ReplayThermometer thermometer_;
+  NullPotentiometer null_potentiometer_;
+  NullPin null_pin_;
+  SilentBuzzer buzzer_;
+  TracingPotentiometer potentiometer_;
+  TracingBypassPin bypass_pin_;
+
+  StoveActuator actuator_;
+  StoveDial dial_;
+  Beeper beeper_;
+  TrendAnalyzer regression_;
+  KalmanEstimator kalman_;
+  TemperatureEstimator &estimator_;
+  ThermalController controller_;
+  RelayAutotuner autotuner_;
+  StoveSupervisor supervisor_;
+};
+
+ReplayResult Replay::run(TraceReader &reader) {
+  ReplayResult result;
+  std::vector<TraceRecord> span;
+  TraceRecord record;
+  bool has_record = reader.next(&record);
+
+  // Inputs ahead of the first update.
+  for (; has_record && !record.isUpdate(); has_record = reader.next(&record)) {
+    ++result.records;
+    applyInput(record);
+  }
+
+  bool has_first_update = has_record;
+  uint32_t first_update_ms = record.time_ms;
+  while (has_record) {
+    ++result.records;
+    uint32_t time_ms = record.time_ms;
+    span.clear();
+    while ((has_record = reader.next(&record)) && !record.isUpdate()) {
+      ++result.records;
+      span.push_back(record);
+    }
+    replayUpdate(time_ms, span, result);
+    result.duration_ms = time_ms - first_update_ms;
+
+    if (!span.empty() && span.back().tag == TraceTag::kLost) {
+      result.error = "Trace breaks off at " + std::to_string(time_ms) + "ms";
+      return result;
+    }
+  }
+
+  if (reader.getError()) {
+    result.error = std::string(reader.getError()) + " at offset " +
+                   std::to_string(reader.getOffset());
+  } else if (!has_first_update) {
+    result.error = "No updates";
+  }
+  return result;
+}
+
+void Replay::replayUpdate(uint32_t time_ms,
+                          const std::vector<TraceRecord> &span,
+                          ReplayResult &result) {
+  // Samples read during the update are recorded after its mark.
+  for (const TraceRecord &record : span) {
+    if (record.tag == TraceTag::kDial) {
+      dial_pin_.samples.push(record.value);
+    } else if (record.tag == TraceTag::kConnected) {
+      thermometer_.samples.push(record.integer != 0);
+    }
+  }
+
+  clock_.set(time_ms);
+  supervisor_.update();
+  outputs_.state(supervisor_.getState());
+  ++result.updates;
+
+  // Diff the outputs of the update against the recording.
+  const std::vector<uint8_t> &data = outputs_.getData();
+  TraceReader actual(data.data() + outputs_offset_,
+                     data.size() - outputs_offset_);
+  outputs_offset_ = data.size();
+  TraceRecord actual_record;
+  bool has_actual = actual.next(&actual_record);
+  for (const TraceRecord &expected : span) {
+    if (!expected.isOutput()) {
+      continue;
+    }
+    bool matches = has_actual && actual_record.size == expected.size &&
+                   std::memcmp(actual_record.data, expected.data,
+                               expected.size) == 0;
+    if (!matches) {
+      ++result.mismatches;
+      if (result.diffs.size() < kMaxDiffs) {
+        result.diffs.push_back(
+            std::to_string(time_ms) + "ms: expected " + expected.toString() +
+            ", got " + (has_actual ? actual_record.toString() : "nothing"));
+      }
+    }
+    has_actual = has_actual && actual.next(&actual_record);
+  }
+  for (; has_actual; has_actual = actual.next(&actual_record)) {
+    ++result.mismatches;
+    if (result.diffs.size() < kMaxDiffs) {
+      result.diffs.push_back(std::to_string(time_ms) +
+                             "ms: expected nothing, got " +
+                             actual_record.toString());
+    }
+  }
+
+  for (const TraceRecord &record : span) {
+    applyInput(record);
+  }
+}
+
+void Replay::applyInput(const TraceRecord &record) {
+  switch (record.tag) {
+  case TraceTag::kReading:
+    estimator_.addReading(record.value, record.time_ms);
+    break;
+  case TraceTag::kTarget:
+    controller_.setTargetTemp(record.value);
+    break;
+  default:
+    break;
+  }
+}
+
+} // namespace
+
+ReplayResult replayTrace(const uint8_t *data, size_t size, Logger &log) {
+  TraceReader reader(data, size);
+  TraceHeader header;
+  if (!reader.readHeader(&header)) {
+    ReplayResult result;
+    result.error = reader.getError();
+    return result;
+  }
+  return Replay(header, log).run(reader);
+}
+
+std::vector<ReplayResult> replayTraces(const std::vector<TraceData> &traces,
+                                       Logger &log) {
+  std::vector<ReplayResult> results(traces.size());
+  std::atomic<size_t> next_index{0};
+
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < traces.size(); i = next_index++) {
+      results[i] = replayTrace(traces[i].data, traces[i].size, log);
+    }
+  };
+
+  std::vector<std::thread> threads(
+      std::max(1u, std::thread::hardware_concurrency()));
+  for (auto &thread : threads) {
+    thread = std::thread(worker);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return results;
+}
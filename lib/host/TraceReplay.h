@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Logger.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ReplayResult {
+  std::string error;        // Why the replay stopped early, empty if it did not
+  uint32_t updates = 0;     // StoveSupervisor updates replayed
+  uint32_t records = 0;     // Trace records read
+  uint32_t duration_ms = 0; // From the first to the last update
+  uint32_t mismatches = 0;  // Outputs that differ from the recording
+  std::vector<std::string> diffs; // The first few mismatches
+};
+
+// Runs a recorded session through the control stack again: feeds the
+// recorded inputs at the recorded times, and compares the outputs against
+// the recording. The trace is read in place and must outlive the call.
+ReplayResult replayTrace(const uint8_t *data, size_t size, Logger &log);
+
+struct TraceData {
+  const uint8_t *data;
+  size_t size;
+};
+
+// Replays every trace, spread over all cores. The logger is shared by all
+// threads.
+std::vector<ReplayResult> replayTraces(const std::vector<TraceData> &traces,
+                                       Logger &log);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Trace.h"
+#include <cstdint>
+#include <vector>
+
+// Collects a trace in memory.
+class VectorTraceWriter final : public TraceWriter {
+public:
+  const std::vector<uint8_t> &getData() const { return data_; }
+
+protected:
+  void write(const uint8_t *data, size_t size) override {
+    data_.insert(data_.end(), data, data + size);
+  }
+
+private:
+  std::vector<uint8_t> data_;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Clock.h"
+#include <cstdint>
+
+// A clock that only moves when told to.
+class VirtualClock final : public Clock {
+public:
+  uint32_t millis() const override { return now_ms_; }
+
+  void set(uint32_t now_ms) { now_ms_ = now_ms; }
+  void advance(uint32_t duration_ms) { now_ms_ += duration_ms; }
+
+private:
+  uint32_t now_ms_ = 0;
+};
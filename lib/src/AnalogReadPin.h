@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 class AnalogReadPin {
@@ -7,4 +8,24 @@ public:
     virtual ~AnalogReadPin() = default;
 
     virtual float read() const = 0;
+
+    // Moves up to `size` samples converted since the last call to
+    // `samples`, oldest first and scaled like read(). Returns how many, 0 if
+    // none are new. Pins that convert on demand return one fresh read().
+    virtual size_t readBlock(float *samples, size_t size) const {
+        if (size == 0) {
+            return 0;
+        }
+        samples[0] = read();
+        return 1;
+    }
 };
+
+// Mean of a block of samples, the same wherever a block is reduced.
+inline float averageBlock(const float *samples, size_t count) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        sum += samples[i];
+    }
+    return sum / count;
+}
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "Buzzer.h"
+#include "Context.h"
+#include "Pattern.h"
 #include <cstdint>
 #include <sys/types.h>
 
+// Hands each signal to the buzzer as a whole pattern, which it plays on its
+// own, so the loop need not wake for the steps of a beep.
 class Beeper {
 public:
   enum class Signal : uint8_t {
@@ -13,16 +17,14 @@ public:
     ERROR,
   };
 
-  explicit Beeper(Buzzer &buzzer);
+  Beeper(const Context &context, Buzzer &buzzer);
   virtual ~Beeper() = default;
 
   virtual void beep(Signal signal);
 
-  virtual void update();
+  static const Pattern &getPattern(Signal signal);
 
 private:
+  Logger &log_;
   Buzzer &buzzer_;
-
-  uint8_t step_ = 0;
-  uint32_t step_end_ms_ = 0;
 };
@@ -0,0 +1,124 @@
+#include "BinaryLogger.h"
+#include <algorithm>
+
+namespace {
+
+// Tag, payload, COBS overhead byte and delimiter.
+constexpr size_t kMaxFrameLength = 1 + BinaryLogger::kMaxTextLength + 2;
+
+// Consistent Overhead Byte Stuffing: replaces the zero bytes of `data` so
+// that zero can delimit frames. Returns the length written to `frame`,
+// including the delimiter.
+size_t encodeFrame(const uint8_t *data, size_t length, uint8_t *frame) {
+  size_t code_index = 0;
+  size_t index = 1;
+  uint8_t code = 1;
+  for (const uint8_t *it = data; it != data + length; ++it) {
+    if (*it != 0) {
+      frame[index++] = *it;
+      ++code;
+    }
+    if (*it == 0 || code == 0xFF) {
+      frame[code_index] = code;
+      code_index = index++;
+      code = 1;
+    }
+  }
+  frame[code_index] = code;
+  frame[index++] = 0;
+  return index;
+}
+
+} // namespace
+
+void BinaryLogger::log(const char *msg, size_t length) {
+  do {
+    size_t chunk = std::min(length, kMaxTextLength);
+    write(Tag::kText, msg, chunk);
+    msg += chunk;
+    length -= chunk;
+  } while (length > 0);
+}
+
+void BinaryLogger::logLiteral(const char *msg, size_t) {
+  uint32_t address = reinterpret_cast<uintptr_t>(msg);
+  write(Tag::kLiteral, &address, sizeof(address));
+}
+
+void BinaryLogger::log(long val) {
+  int32_t value = val;
+  write(Tag::kLong, &value, sizeof(value));
+}
+
+void BinaryLogger::log(unsigned long val) {
+  uint32_t value = val;
+  write(Tag::kUnsignedLong, &value, sizeof(value));
+}
+
+void BinaryLogger::log(float val) {
+  static_assert(sizeof(float) == 4);
+  write(Tag::kFloat, &val, sizeof(val));
+}
+
+void BinaryLogger::write(Tag tag, const void *payload, size_t length) {
+  // Encode before taking the lock to keep it short.
+  std::array<uint8_t, 1 + kMaxTextLength> record;
+  record[0] = static_cast<uint8_t>(tag);
+  std::copy_n(static_cast<const uint8_t *>(payload), length, &record[1]);
+  std::array<uint8_t, kMaxFrameLength> frame;
+  size_t frame_length = encodeFrame(record.data(), 1 + length, frame.data());
+
+  if (lock_.test_and_set(std::memory_order_acquire)) {
+    lost_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  if (uint32_t lost = lost_.exchange(0, std::memory_order_relaxed)) {
+    std::array<uint8_t, 1 + sizeof(lost)> lost_record;
+    lost_record[0] = static_cast<uint8_t>(Tag::kLost);
+    std::copy_n(reinterpret_cast<const uint8_t *>(&lost), sizeof(lost),
+                &lost_record[1]);
+    std::array<uint8_t, 2 + lost_record.size()> lost_frame;
+    size_t lost_frame_length = encodeFrame(
+        lost_record.data(), lost_record.size(), lost_frame.data());
+    if (!push(lost_frame.data(), lost_frame_length)) {
+      lost_.fetch_add(lost, std::memory_order_relaxed);
+    }
+  }
+
+  if (!push(frame.data(), frame_length)) {
+    lost_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  lock_.clear(std::memory_order_release);
+}
+
+bool BinaryLogger::push(const uint8_t *frame, size_t length) {
+  size_t size = size_.load(std::memory_order_relaxed);
+  if (kCapacity - size < length) {
+    return false;
+  }
+  size_t tail = (head_ + size) % kCapacity;
+  size_t first = std::min(length, kCapacity - tail);
+  std::copy_n(frame, first, &buffer_[tail]);
+  std::copy_n(frame + first, length - first, buffer_.begin());
+  size_.store(size + length, std::memory_order_relaxed);
+  return true;
+}
+
+size_t BinaryLogger::read(uint8_t *data, size_t size) {
+  if (lock_.test_and_set(std::memory_order_acquire)) {
+    return 0;
+  }
+
+  size_t length = std::min(size, size_.load(std::memory_order_relaxed));
+  size_t first = std::min(length, kCapacity - head_);
+  std::copy_n(&buffer_[head_], first, data);
+  std::copy_n(buffer_.begin(), length - first, data + first);
+  head_ = (head_ + length) % kCapacity;
+  size_.store(size_.load(std::memory_order_relaxed) - length,
+              std::memory_order_relaxed);
+
+  lock_.clear(std::memory_order_release);
+  return length;
+}
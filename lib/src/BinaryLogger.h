@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Logger.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Logs compact binary records into a RAM ring buffer instead of formatting
+// text. String literals are stored by address and numbers as raw 32-bit
+// values; tools/logdecode turns the stream back into text using the firmware
+// ELF. The buffer is drained with read() from idle time.
+//
+// Each record is a tag byte plus a little-endian payload, COBS encoded and
+// terminated by a zero byte, so a decoder can join the stream at any point.
+//
+// Safe to call from multiple tasks. A record that finds the buffer full or
+// in use by another task is dropped and counted instead of blocking.
+class BinaryLogger final : public Logger {
+public:
+  enum class Tag : uint8_t {
+    kLiteral = 1,      // uint32_t address of a string literal
+    kText = 2,         // Bytes of a string, up to kMaxTextLength
+    kLong = 3,         // int32_t
+    kUnsignedLong = 4, // uint32_t
+    kFloat = 5,        // IEEE 754 single
+    kLost = 6,         // uint32_t number of records dropped before this one
+  };
+
+  static constexpr size_t kCapacity = 4096;
+  static constexpr size_t kMaxTextLength = 64;
+
+  void log(const char *msg, size_t length) override;
+  void logLiteral(const char *msg, size_t length) override;
+  void log(long val) override;
+  void log(unsigned long val) override;
+  void log(float val) override;
+
+  // Moves up to `size` bytes of the encoded stream to `data`. Returns the
+  // number of bytes moved.
+  size_t read(uint8_t *data, size_t size);
+
+  size_t available() const { return size_.load(std::memory_order_relaxed); }
+
+private:
+  void write(Tag tag, const void *payload, size_t length);
+  bool push(const uint8_t *frame, size_t length);
+
+  std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+  std::atomic<uint32_t> lost_ = 0;
+
+  std::array<uint8_t, kCapacity> buffer_;
+  size_t head_ = 0;
+  std::atomic<size_t> size_ = 0;
+};
@@ -1,49 +1,36 @@
 #include "Blinker.h"
-#include "DigitalWritePin.h"
 #include "Logger.h"
 #include <cstdint>
-#include <iterator>
-#include <limits>
 
-extern "C" uint32_t millis();
+namespace {
 
-Blinker::Blinker(DigitalWritePin &led) : led_(led) {}
+constexpr auto ONCE_STEPS = once(hold(Led::kOn, 100));
+constexpr auto REPEAT_STEPS = loop(hold(Led::kOn, 100), hold(Led::kOff, 1000));
+static_assert(isPlayable(ONCE_STEPS));
+static_assert(isPlayable(REPEAT_STEPS));
 
-void Blinker::blink(Signal signal) {
-  Log << "Blinker::blink(" << static_cast<uint32_t>(signal) << ")\n";
-  step_ = static_cast<uint8_t>(signal);
-  step_end_ms_ = millis();
-  update();
-}
-
-void Blinker::update() {
-
-  static constexpr struct {
-    uint16_t duration_ms;
-    PinState pin_state;
-    uint8_t next_step;
-  } STATES[] = {
-      // None
-      {0, PinState::High, 255},
-      // Once
-      {100, PinState::Low, 0},
-      // Repeat
-      {100, PinState::Low, 3},
-      {1000, PinState::High, 2},
-  };
-
-  uint32_t now = millis();
-  while (step_ < std::size(STATES)) {
+// By Signal
+constexpr Pattern PATTERNS[] = {
+    {nullptr, 0, false},
+    ONCE_STEPS.get(),
+    REPEAT_STEPS.get(),
+};
 
-    if (now - step_end_ms_ > std::numeric_limits<int32_t>::max()) {
-      return;
-    }
+} // namespace
 
-    auto state = STATES[step_];
+Blinker::Blinker(const Context &context, Led &led)
+    : log_(context.log), led_(led) {}
 
-    led_.set(state.pin_state);
-
-    step_ = state.next_step;
-    step_end_ms_ = now + state.duration_ms;
+void Blinker::blink(Signal signal) {
+  LOG_DEBUG(log_, kSignal) << "Blinker::blink(" << static_cast<uint32_t>(signal)
+                           << ")\n";
+  if (signal == Signal::NONE) {
+    led_.stop();
+  } else {
+    led_.play(getPattern(signal));
   }
 }
+
+const Pattern &Blinker::getPattern(Signal signal) {
+  return PATTERNS[static_cast<size_t>(signal)];
+}
@@ -1,9 +1,12 @@
 #pragma once
 
-#include "DigitalWritePin.h"
+#include "Context.h"
+#include "Led.h"
+#include "Pattern.h"
 #include <cstdint>
 #include <sys/types.h>
 
+// Hands each signal to the LED as a whole pattern, which it plays on its own.
 class Blinker final {
 public:
   enum class Signal : uint8_t {
@@ -12,14 +15,13 @@ public:
     REPEAT,
   };
 
-  explicit Blinker(DigitalWritePin &led);
+  Blinker(const Context &context, Led &led);
 
   void blink(Signal signal);
-  void update();
 
-private:
-  DigitalWritePin &led_;
+  static const Pattern &getPattern(Signal signal);
 
-  uint8_t step_ = 0;
-  uint32_t step_end_ms_ = 0;
+private:
+  Logger &log_;
+  Led &led_;
 };
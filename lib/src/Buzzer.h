@@ -1,12 +1,15 @@
 #pragma once
 
+#include "Pattern.h"
 #include <cstdint>
 
 class Buzzer {
 public:
   virtual ~Buzzer() = default;
 
-  virtual void enable(int32_t frequency_hz) = 0;
+  // Replaces whatever plays. Values are frequencies in Hz, 0 for silence;
+  // the buzzer is silent at the end of a pattern that does not repeat.
+  virtual void play(const Pattern &tones) = 0;
 
-  virtual void disable() = 0;
+  virtual void stop() = 0;
 };
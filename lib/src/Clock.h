@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+class Clock {
+public:
+  virtual ~Clock() = default;
+
+  // Milliseconds since an arbitrary epoch, wrapping around.
+  virtual uint32_t millis() const = 0;
+};
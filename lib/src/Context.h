@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Clock.h"
+#include "Logger.h"
+
+// Services shared by the modules of one device. Passed into every module
+// instead of reaching for process globals, so a host program can run many
+// devices side by side.
+struct Context {
+  const Clock &clock;
+  Logger &log;
+};
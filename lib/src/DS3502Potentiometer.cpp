@@ -0,0 +1,104 @@
+#include "DS3502Potentiometer.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+constexpr uint8_t kWiperRegister = 0x00;
+constexpr uint8_t kControlRegister = 0x02;
+// Mode 1: writes go to the wiper register only, not to its EEPROM copy,
+// which would wear and NACK the bus for each 20 ms write cycle.
+constexpr uint8_t kControlMode1 = 0x80;
+constexpr int kMaxWiper = 127;
+// A transfer of a few bytes at 400 kHz ends well within this.
+constexpr uint32_t kPollIntervalMs = 1;
+// Between attempts while the device does not answer.
+constexpr uint32_t kRetryIntervalMs = 100;
+
+} // namespace
+
+DS3502Potentiometer::DS3502Potentiometer(const Context &context, I2cBus &bus,
+                                         uint8_t address)
+    : clock_(context.clock), log_(context.log), bus_(bus), address_(address) {
+}
+
+void DS3502Potentiometer::begin() {
+  has_control_ = false;
+  update();
+}
+
+void DS3502Potentiometer::setValue(float value) {
+  PROFILE_SCOPE("DS3502Potentiometer::setValue");
+  // Map 0.0-1.0 to 0-127
+  float clamped = std::clamp(value, 0.0f, 1.0f);
+  target_wiper_ = static_cast<int>(clamped * kMaxWiper);
+  update();
+}
+
+void DS3502Potentiometer::update() {
+  if (in_flight_ != Write::kNone) {
+    I2cBus::Status status = bus_.getStatus();
+    if (status == I2cBus::Status::kBusy) {
+      return;
+    }
+    if (status == I2cBus::Status::kOk) {
+      if (in_flight_ == Write::kControl) {
+        has_control_ = true;
+      } else {
+        device_wiper_ = in_flight_wiper_;
+      }
+      if (is_failing_) {
+        LOG_INFO(log_, kActuator) << "DS3502 recovered\n";
+        is_failing_ = false;
+      }
+    } else {
+      ++error_count_;
+      if (in_flight_ == Write::kWiper) {
+        device_wiper_ = -1;
+      }
+      if (!is_failing_) {
+        LOG_WARNING(log_, kActuator)
+            << "DS3502 write failed: " << static_cast<int>(status) << "\n";
+        is_failing_ = true;
+      }
+      retry_ms_ = clock_.millis() + kRetryIntervalMs;
+    }
+    in_flight_ = Write::kNone;
+  }
+
+  if (is_failing_ && static_cast<int32_t>(clock_.millis() - retry_ms_) < 0) {
+    return;
+  }
+
+  if (!has_control_) {
+    startWrite(kControlRegister, kControlMode1, Write::kControl);
+  } else if (target_wiper_ >= 0 && target_wiper_ != device_wiper_) {
+    in_flight_wiper_ = static_cast<uint8_t>(target_wiper_);
+    startWrite(kWiperRegister, in_flight_wiper_, Write::kWiper);
+  }
+}
+
+void DS3502Potentiometer::schedule(Scheduler &scheduler) const {
+  if (isIdle()) {
+    return;
+  }
+  if (in_flight_ == Write::kNone && is_failing_) {
+    scheduler.requestUpdateAt(retry_ms_);
+  } else {
+    scheduler.requestUpdateIn(kPollIntervalMs);
+  }
+}
+
+bool DS3502Potentiometer::isIdle() const {
+  return in_flight_ == Write::kNone && has_control_ &&
+         (target_wiper_ < 0 || target_wiper_ == device_wiper_);
+}
+
+void DS3502Potentiometer::startWrite(uint8_t reg, uint8_t value, Write write) {
+  std::array<uint8_t, 2> data = {reg, value};
+  if (bus_.startWrite(address_, data.data(), data.size())) {
+    in_flight_ = write;
+  }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Context.h"
+#include "I2cBus.h"
+#include "Potentiometer.h"
+#include "Scheduler.h"
+#include <cstdint>
+
+// A DS3502 digital potentiometer that never waits for the bus: setValue()
+// only sets the target wiper, which is written as soon as the bus is free.
+// Values set while a write is in flight collapse into the newest, and a
+// failed write is repeated, every 100 ms, until the device has the target.
+class DS3502Potentiometer final : public Potentiometer {
+public:
+  static constexpr uint8_t kDefaultAddress = 0x28;
+
+  DS3502Potentiometer(const Context &context, I2cBus &bus,
+                      uint8_t address = kDefaultAddress);
+
+  // Sets the wiper to be written without its EEPROM copy.
+  void begin();
+  void setValue(float value) override;
+  // Collects the write in flight and starts the next one. Call each loop.
+  void update();
+  void schedule(Scheduler &scheduler) const;
+
+  // Whether the device has the target wiper.
+  bool isIdle() const;
+  uint32_t getErrorCount() const { return error_count_; }
+
+private:
+  enum class Write : uint8_t { kNone, kControl, kWiper };
+
+  void startWrite(uint8_t reg, uint8_t value, Write write);
+
+  const Clock &clock_;
+  Logger &log_;
+  I2cBus &bus_;
+  const uint8_t address_;
+
+  bool has_control_ = true;
+  int target_wiper_ = -1;
+  // What the device holds, -1 when unknown.
+  int device_wiper_ = -1;
+  Write in_flight_ = Write::kNone;
+  uint8_t in_flight_wiper_ = 0;
+  uint32_t error_count_ = 0;
+  bool is_failing_ = false;
+  uint32_t retry_ms_ = 0;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "PeerAddress.h"
+#include <cstdint>
+
+// Where a probe keeps its temperature characteristic.
+struct ProbeHandles {
+  uint16_t value_handle = 0;
+  uint16_t cccd_handle = 0; // Client characteristic configuration
+};
+
+// The GATT operations on one probe connection.
+class GattClient {
+public:
+  virtual ~GattClient() = default;
+
+  // Finds the temperature characteristic by full service discovery, several
+  // round trips long.
+  virtual bool discover(ProbeHandles *handles) = 0;
+  // Whether the peer is a probe that readings may come from.
+  virtual bool isSupported() = 0;
+  // Subscribes to notifications through `handles`, one round trip. Fails on
+  // handles the peer does not have.
+  virtual bool enableNotify(const ProbeHandles &handles) = 0;
+};
@@ -0,0 +1,39 @@
+#include "GattHandleCache.h"
+#include <algorithm>
+
+bool GattHandleCache::find(const PeerAddress &address, ProbeHandles *handles) {
+  Entry *entry = get(address);
+  if (!entry) {
+    return false;
+  }
+  entry->last_use = ++use_count_;
+  *handles = entry->handles;
+  return true;
+}
+
+void GattHandleCache::store(const PeerAddress &address,
+                            const ProbeHandles &handles) {
+  Entry *entry = get(address);
+  if (!entry) {
+    entry = &*std::min_element(entries_.begin(), entries_.end(),
+                               [](const Entry &a, const Entry &b) {
+                                 return a.last_use < b.last_use;
+                               });
+  }
+  *entry = {address, handles, ++use_count_};
+}
+
+void GattHandleCache::erase(const PeerAddress &address) {
+  if (Entry *entry = get(address)) {
+    *entry = {};
+  }
+}
+
+GattHandleCache::Entry *GattHandleCache::get(const PeerAddress &address) {
+  for (Entry &entry : entries_) {
+    if (entry.last_use != 0 && entry.address == address) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
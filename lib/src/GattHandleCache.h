@@ -0,0 +1,29 @@
+#pragma once
+
+#include "GattClient.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The handles discovered on the last few probes, by address, so a reconnect
+// can subscribe without discovery. Evicts the least recently used.
+class GattHandleCache {
+public:
+  static constexpr size_t kMaxPeers = 4;
+
+  bool find(const PeerAddress &address, ProbeHandles *handles);
+  void store(const PeerAddress &address, const ProbeHandles &handles);
+  void erase(const PeerAddress &address);
+
+private:
+  struct Entry {
+    PeerAddress address;
+    ProbeHandles handles;
+    uint32_t last_use = 0; // 0 when free
+  };
+
+  Entry *get(const PeerAddress &address);
+
+  std::array<Entry, kMaxPeers> entries_ = {};
+  uint32_t use_count_ = 0;
+};
@@ -0,0 +1,93 @@
+#include "Histogram.h"
+#include <algorithm>
+
+namespace {
+
+// With a single writer, a plain load and store does, and is cheaper than an
+// exclusive read-modify-write loop.
+void increment(std::atomic<uint32_t> &counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+} // namespace
+
+void Histogram::record(uint32_t value) {
+  increment(buckets_[getBucket(value)]);
+  increment(count_);
+  if (value < min_.load(std::memory_order_relaxed)) {
+    min_.store(value, std::memory_order_relaxed);
+  }
+  if (value > max_.load(std::memory_order_relaxed)) {
+    max_.store(value, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::clear() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  min_.store(UINT32_MAX, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+uint32_t Histogram::getMin() const {
+  return getCount() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+}
+
+float Histogram::getMean() const {
+  double sum = 0.0;
+  uint32_t count = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    if (uint32_t n = buckets_[i].load(std::memory_order_relaxed)) {
+      sum += n * (static_cast<double>(getBucketMin(i)) + getBucketMax(i)) / 2;
+      count += n;
+    }
+  }
+  return count == 0 ? 0.0f : static_cast<float>(sum / count);
+}
+
+uint32_t Histogram::getPercentile(float fraction) const {
+  uint32_t count = getCount();
+  if (count == 0) {
+    return 0;
+  }
+  // The rank of the value, 1-based.
+  uint32_t rank = std::max<uint32_t>(
+      1, static_cast<uint32_t>(std::clamp(fraction, 0.0f, 1.0f) * count));
+  uint32_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return std::min(getBucketMax(i), getMax());
+    }
+  }
+  return getMax();
+}
+
+size_t Histogram::getBucket(uint32_t value) {
+  if (value < 2 * kSubBuckets) {
+    return value;
+  }
+  size_t exponent = 31 - __builtin_clz(value);
+  size_t sub_bucket = (value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+  return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+uint32_t Histogram::getBucketMin(size_t bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  size_t exponent = bucket / kSubBuckets + kSubBucketBits - 1;
+  uint32_t sub_bucket = bucket % kSubBuckets;
+  return (kSubBuckets + sub_bucket) << (exponent - kSubBucketBits);
+}
+
+uint32_t Histogram::getBucketMax(size_t bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  size_t exponent = bucket / kSubBuckets + kSubBucketBits - 1;
+  return getBucketMin(bucket) + ((1u << (exponent - kSubBucketBits)) - 1);
+}
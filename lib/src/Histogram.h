@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Distribution of 32-bit durations in a fixed table. Values below 16 count
+// exactly; above, each power of two splits into 8 buckets, so percentiles
+// are within 12.5% while the table stays under 1 KB.
+//
+// One thread records and clears; other threads may read at any time and
+// then see a record that is only partly applied.
+class Histogram {
+public:
+  static constexpr size_t kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr size_t kBuckets = (32 - kSubBucketBits + 1) * kSubBuckets;
+
+  Histogram() { clear(); }
+
+  // Writer side.
+  void record(uint32_t value);
+  void clear();
+
+  uint32_t getCount() const { return count_.load(std::memory_order_relaxed); }
+  uint32_t getMin() const;
+  uint32_t getMax() const { return max_.load(std::memory_order_relaxed); }
+  // From the bucket midpoints, as a sum would overflow.
+  float getMean() const;
+  // The upper bound of the bucket holding the given fraction of the values,
+  // at most getMax(). 0 while empty.
+  uint32_t getPercentile(float fraction) const;
+
+  static size_t getBucket(uint32_t value);
+  static uint32_t getBucketMin(size_t bucket);
+  static uint32_t getBucketMax(size_t bucket);
+
+private:
+  std::array<std::atomic<uint32_t>, kBuckets> buckets_;
+  std::atomic<uint32_t> count_;
+  std::atomic<uint32_t> min_;
+  std::atomic<uint32_t> max_;
+};
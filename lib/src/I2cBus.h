@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// An I2C controller that transfers in the background, one transfer at a
+// time. The caller polls for the outcome instead of waiting for it.
+class I2cBus {
+public:
+  enum class Status : uint8_t {
+    kBusy,
+    kOk, // Also before the first transfer
+    kAddressNack,
+    kDataNack,
+    kError,
+  };
+
+  static constexpr size_t kMaxWriteSize = 4;
+
+  virtual ~I2cBus() = default;
+
+  // Copies up to kMaxWriteSize bytes and starts writing them to the device
+  // at the 7-bit `address`. Returns false, without writing, while busy.
+  virtual bool startWrite(uint8_t address, const uint8_t *data,
+                          size_t size) = 0;
+
+  // Outcome of the last transfer, kBusy while it runs.
+  virtual Status getStatus() = 0;
+};
@@ -0,0 +1,58 @@
+#include "KalmanEstimator.h"
+#include "Logger.h"
+
+KalmanEstimator::KalmanEstimator(const Context &context,
+                                 const KalmanConfig &config)
+    : log_(context.log), config_(config) {}
+
+void KalmanEstimator::addReading(float value, uint32_t time_ms) {
+  LOG_DEBUG(log_, kAnalyzer) << "KalmanEstimator::addReading(/*value=*/"
+                             << value << ", /*time_ms=*/" << time_ms << ")\n";
+
+  float r = config_.reading_noise * config_.reading_noise;
+  if (count_ == 0) {
+    value_ = value;
+    slope_ = 0.0f;
+    p_vv_ = r;
+    p_vs_ = 0.0f;
+    p_ss_ = config_.initial_slope_deviation * config_.initial_slope_deviation;
+  } else {
+    int32_t dt_ms = time_ms - last_update_ms_;
+    if (dt_ms < 0) {
+      return; // The filter only moves forward in time.
+    }
+
+    // Predict: x = F x, P = F P F' + Q, with F = [1 dt; 0 1] and Q from
+    // white noise on the slope.
+    float dt = dt_ms;
+    float q = config_.slope_noise;
+    value_ += slope_ * dt;
+    p_vv_ += dt * (2.0f * p_vs_ + dt * p_ss_) + q * dt * dt * dt / 3.0f;
+    p_vs_ += dt * p_ss_ + q * dt * dt / 2.0f;
+    p_ss_ += q * dt;
+
+    // Correct with the reading, which observes the value only.
+    float innovation = value - value_;
+    float s = p_vv_ + r;
+    float k_v = p_vv_ / s;
+    float k_s = p_vs_ / s;
+    value_ += k_v * innovation;
+    slope_ += k_s * innovation;
+    p_ss_ -= k_s * p_vs_;
+    p_vs_ -= k_s * p_vv_;
+    p_vv_ -= k_v * p_vv_;
+  }
+
+  ++count_;
+  last_update_ms_ = time_ms;
+  estimate_.store({last_update_ms_, value_, slope_, p_vv_, p_ss_, count_});
+}
+
+void KalmanEstimator::clear() {
+  if (count_ == 0) {
+    return;
+  }
+  LOG_DEBUG(log_, kAnalyzer) << "KalmanEstimator::clear()\n";
+  count_ = 0;
+  estimate_.store({});
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Context.h"
+#include "SeqLock.h"
+#include "TemperatureEstimator.h"
+#include <cstdint>
+
+struct KalmanConfig {
+  float reading_noise = 0.05f;           // Standard deviation of a reading (°C)
+  float slope_noise = 3e-14f;            // Slope drift density ((°C/ms)²/ms)
+  float initial_slope_deviation = 1e-3f; // Prior on the slope (°C/ms)
+};
+
+// Constant-velocity Kalman filter over temperature and slope. O(1) per
+// reading, and follows a change of slope without waiting for a window of
+// readings to turn over.
+class KalmanEstimator : public TemperatureEstimator {
+public:
+  KalmanEstimator(const Context &context, const KalmanConfig &config);
+
+  void addReading(float value, uint32_t time_ms) override;
+  void clear() override;
+  Estimate getEstimate() const override { return estimate_.load(); }
+
+private:
+  Logger &log_;
+  const KalmanConfig config_;
+
+  // State and covariance, as of last_update_ms_.
+  uint32_t count_ = 0;
+  uint32_t last_update_ms_ = 0;
+  float value_ = 0.0f;
+  float slope_ = 0.0f;
+  float p_vv_ = 0.0f; // Variance of value_
+  float p_vs_ = 0.0f; // Covariance of value_ and slope_
+  float p_ss_ = 0.0f; // Variance of slope_
+
+  SeqLock<Estimate> estimate_;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Clock.h"
+#include <cstdint>
+
+// Holds the time of the last latch(), so that everything in one main loop
+// iteration sees the same time, as it does in a replay.
+class LatchedClock final : public Clock {
+public:
+  explicit LatchedClock(const Clock &source) : source_(source) {}
+
+  uint32_t millis() const override { return now_ms_; }
+
+  void latch() { now_ms_ = source_.millis(); }
+
+private:
+  const Clock &source_;
+  uint32_t now_ms_ = 0;
+};
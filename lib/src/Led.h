@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Pattern.h"
+#include <cstdint>
+
+class Led {
+public:
+  static constexpr uint16_t kOff = 0;
+  static constexpr uint16_t kOn = 255;
+
+  virtual ~Led() = default;
+
+  // Replaces whatever plays. Values are brightness from kOff to kOn; the LED
+  // is off at the end of a pattern that does not repeat.
+  virtual void play(const Pattern &brightness) = 0;
+
+  virtual void stop() = 0;
+};
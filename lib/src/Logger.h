@@ -1,26 +1,93 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <type_traits>
 #include <string>
 
+enum class LogLevel : uint8_t {
+  kDebug,   // Per reading or per change, for development
+  kInfo,    // State transitions and connections
+  kWarning, // Something failed
+  kNone,    // Disables logging at runtime
+};
+
+enum class LogCategory : uint8_t {
+  kSystem,
+  kSupervisor,
+  kDial,
+  kActuator,
+  kController,
+  kAnalyzer,
+  kSignal, // Beeper and Blinker
+  kBle,
+  kCount,
+};
+
+// Statements below this level are compiled out, set with -DKRC_LOG_LEVEL=<n>
+// where n is the LogLevel value.
+#ifndef KRC_LOG_LEVEL
+#define KRC_LOG_LEVEL 0
+#endif
+constexpr LogLevel kMinLogLevel = static_cast<LogLevel>(KRC_LOG_LEVEL);
+
 class Logger {
 public:
   virtual ~Logger() = default;
 
+  // Runtime threshold on top of kMinLogLevel, meant to be set during setup.
+  void setLevel(LogLevel level) { levels_.fill(level); }
+  void setLevel(LogCategory category, LogLevel level) {
+    levels_[static_cast<size_t>(category)] = level;
+  }
+  bool isEnabled(LogLevel level, LogCategory category) const {
+    return level >= levels_[static_cast<size_t>(category)];
+  }
+
   virtual void log(const char *msg, size_t length) = 0;
+  // String literals live for the whole program, so a logger may keep just
+  // their address.
+  virtual void logLiteral(const char *msg, size_t length) {
+    log(msg, length);
+  }
   virtual void log(long) = 0;
   virtual void log(unsigned long) = 0;
   virtual void log(float) = 0;
+
+private:
+  std::array<LogLevel, static_cast<size_t>(LogCategory::kCount)> levels_ = {};
 };
 
-inline Logger &operator<<(Logger &logger, const char *msg) {
+// Usage: LOG_INFO(log_, kSupervisor) << "text " << value << "\n";
+// The stream is skipped, including its arguments, unless the level is
+// enabled. Below kMinLogLevel it is not compiled in at all.
+#define KRC_LOG(logger, level, category)                                      \
+  if constexpr (level < kMinLogLevel) {                                       \
+  } else if (!(logger).isEnabled(level, category)) {                          \
+  } else                                                                      \
+    (logger)
+#define LOG_DEBUG(logger, category)                                           \
+  KRC_LOG(logger, LogLevel::kDebug, LogCategory::category)
+#define LOG_INFO(logger, category)                                            \
+  KRC_LOG(logger, LogLevel::kInfo, LogCategory::category)
+#define LOG_WARNING(logger, category)                                         \
+  KRC_LOG(logger, LogLevel::kWarning, LogCategory::category)
+
+// A template, so that string literals prefer the overload below.
+template <typename T>
+std::enable_if_t<std::is_same_v<T, const char *> || std::is_same_v<T, char *>,
+                 Logger &>
+operator<<(Logger &logger, T msg) {
   return logger.log(msg, strlen(msg)), logger;
-};
+}
 
 template <size_t N> Logger &operator<<(Logger &logger, const char (&msg)[N]) {
-  return logger.log(msg, N - 1), logger;
+  return logger.logLiteral(msg, N - 1), logger;
+}
+
+template <size_t N> Logger &operator<<(Logger &logger, char (&msg)[N]) {
+  return logger.log(msg, strnlen(msg, N)), logger;
 }
 
 template <typename T,
@@ -38,7 +105,7 @@ inline Logger &operator<<(Logger &logger, float value) {
 }
 
 inline Logger &operator<<(Logger &logger, bool value) {
-  return logger << (value ? "true" : "false");
+  return value ? logger << "true" : logger << "false";
 }
 
 extern Logger &Log;
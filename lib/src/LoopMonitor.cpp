@@ -0,0 +1,49 @@
+#include "LoopMonitor.h"
+#include <initializer_list>
+
+void LoopMonitor::beginIteration(uint32_t now_us) {
+  // A wake before the timeout came from an event, not the timer.
+  if (is_sleeping_) {
+    if (int32_t lateness = now_us - wake_us_; lateness >= 0) {
+      lateness_.record(lateness);
+    }
+    is_sleeping_ = false;
+  }
+  iteration_start_us_ = now_us;
+  in_iteration_ = true;
+}
+
+void LoopMonitor::endIteration(uint32_t now_us, uint32_t sleep_ms) {
+  if (in_iteration_) {
+    duration_.record(now_us - iteration_start_us_);
+    in_iteration_ = false;
+  }
+  wake_us_ = now_us + sleep_ms * 1000;
+  is_sleeping_ = true;
+}
+
+void LoopMonitor::addActuation(uint32_t now_us, uint32_t received_us) {
+  latency_.record(now_us - received_us);
+}
+
+void LoopMonitor::clear() {
+  duration_.clear();
+  lateness_.clear();
+  latency_.clear();
+}
+
+std::array<uint8_t, LoopMonitor::kEncodedSize> LoopMonitor::encode() const {
+  std::array<uint8_t, kEncodedSize> data;
+  size_t offset = 0;
+  for (const Histogram *histogram : {&duration_, &lateness_, &latency_}) {
+    for (uint32_t value :
+         {histogram->getCount(), histogram->getMin(),
+          histogram->getPercentile(0.5f), histogram->getPercentile(0.99f),
+          histogram->getMax()}) {
+      for (int shift = 0; shift < 32; shift += 8) {
+        data[offset++] = static_cast<uint8_t>(value >> shift);
+      }
+    }
+  }
+  return data;
+}
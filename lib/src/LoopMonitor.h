@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Histogram.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Timing of the main loop in µs, kept for the whole uptime in constant
+// memory: how long each iteration works, how late it wakes from a timed
+// sleep, and how long a probe reading takes from its BLE notification to the
+// actuator update that used it. Called from the main loop only.
+class LoopMonitor {
+public:
+  // Count, min, p50, p99 and max of each histogram as little-endian uint32_t,
+  // in the order duration, lateness, latency.
+  static constexpr size_t kStatsPerHistogram = 5;
+  static constexpr size_t kEncodedSize = 3 * kStatsPerHistogram * 4;
+
+  // At the start of an iteration.
+  void beginIteration(uint32_t now_us);
+  // Before sleeping for `sleep_ms`.
+  void endIteration(uint32_t now_us, uint32_t sleep_ms);
+  // After the actuators were updated from a reading received at
+  // `received_us`.
+  void addActuation(uint32_t now_us, uint32_t received_us);
+
+  void clear();
+
+  const Histogram &getDuration() const { return duration_; }
+  const Histogram &getLateness() const { return lateness_; }
+  const Histogram &getLatency() const { return latency_; }
+
+  std::array<uint8_t, kEncodedSize> encode() const;
+
+private:
+  Histogram duration_;
+  Histogram lateness_;
+  Histogram latency_;
+
+  uint32_t iteration_start_us_ = 0;
+  bool in_iteration_ = false;
+  // When the current sleep should end, if it is a timed one.
+  uint32_t wake_us_ = 0;
+  bool is_sleeping_ = false;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One value of a pattern, held for `duration_ms`. What the value means is up
+// to the device that plays it.
+struct PatternStep {
+  uint16_t duration_ms;
+  uint16_t value;
+};
+
+// A signal that a device plays on its own, without the main loop: its steps
+// in order, once or over and over.
+struct Pattern {
+  const PatternStep *steps;
+  size_t size;
+  bool repeat;
+};
+
+// The steps of a pattern, built at compile time:
+//   constexpr auto kBlink = loop(hold(Led::kOn, 100), hold(Led::kOff, 1000));
+// Steps follow each other in order, so all of them are reached, and with
+// isPlayable() asserted every pattern ends or repeats with time passing.
+template <size_t N> struct PatternTable {
+  PatternStep steps[N];
+  bool repeat;
+
+  constexpr Pattern get() const { return {steps, N, repeat}; }
+};
+
+constexpr PatternStep hold(uint16_t value, uint16_t duration_ms) {
+  return {duration_ms, value};
+}
+
+template <typename... Steps>
+constexpr PatternTable<sizeof...(Steps)> once(Steps... steps) {
+  return {{steps...}, false};
+}
+
+template <typename... Steps>
+constexpr PatternTable<sizeof...(Steps)> loop(Steps... steps) {
+  return {{steps...}, true};
+}
+
+// Every step takes time, so a player never spins on a repeat.
+template <size_t N>
+constexpr bool isPlayable(const PatternTable<N> &table) {
+  for (const PatternStep &step : table.steps) {
+    if (step.duration_ms == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Playing time of one pass.
+constexpr uint32_t getDurationMs(const Pattern &pattern) {
+  uint32_t duration_ms = 0;
+  for (size_t i = 0; i < pattern.size; ++i) {
+    duration_ms += pattern.steps[i].duration_ms;
+  }
+  return duration_ms;
+}
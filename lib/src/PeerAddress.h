@@ -0,0 +1,14 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// A BLE device address with its type, public or random.
+struct PeerAddress {
+  uint8_t type = 0;
+  std::array<uint8_t, 6> bytes = {};
+
+  bool operator==(const PeerAddress &other) const {
+    return type == other.type && bytes == other.bytes;
+  }
+};
@@ -0,0 +1,117 @@
+#include "PlantIdentifier.h"
+#include <algorithm>
+
+namespace {
+
+// Forgetting factor of the fits: older samples fade over about half an hour
+// at one reading per second, so the model follows a change of contents.
+constexpr double kForgetting = 0.9995;
+// Initial covariance, and bound against windup while power is constant.
+constexpr double kMaxCovariance = 1.0;
+// Smoothing of the squared prediction error that ranks the dead times.
+constexpr double kErrorSmoothing = 0.01;
+
+constexpr uint32_t kMinSamples = 120;
+constexpr float kMinTimeConstantMs = 60.0f * 1000;
+constexpr float kMaxTimeConstantMs = 4 * 60 * 60.0f * 1000;
+
+} // namespace
+
+PlantIdentifier::PlantIdentifier(float ambient_temp)
+    : ambient_temp_(ambient_temp) {
+  reset();
+}
+
+void PlantIdentifier::reset() {
+  fits_.fill({});
+  for (Fit &fit : fits_) {
+    fit.p_aa = fit.p_bb = kMaxCovariance;
+  }
+  power_count_ = 0;
+}
+
+void PlantIdentifier::addSample(uint32_t time_ms, float temp, float slope,
+                                float power) {
+  const PowerSample *newest =
+      power_count_ == 0 ? nullptr
+                        : &power_history_[(power_head_ + power_count_ - 1) %
+                                          power_history_.size()];
+  if (!newest || time_ms - newest->time_ms >= kPowerIntervalMs) {
+    if (power_count_ == power_history_.size()) {
+      power_head_ = (power_head_ + 1) % power_history_.size();
+      --power_count_;
+    }
+    power_history_[(power_head_ + power_count_++) % power_history_.size()] = {
+        time_ms, power};
+  }
+
+  double x = temp - ambient_temp_;
+  double y = slope * 1000.0; // °C/s
+  for (size_t i = 0; i < kNumDeadTimes; ++i) {
+    float delayed_power;
+    if (findPower(time_ms - kDeadTimesMs[i], &delayed_power)) {
+      update(fits_[i], x, delayed_power, y);
+    }
+  }
+}
+
+void PlantIdentifier::update(Fit &fit, double x, double u, double y) {
+  double error = y - (fit.a * x + fit.b * u);
+  ++fit.samples;
+  // A plain average until the smoothing takes over.
+  double weight = std::max(1.0 / fit.samples, kErrorSmoothing);
+  fit.error += weight * (error * error - fit.error);
+
+  double p_x = fit.p_aa * x + fit.p_ab * u;
+  double p_u = fit.p_ab * x + fit.p_bb * u;
+  double denominator = kForgetting + x * p_x + u * p_u;
+  double k_a = p_x / denominator;
+  double k_b = p_u / denominator;
+
+  fit.a += k_a * error;
+  fit.b += k_b * error;
+  fit.p_aa = std::min((fit.p_aa - k_a * p_x) / kForgetting, kMaxCovariance);
+  fit.p_ab = (fit.p_ab - k_a * p_u) / kForgetting;
+  fit.p_bb = std::min((fit.p_bb - k_b * p_u) / kForgetting, kMaxCovariance);
+}
+
+const PlantIdentifier::Fit *PlantIdentifier::getBestFit(size_t *index) const {
+  const Fit *best = nullptr;
+  for (size_t i = 0; i < kNumDeadTimes; ++i) {
+    const Fit &fit = fits_[i];
+    if (fit.samples >= kMinSamples && (!best || fit.error < best->error)) {
+      best = &fit;
+      *index = i;
+    }
+  }
+  return best;
+}
+
+bool PlantIdentifier::findPower(uint32_t time_ms, float *power) const {
+  // Newest sample at or before time_ms.
+  for (size_t i = power_count_; i-- > 0;) {
+    const PowerSample &sample =
+        power_history_[(power_head_ + i) % power_history_.size()];
+    if (static_cast<int32_t>(time_ms - sample.time_ms) >= 0) {
+      *power = sample.power;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PlantIdentifier::isValid() const {
+  PlantModel model = getModel();
+  return model.gain > 0.0f && model.time_constant_ms >= kMinTimeConstantMs &&
+         model.time_constant_ms <= kMaxTimeConstantMs;
+}
+
+PlantModel PlantIdentifier::getModel() const {
+  size_t index = 0;
+  const Fit *fit = getBestFit(&index);
+  if (!fit || fit->a >= 0.0) {
+    return {};
+  }
+  return {static_cast<float>(-fit->b / fit->a),
+          static_cast<float>(-1000.0 / fit->a), kDeadTimesMs[index]};
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// First-order-plus-dead-time model of pot and burner:
+//   time_constant * dT/dt = gain * power(t - dead_time) - (T - ambient)
+struct PlantModel {
+  float gain = 0.0f;             // Steady-state rise at full power (°C)
+  float time_constant_ms = 0.0f; // Of the heat loss
+  uint32_t dead_time_ms = 0;     // Until a power change shows in the slope
+};
+
+// Identifies a PlantModel while cooking. Fits dT/dt against the temperature
+// and the power some time earlier by recursive least squares, once for each
+// of a fixed set of dead times, and picks the dead time that predicts best.
+class PlantIdentifier {
+public:
+  static constexpr size_t kNumDeadTimes = 7;
+  static constexpr std::array<uint32_t, kNumDeadTimes> kDeadTimesMs = {
+      0, 5000, 10000, 20000, 30000, 45000, 60000};
+
+  explicit PlantIdentifier(float ambient_temp);
+
+  void reset();
+
+  // Called once per new reading with its temperature and slope (°C/ms), and
+  // the power requested at that time.
+  void addSample(uint32_t time_ms, float temp, float slope, float power);
+
+  // Whether enough samples produced a physically sensible model.
+  bool isValid() const;
+  PlantModel getModel() const;
+
+private:
+  // dT/dt = a * (T - ambient) + b * power, in seconds.
+  struct Fit {
+    double a = 0.0;
+    double b = 0.0;
+    double p_aa = 0.0; // Covariance of the estimates
+    double p_ab = 0.0;
+    double p_bb = 0.0;
+    double error = 0.0; // Smoothed squared prediction error
+    uint32_t samples = 0;
+  };
+
+  struct PowerSample {
+    uint32_t time_ms;
+    float power;
+  };
+
+  static void update(Fit &fit, double x, double u, double y);
+  // The best fit with enough samples, or nullptr.
+  const Fit *getBestFit(size_t *index) const;
+  bool findPower(uint32_t time_ms, float *power) const;
+
+  const float ambient_temp_;
+
+  std::array<Fit, kNumDeadTimes> fits_;
+
+  // Recent power, oldest at power_head_. Samples closer than
+  // kPowerIntervalMs to the newest are not kept, so the history spans the
+  // longest dead time at any reading rate, with power changes up to that
+  // late. One reading per second keeps them all.
+  static constexpr uint32_t kPowerIntervalMs = 900;
+  static constexpr size_t kPowerHistorySize = 80;
+  static_assert((kPowerHistorySize - 1) * kPowerIntervalMs >=
+                kDeadTimesMs.back() + kPowerIntervalMs);
+
+  std::array<PowerSample, kPowerHistorySize> power_history_;
+  size_t power_head_ = 0;
+  size_t power_count_ = 0;
+};
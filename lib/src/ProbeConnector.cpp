@@ -0,0 +1,25 @@
+#include "ProbeConnector.h"
+
+ProbeConnector::Result ProbeConnector::connect(GattClient &client,
+                                               const PeerAddress &address) {
+  ProbeHandles handles;
+  if (cache_.find(address, &handles)) {
+    if (client.enableNotify(handles)) {
+      return Result::kCached;
+    }
+    // The probe changed, say with new firmware.
+    cache_.erase(address);
+  }
+
+  if (!client.discover(&handles)) {
+    return Result::kNotFound;
+  }
+  if (!client.isSupported()) {
+    return Result::kNotSupported;
+  }
+  if (!client.enableNotify(handles)) {
+    return Result::kFailed;
+  }
+  cache_.store(address, handles);
+  return Result::kDiscovered;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "GattClient.h"
+#include "GattHandleCache.h"
+#include <cstdint>
+
+// Subscribes to a newly connected probe: straight through the handles cached
+// for its address when there are any, otherwise, or when they no longer
+// match, after a full discovery. Called from the BLE task only.
+class ProbeConnector {
+public:
+  enum class Result : uint8_t {
+    kCached,     // Subscribed through cached handles
+    kDiscovered, // Subscribed after discovery
+    kNotFound,   // No temperature characteristic
+    kNotSupported,
+    kFailed, // Subscribing failed
+  };
+
+  Result connect(GattClient &client, const PeerAddress &address);
+
+private:
+  GattHandleCache cache_;
+};
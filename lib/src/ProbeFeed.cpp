@@ -0,0 +1,51 @@
+#include "ProbeFeed.h"
+#include "Logger.h"
+
+ProbeFeed::ProbeFeed(const Context &context, ProbeSink &probes)
+    : log_(context.log), probes_(probes) {}
+
+void ProbeFeed::dropProbe(size_t probe) {
+  if (probe < kMaxProbes) {
+    dropped_.fetch_or(1u << probe);
+  }
+}
+
+bool ProbeFeed::update(uint32_t *received_us, uint32_t *dropped) {
+  // Taken before the readings: those of a lost probe are all queued by
+  // now, and are left out below, along with any of a probe that joined on
+  // the same link since.
+  uint32_t lost = dropped_.exchange(0);
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    if (lost & (1u << i)) {
+      LOG_INFO(log_, kBle) << "ProbeFeed: probe " << i << " lost\n";
+      if (added_ & (1u << i)) {
+        probes_.removeProbe(i);
+        added_ &= ~(1u << i);
+      }
+    }
+  }
+  if (dropped) {
+    *dropped = lost;
+  }
+
+  bool has_readings = false;
+  Reading reading;
+  while (readings_.pop(reading)) {
+    size_t probe = reading.probe;
+    if (probe >= kMaxProbes || (lost & (1u << probe))) {
+      continue;
+    }
+    if (!has_readings && received_us) {
+      *received_us = reading.received_us;
+    }
+    has_readings = true;
+    LOG_DEBUG(log_, kBle) << "ProbeFeed::update(" << probe << ", "
+                          << reading.temp << "°C)\n";
+    if (!(added_ & (1u << probe))) {
+      probes_.addProbe(probe, reading.address);
+      added_ |= 1u << probe;
+    }
+    probes_.addReading(probe, reading.temp, reading.time_ms);
+  }
+  return has_readings;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Context.h"
+#include "PeerAddress.h"
+#include "ProbeSink.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Carries the readings and dropouts of probes from the BLE task to a
+// ProbeSink in the loop. Tells the sink a link's probe before its first
+// reading. Readings still queued when a dropout is handled are left out,
+// so a lost probe does not join again on its last readings.
+class ProbeFeed {
+public:
+  static constexpr size_t kMaxProbes = 4;
+
+  struct Reading {
+    uint8_t probe; // Index of its link
+    PeerAddress address;
+    float temp;
+    uint32_t time_ms;
+    uint32_t received_us;
+  };
+
+  ProbeFeed(const Context &context, ProbeSink &probes);
+
+  // From the BLE task.
+  void addReading(const Reading &reading) { readings_.push(reading); }
+  void dropProbe(size_t probe);
+
+  // From the loop. Passes the dropouts and readings since the last call to
+  // the sink. Returns whether there were readings, and when the oldest
+  // arrived; sets the bit of each link dropped in `dropped`.
+  bool update(uint32_t *received_us = nullptr, uint32_t *dropped = nullptr);
+
+  // Readings lost to a full queue.
+  uint32_t getOverflowCount() const { return readings_.getOverflowCount(); }
+
+private:
+  Logger &log_;
+  ProbeSink &probes_;
+
+  SpscQueue<Reading, 8> readings_;
+  // Bit per link whose probe was lost.
+  std::atomic<uint32_t> dropped_{0};
+
+  // Bit per link whose probe the sink was told of. Loop only.
+  uint32_t added_ = 0;
+};
@@ -0,0 +1,94 @@
+#include "ProbeFusion.h"
+#include "Logger.h"
+
+ProbeFusion::ProbeFusion(const Context &context,
+                         TemperatureEstimator &estimator,
+                         const FusionConfig &config)
+    : log_(context.log), estimator_(estimator), config_(config) {}
+
+void ProbeFusion::addReading(size_t probe, float value, uint32_t time_ms) {
+  LOG_DEBUG(log_, kAnalyzer) << "ProbeFusion::addReading(/*probe=*/" << probe
+                             << ", /*value=*/" << value << ", /*time_ms=*/"
+                             << time_ms << ")\n";
+  if (probe >= kMaxProbes) {
+    return;
+  }
+
+  // The other probes: their fused temperature weighted as of now, and
+  // their mean level weighted by noise only.
+  float others_weight = 0.0f;
+  float others_fused = 0.0f;
+  float others_precision = 0.0f;
+  float others_level = 0.0f;
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    const Probe &other = probes_[i];
+    if (i != probe && isLive(other, time_ms)) {
+      float weight = getWeight(other, time_ms);
+      others_weight += weight;
+      others_fused += weight * (other.value - other.offset);
+      others_precision += 1.0f / other.variance;
+      others_level += other.value / other.variance;
+    }
+  }
+
+  Probe &reporting = probes_[probe];
+  if (!isLive(reporting, time_ms)) {
+    // Joins at the fused temperature, or sets it if alone.
+    float offset =
+        others_weight > 0.0f ? value - others_fused / others_weight : 0.0f;
+    LOG_INFO(log_, kAnalyzer) << "ProbeFusion: probe " << probe
+                              << " joined, offset " << offset << "\n";
+    reporting = {true, time_ms, value,
+                 config_.reading_noise * config_.reading_noise, offset};
+  } else {
+    // Half the squared step between readings, mostly noise at this rate.
+    float step = value - reporting.value;
+    float min_variance = config_.min_noise * config_.min_noise;
+    reporting.variance +=
+        config_.noise_smoothing * (0.5f * step * step - reporting.variance);
+    if (reporting.variance < min_variance) {
+      reporting.variance = min_variance;
+    }
+    reporting.value = value;
+    reporting.last_update_ms = time_ms;
+  }
+
+  // Alone, the offset decays to 0 and the probe becomes the temperature.
+  float weight = 1.0f / reporting.variance;
+  float mean = value;
+  if (others_weight > 0.0f) {
+    mean = (others_level + weight * value) / (others_precision + weight);
+  }
+  reporting.offset +=
+      config_.offset_smoothing * (value - mean - reporting.offset);
+
+  float fused = value - reporting.offset;
+  if (others_weight > 0.0f) {
+    fused = (others_fused + weight * fused) / (others_weight + weight);
+  }
+  estimator_.addReading(fused, time_ms);
+}
+
+void ProbeFusion::removeProbe(size_t probe) {
+  if (probe < kMaxProbes && probes_[probe].is_active) {
+    LOG_INFO(log_, kAnalyzer) << "ProbeFusion: probe " << probe << " left\n";
+    probes_[probe] = {};
+  }
+}
+
+size_t ProbeFusion::getProbeCount(uint32_t time_ms) const {
+  size_t count = 0;
+  for (const Probe &probe : probes_) {
+    count += isLive(probe, time_ms);
+  }
+  return count;
+}
+
+bool ProbeFusion::isLive(const Probe &probe, uint32_t time_ms) const {
+  return probe.is_active && time_ms - probe.last_update_ms <= config_.timeout_ms;
+}
+
+float ProbeFusion::getWeight(const Probe &probe, uint32_t time_ms) const {
+  float age_ms = time_ms - probe.last_update_ms;
+  return 1.0f / (probe.variance + config_.staleness_drift * age_ms);
+}
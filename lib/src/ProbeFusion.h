@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Context.h"
+#include "ProbeSink.h"
+#include "TemperatureEstimator.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct FusionConfig {
+  float reading_noise = 0.05f;   // Deviation of a new probe's readings (°C)
+  float min_noise = 0.01f;       // Floor on the learned deviation (°C)
+  float noise_smoothing = 0.05f; // Weight of a reading in the learned noise
+  float staleness_drift = 1e-6f; // Variance an old reading gains (°C²/ms)
+  float offset_smoothing = 0.01f; // Weight of a reading in a probe's offset
+  uint32_t timeout_ms = 30 * 1000; // Probes silent this long are left out
+};
+
+// Fuses the readings of several probes into one stream for an estimator.
+// Each reading is weighted by the noise learned for its probe and by its
+// age, so a probe gone quiet fades out. Each probe's offset from the
+// weighted mean of all is learned too and subtracted, so a probe joining
+// or dropping out moves the fused temperature slowly instead of by the gap
+// between the probes. A single probe passes through unchanged.
+// Called from the main loop only.
+class ProbeFusion final : public ProbeSink {
+public:
+  static constexpr size_t kMaxProbes = 4;
+
+  ProbeFusion(const Context &context, TemperatureEstimator &estimator,
+              const FusionConfig &config);
+
+  // Passes the fused temperature at `time_ms` to the estimator.
+  void addReading(size_t probe, float value, uint32_t time_ms) override;
+  void removeProbe(size_t probe) override;
+
+  // Probes heard from within the timeout.
+  size_t getProbeCount(uint32_t time_ms) const;
+
+private:
+  struct Probe {
+    bool is_active = false;
+    uint32_t last_update_ms = 0;
+    float value = 0.0f;    // Last reading (°C)
+    float variance = 0.0f; // Of a reading (°C²)
+    float offset = 0.0f;   // From the weighted mean (°C)
+  };
+
+  bool isLive(const Probe &probe, uint32_t time_ms) const;
+  float getWeight(const Probe &probe, uint32_t time_ms) const;
+
+  Logger &log_;
+  TemperatureEstimator &estimator_;
+  const FusionConfig config_;
+
+  std::array<Probe, kMaxProbes> probes_;
+};
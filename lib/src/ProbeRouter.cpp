@@ -0,0 +1,126 @@
+#include "ProbeRouter.h"
+#include "Logger.h"
+#include <algorithm>
+
+ProbeRouter::ProbeRouter(const Context &context, Thermometer &thermometer)
+    : log_(context.log), thermometer_(thermometer) {
+  for (size_t i = 0; i < kMaxZones; ++i) {
+    zones_[i].thermometer.router_ = this;
+    zones_[i].thermometer.zone_ = i;
+  }
+}
+
+void ProbeRouter::addProbe(size_t probe, const PeerAddress &address) {
+  if (probe >= kMaxProbes) {
+    return;
+  }
+  removeProbe(probe);
+  links_[probe].has_address = true;
+  links_[probe].address = address;
+  assignProbe(probe);
+  if (links_[probe].zone == kNoZone) {
+    LOG_INFO(log_, kBle) << "ProbeRouter: probe " << probe
+                         << " waits for a zone\n";
+  }
+}
+
+void ProbeRouter::addReading(size_t probe, float value, uint32_t time_ms) {
+  if (probe >= kMaxProbes) {
+    return;
+  }
+  Link &link = links_[probe];
+  if (link.zone == kNoZone && link.has_address) {
+    assignProbe(probe);
+  }
+  if (link.zone != kNoZone && zones_[link.zone].is_started) {
+    zones_[link.zone].probes->addReading(probe, value, time_ms);
+  }
+}
+
+void ProbeRouter::removeProbe(size_t probe) {
+  if (probe >= kMaxProbes) {
+    return;
+  }
+  Link &link = links_[probe];
+  if (link.zone != kNoZone && zones_[link.zone].is_started) {
+    zones_[link.zone].probes->removeProbe(probe);
+  }
+  link = {};
+}
+
+size_t ProbeRouter::getZone(size_t probe) const {
+  return probe < kMaxProbes ? links_[probe].zone : kNoZone;
+}
+
+void ProbeRouter::assignProbe(size_t probe) {
+  Link &link = links_[probe];
+  size_t zone = findZone(link.address);
+  if (zone == kNoZone) {
+    return;
+  }
+  LOG_INFO(log_, kBle) << "ProbeRouter: probe " << probe << " to zone " << zone
+                       << "\n";
+  // Only the zone it is with now takes it back.
+  for (Zone &other : zones_) {
+    if (other.has_probe_address && other.probe_address == link.address) {
+      other.has_probe_address = false;
+    }
+  }
+  zones_[zone].has_probe_address = true;
+  zones_[zone].probe_address = link.address;
+  link.zone = zone;
+  zones_[zone].probes->addProbe(probe, link.address);
+}
+
+size_t ProbeRouter::findZone(const PeerAddress &address) const {
+  size_t searching = kNoZone;
+  size_t searching_count = 0;
+  for (size_t i = 0; i < kMaxZones; ++i) {
+    const Zone &zone = zones_[i];
+    if (!zone.probes || !zone.is_started) {
+      continue;
+    }
+    if (zone.has_probe_address && zone.probe_address == address) {
+      return i;
+    }
+    if (!hasProbe(i)) {
+      searching = i;
+      ++searching_count;
+    }
+  }
+  return searching_count == 1 ? searching : kNoZone;
+}
+
+void ProbeRouter::startZone(size_t zone) {
+  bool was_started = isAnyStarted();
+  zones_[zone].is_started = true;
+  if (!was_started) {
+    thermometer_.start();
+  }
+}
+
+void ProbeRouter::stopZone(size_t zone) {
+  if (!zones_[zone].is_started) {
+    return;
+  }
+  // Its probes stay with it, silent, in case it starts again.
+  for (size_t probe = 0; probe < kMaxProbes; ++probe) {
+    if (links_[probe].zone == zone) {
+      zones_[zone].probes->removeProbe(probe);
+    }
+  }
+  zones_[zone].is_started = false;
+  if (!isAnyStarted()) {
+    thermometer_.stop();
+  }
+}
+
+bool ProbeRouter::hasProbe(size_t zone) const {
+  return std::any_of(links_.begin(), links_.end(),
+                     [zone](const Link &link) { return link.zone == zone; });
+}
+
+bool ProbeRouter::isAnyStarted() const {
+  return std::any_of(zones_.begin(), zones_.end(),
+                     [](const Zone &zone) { return zone.is_started; });
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Context.h"
+#include "ProbeSink.h"
+#include "Thermometer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Shares one thermometer, and its probes, between zones. Each zone gets a
+// Thermometer of its own to start and stop. A started zone takes back the
+// probe it had last whenever that joins again, on whichever link. Another
+// probe goes to the started zone without one, but only once a single zone
+// is left searching: with several there is no telling which pot it is in.
+// A probe stays with its zone until it disconnects; readings reach the zone
+// while it is started. Called from the main loop only.
+class ProbeRouter final : public ProbeSink {
+public:
+  static constexpr size_t kMaxZones = 4;
+  static constexpr size_t kMaxProbes = 4;
+  static constexpr size_t kNoZone = kMaxZones;
+
+  ProbeRouter(const Context &context, Thermometer &thermometer);
+
+  // For the zone's StoveSupervisor, `zone` below kMaxZones.
+  Thermometer &getThermometer(size_t zone) { return zones_[zone].thermometer; }
+  // Where the readings of the zone's probes go. Zones without get none.
+  void setProbes(size_t zone, ProbeSink &probes) {
+    zones_[zone].probes = &probes;
+  }
+
+  void addProbe(size_t probe, const PeerAddress &address) override;
+  void addReading(size_t probe, float value, uint32_t time_ms) override;
+  void removeProbe(size_t probe) override;
+
+  // kNoZone if no zone owns `probe`.
+  size_t getZone(size_t probe) const;
+
+private:
+  class ZoneThermometer final : public Thermometer {
+  public:
+    void start() override { router_->startZone(zone_); }
+    void stop() override { router_->stopZone(zone_); }
+    bool connected() override { return router_->hasProbe(zone_); }
+
+  private:
+    friend class ProbeRouter;
+
+    ProbeRouter *router_ = nullptr;
+    size_t zone_ = 0;
+  };
+
+  struct Zone {
+    ZoneThermometer thermometer;
+    ProbeSink *probes = nullptr;
+    bool is_started = false;
+    bool has_probe_address = false;
+    PeerAddress probe_address; // Of the probe it had last
+  };
+
+  // The probe on one link of the thermometer.
+  struct Link {
+    bool has_address = false;
+    PeerAddress address;
+    size_t zone = kNoZone;
+  };
+
+  // Gives the probe on `probe` to a zone if one is due it.
+  void assignProbe(size_t probe);
+  size_t findZone(const PeerAddress &address) const;
+  void startZone(size_t zone);
+  void stopZone(size_t zone);
+  bool hasProbe(size_t zone) const;
+  bool isAnyStarted() const;
+
+  Logger &log_;
+  Thermometer &thermometer_;
+
+  std::array<Zone, kMaxZones> zones_;
+  std::array<Link, kMaxProbes> links_;
+};
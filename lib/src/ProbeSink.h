@@ -0,0 +1,17 @@
+#pragma once
+
+#include "PeerAddress.h"
+#include <cstddef>
+#include <cstdint>
+
+// Takes the readings of probes, by the index of their connection.
+class ProbeSink {
+public:
+  virtual ~ProbeSink() = default;
+
+  // When a probe joined, with its address, before its first reading.
+  virtual void addProbe(size_t, const PeerAddress &) {}
+  virtual void addReading(size_t probe, float value, uint32_t time_ms) = 0;
+  // When `probe` disconnected. A probe joining again starts over.
+  virtual void removeProbe(size_t probe) = 0;
+};
@@ -0,0 +1,48 @@
+#include "Profiler.h"
+
+std::array<Profiler::Scope, Profiler::kMaxScopes> Profiler::scopes_;
+std::atomic<size_t> Profiler::count_{0};
+
+Profiler::Scope *Profiler::registerScope(const char *name) {
+  size_t index = count_.load(std::memory_order_relaxed);
+  do {
+    if (index == kMaxScopes) {
+      return nullptr;
+    }
+  } while (!count_.compare_exchange_weak(index, index + 1,
+                                         std::memory_order_relaxed));
+  scopes_[index].name.store(name, std::memory_order_release);
+  return &scopes_[index];
+}
+
+size_t Profiler::getScopeCount() {
+  return count_.load(std::memory_order_relaxed);
+}
+
+const Profiler::Scope *Profiler::getScope(size_t index) {
+  const Scope &scope = scopes_[index];
+  return scope.name.load(std::memory_order_acquire) ? &scope : nullptr;
+}
+
+void Profiler::clear() {
+  for (Scope &scope : scopes_) {
+    scope.ticks.clear();
+  }
+}
+
+void Profiler::dump(Logger &out, uint32_t ticks_per_us) {
+  out << "Profile: count min/mean/p99/max µs\n";
+  const float us_per_tick = 1.0f / ticks_per_us;
+  for (size_t i = 0; i < getScopeCount(); ++i) {
+    const Scope *scope = getScope(i);
+    if (!scope) {
+      continue;
+    }
+    const Histogram &ticks = scope->ticks;
+    out << scope->name.load(std::memory_order_relaxed) << ": "
+        << ticks.getCount() << " " << ticks.getMin() * us_per_tick << "/"
+        << ticks.getMean() * us_per_tick << "/"
+        << ticks.getPercentile(0.99f) * us_per_tick << "/"
+        << ticks.getMax() * us_per_tick << "\n";
+  }
+}
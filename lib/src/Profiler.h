@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Histogram.h"
+#include "Logger.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// A free-running 32-bit counter, defined by the platform: CPU cycles from
+// the DWT on the target, nanoseconds on the host.
+uint32_t readProfileTicks();
+
+// Time spent in named scopes, in a fixed static table. Scopes register on
+// first use from any task; each should then only be entered from that one
+// task, which is the single writer of its histogram.
+class Profiler {
+public:
+  static constexpr size_t kMaxScopes = 12;
+
+  struct Scope {
+    std::atomic<const char *> name{nullptr};
+    Histogram ticks;
+  };
+
+  // A new scope, or nullptr once the table is full. `name` must outlive the
+  // program, like a string literal.
+  static Scope *registerScope(const char *name);
+
+  static size_t getScopeCount();
+  // nullptr while the scope at `index` is still registering.
+  static const Scope *getScope(size_t index);
+
+  // Scopes recording on other tasks meanwhile may keep part of a record.
+  static void clear();
+  // One line per scope: count, then min, mean, p99 and max in µs.
+  static void dump(Logger &out, uint32_t ticks_per_us);
+
+private:
+  static std::array<Scope, kMaxScopes> scopes_;
+  static std::atomic<size_t> count_;
+};
+
+// Records the ticks from construction to destruction into a scope.
+class ProfileTimer {
+public:
+  explicit ProfileTimer(Profiler::Scope *scope)
+      : scope_(scope), start_(readProfileTicks()) {}
+  ~ProfileTimer() {
+    if (scope_) {
+      scope_->ticks.record(readProfileTicks() - start_);
+    }
+  }
+
+  ProfileTimer(const ProfileTimer &) = delete;
+  ProfileTimer &operator=(const ProfileTimer &) = delete;
+
+private:
+  Profiler::Scope *const scope_;
+  const uint32_t start_;
+};
+
+// Usage: PROFILE_SCOPE("StoveSupervisor::update");
+// Times the rest of the enclosing block. Compiled in with -DKRC_PROFILE only.
+#ifdef KRC_PROFILE
+#define KRC_PROFILE_CONCAT_(a, b) a##b
+#define KRC_PROFILE_CONCAT(a, b) KRC_PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)                                                   \
+  static Profiler::Scope *const KRC_PROFILE_CONCAT(krc_profile_scope_,        \
+                                                   __LINE__) =                \
+      Profiler::registerScope(name);                                          \
+  ProfileTimer KRC_PROFILE_CONCAT(krc_profile_timer_, __LINE__)(              \
+      KRC_PROFILE_CONCAT(krc_profile_scope_, __LINE__))
+#else
+#define PROFILE_SCOPE(name)                                                   \
+  do {                                                                        \
+  } while (0)
+#endif
@@ -0,0 +1,125 @@
+#include "PwmSequence.h"
+#include "Led.h"
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t kMaxTop = 0x7FFF;
+// Never reached by the counter, so the channel stays at its first level.
+// Compare values of steady entries are given as fractions of it.
+constexpr uint16_t kFullScale = 0x7FFF;
+// Audible and within the 15-bit counter at 8 MHz.
+constexpr uint32_t kMinFrequencyHz = kPwmClockHz / kMaxTop + 1;
+constexpr uint32_t kMaxFrequencyHz = 20000;
+
+class Writer {
+public:
+  Writer(PwmEntry *entries, size_t capacity)
+      : entries_(entries), capacity_(capacity) {}
+
+  // Levels that do not change within a period, as fractions of kFullScale,
+  // at whatever top divides the duration most exactly.
+  void appendSteady(uint16_t compare0, uint16_t compare1, uint32_t duration_ms) {
+    if (duration_ms == 0) {
+      return;
+    }
+    uint64_t ticks = uint64_t{duration_ms} * (kPwmClockHz / 1000);
+    uint64_t entry_ticks = uint64_t{kMaxTop} * kPwmPeriodsPerEntry;
+    uint64_t count = (ticks + entry_ticks - 1) / entry_ticks;
+    uint64_t top =
+        (ticks + count * kPwmPeriodsPerEntry / 2) / (count * kPwmPeriodsPerEntry);
+    for (uint64_t i = 0; i < count; ++i) {
+      append({{scale(compare0, top), scale(compare1, top), 0},
+              static_cast<uint16_t>(top)});
+    }
+  }
+
+  void appendTone(uint32_t frequency_hz, uint32_t duration_ms) {
+    if (frequency_hz < kMinFrequencyHz || frequency_hz > kMaxFrequencyHz) {
+      is_failed_ = true;
+      return;
+    }
+    uint16_t top = static_cast<uint16_t>(
+        (kPwmClockHz + frequency_hz / 2) / frequency_hz);
+    uint32_t periods = duration_ms * frequency_hz / 1000;
+    uint32_t count =
+        (periods + kPwmPeriodsPerEntry / 2) / kPwmPeriodsPerEntry;
+    uint16_t half = top / 2;
+    for (uint32_t i = 0; i < count; ++i) {
+      append({{half, static_cast<uint16_t>(half | kPwmFallingEdge), 0}, top});
+    }
+  }
+
+  size_t finish() const { return is_failed_ ? 0 : size_; }
+
+private:
+  static uint16_t scale(uint16_t compare, uint64_t top) {
+    uint16_t value = compare & ~kPwmFallingEdge;
+    uint16_t edge = compare & kPwmFallingEdge;
+    if (value == 0 || value == kFullScale) {
+      return compare;
+    }
+    return static_cast<uint16_t>(value * top / kFullScale) | edge;
+  }
+
+  void append(const PwmEntry &entry) {
+    if (size_ == capacity_) {
+      is_failed_ = true;
+      return;
+    }
+    entries_[size_++] = entry;
+  }
+
+  PwmEntry *const entries_;
+  const size_t capacity_;
+  size_t size_ = 0;
+  bool is_failed_ = false;
+};
+
+} // namespace
+
+size_t compileTones(const Pattern &tones, PwmEntry *entries, size_t capacity) {
+  Writer writer(entries, capacity);
+  auto append_silence = [&](uint32_t duration_ms) {
+    writer.appendSteady(kFullScale, kPwmFallingEdge, duration_ms);
+  };
+  for (size_t i = 0; i < tones.size; ++i) {
+    const PatternStep &step = tones.steps[i];
+    if (step.value == 0) {
+      append_silence(step.duration_ms);
+    } else {
+      writer.appendTone(step.value, step.duration_ms);
+    }
+  }
+  if (!tones.repeat) {
+    // The PWM holds the last entry once the sequence ends.
+    append_silence(1);
+  }
+  return writer.finish();
+}
+
+size_t compileBrightness(const Pattern &brightness, PwmEntry *entries,
+                         size_t capacity) {
+  Writer writer(entries, capacity);
+  // Low, and so lit, until the counter reaches the compare value.
+  auto append_level = [&](uint16_t level, uint32_t duration_ms) {
+    uint32_t compare = uint32_t{level} * kFullScale / Led::kOn;
+    writer.appendSteady(static_cast<uint16_t>(compare), 0, duration_ms);
+  };
+  for (size_t i = 0; i < brightness.size; ++i) {
+    const PatternStep &step = brightness.steps[i];
+    append_level(std::min<uint16_t>(step.value, Led::kOn), step.duration_ms);
+  }
+  if (!brightness.repeat) {
+    append_level(Led::kOff, 1);
+  }
+  return writer.finish();
+}
+
+uint64_t getPwmDurationUs(const PwmEntry *entries, size_t count) {
+  uint64_t ticks = 0;
+  for (size_t i = 0; i < count; ++i) {
+    ticks += uint64_t{entries[i].top} * kPwmPeriodsPerEntry;
+  }
+  return ticks * 1000000 / kPwmClockHz;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Pattern.h"
+#include <cstddef>
+#include <cstdint>
+
+// Patterns compiled for the nRF52 PWM in waveform mode, which takes the
+// counter top from each entry along with the compare values, so a single
+// sequence can change pitch and keep exact step durations. Each entry lasts
+// kPwmPeriodsPerEntry PWM periods (REFRESH = kPwmPeriodsPerEntry - 1).
+struct PwmEntry {
+  // Channels 0 to 2, with bit 15 set for a falling edge first. With the
+  // bit clear a channel is low until the counter reaches the value.
+  uint16_t compare[3];
+  uint16_t top;
+};
+
+constexpr uint32_t kPwmClockHz = 8000000;
+constexpr uint32_t kPwmPeriodsPerEntry = 10;
+constexpr uint16_t kPwmFallingEdge = 0x8000;
+
+// Channels 0 and 1 in antiphase at each tone, both low in silence. Returns
+// the number of entries written, 0 if they do not fit into `capacity` or a
+// frequency is out of range.
+size_t compileTones(const Pattern &tones, PwmEntry *entries, size_t capacity);
+// Channel 0 at each brightness, for an LED that lights when the pin is low.
+size_t compileBrightness(const Pattern &brightness, PwmEntry *entries,
+                         size_t capacity);
+
+// Playing time of `count` entries.
+uint64_t getPwmDurationUs(const PwmEntry *entries, size_t count);
@@ -0,0 +1,172 @@
+#include "RelayAutotuner.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Share of the ultimate gain used as p_factor. Ziegler-Nichols suggest 0.5
+// for P-only control; the lookahead adds some phase margin on top.
+constexpr float kUltimateGainShare = 0.5f;
+
+} // namespace
+
+RelayAutotuner::RelayAutotuner(const Context &context,
+                               const AutotuneConfig &config)
+    : clock_(context.clock), log_(context.log), config_(config) {}
+
+void RelayAutotuner::start() {
+  LOG_INFO(log_, kController) << "RelayAutotuner started\n";
+  status_ = Status::kRunning;
+  start_ms_ = clock_.millis();
+  last_sample_ms_ = 0;
+  relay_on_ = true;
+  high_power_ = config_.max_power;
+  low_power_ = 0.0f;
+  in_cycle_ = false;
+  cycles_ = 0;
+  sum_ = {};
+}
+
+float RelayAutotuner::getPower() const {
+  if (status_ != Status::kRunning) {
+    return 0.0f;
+  }
+  return relay_on_ ? high_power_ : low_power_;
+}
+
+RelayAutotuner::Status
+RelayAutotuner::update(const TemperatureEstimator::Estimate &estimate,
+                       float target_temp) {
+  if (status_ != Status::kRunning) {
+    return status_;
+  }
+  uint32_t now = clock_.millis();
+  if (in_cycle_ ? now - oscillation_start_ms_ > config_.timeout_ms
+                : now - start_ms_ > config_.heat_up_timeout_ms) {
+    LOG_WARNING(log_, kController) << "RelayAutotuner timed out after "
+                                   << cycles_ << " cycles\n";
+    status_ = Status::kFailed;
+    return status_;
+  }
+  if (estimate.count == 0 || estimate.last_update_ms == last_sample_ms_) {
+    return status_;
+  }
+
+  uint32_t time_ms = estimate.last_update_ms;
+  float temp = estimate.value;
+  if (in_cycle_) {
+    temp_integral_ += static_cast<double>(temp) * (time_ms - last_sample_ms_);
+  }
+  last_sample_ms_ = time_ms;
+
+  if (relay_on_) {
+    if (temp < trough_) {
+      trough_ = temp;
+      trough_ms_ = time_ms;
+    }
+    if (temp > target_temp + config_.hysteresis) {
+      if (in_cycle_) {
+        finishCycle(time_ms);
+      } else {
+        oscillation_start_ms_ = time_ms;
+      }
+      relay_on_ = false;
+      in_cycle_ = true;
+      switch_off_ms_ = time_ms;
+      peak_ = temp;
+      peak_ms_ = time_ms;
+      temp_integral_ = 0.0;
+    }
+  } else {
+    if (temp > peak_) {
+      peak_ = temp;
+      peak_ms_ = time_ms;
+    }
+    if (temp < target_temp - config_.hysteresis) {
+      relay_on_ = true;
+      switch_on_ms_ = time_ms;
+      trough_ = temp;
+      trough_ms_ = time_ms;
+    }
+  }
+  return status_;
+}
+
+void RelayAutotuner::finishCycle(uint32_t time_ms) {
+  uint32_t period_ms = time_ms - switch_off_ms_;
+  uint32_t on_ms = time_ms - switch_on_ms_;
+  float mean_power =
+      (high_power_ * on_ms + low_power_ * (period_ms - on_ms)) / period_ms;
+  float relay_amplitude = (high_power_ - low_power_) / 2;
+
+  ++cycles_;
+  if (cycles_ <= config_.settle_cycles) {
+    // Center the relay on the power that holds the target: a symmetric
+    // oscillation is faster, and its amplitude reflects the plant better.
+    high_power_ = std::min(mean_power + config_.relay_amplitude,
+                           config_.max_power);
+    low_power_ = std::max(mean_power - config_.relay_amplitude, 0.0f);
+  }
+  // Over a cycle at steady levels the plant sees the power it was given;
+  // otherwise it gets the old levels for the lag and the mean is off.
+  if (cycles_ <= config_.settle_cycles + 1) {
+    return;
+  }
+
+  sum_.relay_amplitude += relay_amplitude;
+  sum_.period_ms += period_ms;
+  sum_.amplitude += (peak_ - trough_) / 2;
+  sum_.mean_temp += temp_integral_ / period_ms;
+  sum_.mean_power += mean_power;
+  sum_.lag_ms += ((peak_ms_ - switch_off_ms_) + (trough_ms_ - switch_on_ms_)) / 2;
+
+  LOG_DEBUG(log_, kController)
+      << "RelayAutotuner cycle " << cycles_ << ": period " << period_ms
+      << "ms, peak " << peak_ << ", trough " << trough_ << "\n";
+
+  if (cycles_ > config_.settle_cycles + config_.cycles) {
+    Measurement measurement = getMeasurement();
+    LOG_INFO(log_, kController)
+        << "RelayAutotuner done after " << (time_ms - start_ms_) / 1000
+        << "s: period " << measurement.period_ms
+        << "ms, amplitude " << measurement.amplitude << ", lag "
+        << measurement.lag_ms << "ms, power " << measurement.mean_power
+        << " at " << measurement.mean_temp << "\n";
+    status_ = Status::kDone;
+  }
+}
+
+RelayAutotuner::Measurement RelayAutotuner::getMeasurement() const {
+  uint32_t skipped = config_.settle_cycles + 1;
+  uint32_t measured = cycles_ > skipped ? cycles_ - skipped : 1;
+  Measurement measurement = sum_;
+  measurement.relay_amplitude /= measured;
+  measurement.period_ms /= measured;
+  measurement.amplitude /= measured;
+  measurement.mean_temp /= measured;
+  measurement.mean_power /= measured;
+  measurement.lag_ms /= measured;
+  return measurement;
+}
+
+ThermalConfig RelayAutotuner::getTunedConfig(const ThermalConfig &base) const {
+  Measurement measurement = getMeasurement();
+  ThermalConfig tuned = base;
+
+  // Describing function of the relay: the loop gain at which the
+  // oscillation would just sustain itself.
+  if (measurement.amplitude > 0.0f) {
+    float ultimate_gain = 4 * measurement.relay_amplitude /
+                          (static_cast<float>(M_PI) * measurement.amplitude);
+    tuned.p_factor = kUltimateGainShare * ultimate_gain;
+  }
+  tuned.system_lag_ms = measurement.lag_ms;
+  if (float rise = measurement.mean_temp - base.ambient_temp; rise > 0.0f) {
+    tuned.heat_loss_factor = measurement.mean_power / rise;
+  }
+  // Measured on this pot, so keep them over whatever the identifier fits
+  // from the relay run.
+  tuned.identify_plant = false;
+  return tuned;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Context.h"
+#include "TemperatureEstimator.h"
+#include "ThermalController.h"
+#include <cstdint>
+
+struct AutotuneConfig {
+  float max_power = 1.0f;                       // Relay high at first
+  float relay_amplitude = 0.3f;                 // Then around holding power
+  float hysteresis = 0.3f;                      // Around the target (°C)
+  uint32_t settle_cycles = 2;                   // Re-centering the relay
+  uint32_t cycles = 2;                          // Oscillations measured
+  uint32_t heat_up_timeout_ms = 60 * 60 * 1000; // To reach the target
+  uint32_t timeout_ms = 25 * 60 * 1000;         // From there to done
+};
+
+// Relay-feedback autotuning: switches the burner between two levels around
+// the target and derives a ThermalConfig from the resulting oscillation.
+// The relay is re-centered on the holding power after each of the first
+// settle_cycles oscillations, then held. Those oscillations, and the next,
+// which still heats with the old levels for the lag, are discarded.
+class RelayAutotuner {
+public:
+  enum class Status { kRunning, kDone, kFailed };
+
+  // Averages over the measured oscillations.
+  struct Measurement {
+    float relay_amplitude = 0.0f;  // Half of high to low power
+    uint32_t period_ms = 0;
+    float amplitude = 0.0f;  // Half of peak to trough (°C)
+    float mean_temp = 0.0f;  // °C
+    float mean_power = 0.0f; // Needed to hold mean_temp
+    uint32_t lag_ms = 0;     // From switching to the turn of the temperature
+  };
+
+  RelayAutotuner(const Context &context, const AutotuneConfig &config);
+  virtual ~RelayAutotuner() = default;
+
+  virtual void start();
+  // Called every update with the latest estimate.
+  virtual Status update(const TemperatureEstimator::Estimate &estimate,
+                        float target_temp);
+  virtual float getPower() const;
+
+  // Valid once done.
+  virtual Measurement getMeasurement() const;
+  // base with p_factor, system_lag_ms and heat_loss_factor replaced, and
+  // plant identification off so they stay in use.
+  virtual ThermalConfig getTunedConfig(const ThermalConfig &base) const;
+
+private:
+  void finishCycle(uint32_t time_ms);
+
+  const Clock &clock_;
+  Logger &log_;
+  const AutotuneConfig config_;
+
+  Status status_ = Status::kFailed;
+  uint32_t start_ms_ = 0;
+  uint32_t oscillation_start_ms_ = 0;
+  uint32_t last_sample_ms_ = 0;
+  bool relay_on_ = false;
+  float high_power_ = 0.0f;
+  float low_power_ = 0.0f;
+
+  // The current cycle, from one switch off to the next.
+  bool in_cycle_ = false;
+  uint32_t switch_off_ms_ = 0;
+  uint32_t switch_on_ms_ = 0;
+  float peak_ = 0.0f;
+  uint32_t peak_ms_ = 0;
+  float trough_ = 0.0f;
+  uint32_t trough_ms_ = 0;
+  double temp_integral_ = 0.0; // °C·ms
+
+  uint32_t cycles_ = 0;
+  Measurement sum_;
+};
@@ -0,0 +1,30 @@
+#include "ScanPolicy.h"
+
+ScanPolicy::Step ScanPolicy::getStep(uint32_t elapsed_ms,
+                                     bool has_last_probe) {
+  uint32_t start_ms = 0;
+  if (has_last_probe) {
+    if (elapsed_ms < kDirectMs) {
+      return {Mode::kDirect, kWindowMs, kWindowMs, kDirectMs};
+    }
+    start_ms = kDirectMs;
+  }
+
+  // Continuous, right after the start or a dropout.
+  if (elapsed_ms - start_ms < kFastScanMs) {
+    return {Mode::kScan, kWindowMs, kWindowMs, start_ms + kFastScanMs};
+  }
+  start_ms += kFastScanMs;
+
+  // Then the interval doubles every step, from 200 ms.
+  uint32_t interval_ms = 2 * kWindowMs;
+  while (interval_ms < kMaxIntervalMs) {
+    if (elapsed_ms - start_ms < kBackoffStepMs) {
+      return {Mode::kScan, static_cast<uint16_t>(interval_ms), kWindowMs,
+              start_ms + kBackoffStepMs};
+    }
+    start_ms += kBackoffStepMs;
+    interval_ms *= 2;
+  }
+  return {Mode::kScan, kMaxIntervalMs, kWindowMs, kForever};
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// How hard the thermometer looks for its probe, by the time since it began
+// to: first a direct connection to the last probe, if there was one, which
+// picks up its next advertisement; then continuous scanning; then scans
+// further and further apart, down to a few percent of the radio time.
+class ScanPolicy {
+public:
+  enum class Mode : uint8_t {
+    kDirect, // Connect to the last probe, by address
+    kScan,   // Scan for any probe
+  };
+
+  struct Step {
+    Mode mode;
+    uint16_t interval_ms;
+    uint16_t window_ms;
+    // Time since the search began at which the next step starts.
+    uint32_t end_ms;
+
+    bool operator==(const Step &other) const {
+      return mode == other.mode && interval_ms == other.interval_ms &&
+             window_ms == other.window_ms;
+    }
+    bool operator!=(const Step &other) const { return !(*this == other); }
+  };
+
+  static constexpr uint32_t kDirectMs = 3000;
+  static constexpr uint32_t kFastScanMs = 10000;
+  static constexpr uint32_t kBackoffStepMs = 15000;
+  static constexpr uint16_t kWindowMs = 100;
+  static constexpr uint16_t kMaxIntervalMs = 3200;
+  static constexpr uint32_t kForever = UINT32_MAX;
+
+  // The step at `elapsed_ms` into a search.
+  static Step getStep(uint32_t elapsed_ms, bool has_last_probe);
+};
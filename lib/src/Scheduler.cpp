@@ -0,0 +1,19 @@
+#include "Scheduler.h"
+#include <algorithm>
+
+Scheduler::Scheduler(const Clock &clock, uint32_t max_sleep_ms)
+    : clock_(clock), max_sleep_ms_(max_sleep_ms) {}
+
+void Scheduler::begin() {
+  now_ms_ = clock_.millis();
+  sleep_ms_ = max_sleep_ms_;
+}
+
+void Scheduler::requestUpdateAt(uint32_t time_ms) {
+  int32_t delta_ms = static_cast<int32_t>(time_ms - now_ms_);
+  sleep_ms_ = std::min(sleep_ms_, static_cast<uint32_t>(std::max(delta_ms, 0)));
+}
+
+void Scheduler::requestUpdateIn(uint32_t duration_ms) {
+  sleep_ms_ = std::min(sleep_ms_, duration_ms);
+}
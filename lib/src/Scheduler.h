@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Clock.h"
+#include <cstdint>
+
+// Collects the times at which modules next need an update, so the main loop
+// can sleep until the earliest one instead of polling.
+class Scheduler {
+public:
+  Scheduler(const Clock &clock, uint32_t max_sleep_ms);
+
+  // Starts collecting requests for the next sleep.
+  void begin();
+
+  void requestUpdateAt(uint32_t time_ms);
+  void requestUpdateIn(uint32_t duration_ms);
+
+  // Time until the earliest requested update, at most max_sleep_ms.
+  uint32_t getSleepMs() const { return sleep_ms_; }
+
+private:
+  const Clock &clock_;
+  const uint32_t max_sleep_ms_;
+
+  uint32_t now_ms_ = 0;
+  uint32_t sleep_ms_ = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Publishes a value from one writer thread to any number of reader threads
+// without locks. Readers retry while a store is in progress, so they always
+// see one complete value; the writer never waits.
+//
+// The value is copied through atomic words, which keeps concurrent access
+// well defined.
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  SeqLock() : SeqLock(T{}) {}
+  explicit SeqLock(const T &value) { store(value); }
+
+  // Writer side.
+  void store(const T &value) {
+    std::array<uint32_t, kWords> words = {};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T load() const {
+    std::array<uint32_t, kWords> words;
+    uint32_t sequence;
+    do {
+      sequence = sequence_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kWords; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) ||
+             sequence != sequence_.load(std::memory_order_relaxed));
+
+    T value;
+    std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+    return value;
+  }
+
+private:
+  static constexpr size_t kWords = (sizeof(T) + 3) / 4;
+
+  // Odd while a store is in progress.
+  std::atomic<uint32_t> sequence_ = 0;
+  std::array<std::atomic<uint32_t>, kWords> words_;
+};
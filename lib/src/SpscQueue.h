@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free queue between one producer and one consumer thread.
+// Pushing to a full queue drops the element and counts the overflow, so the
+// producer never waits.
+template <typename T, size_t N> class SpscQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+  // Producer side.
+  bool push(const T &value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == N) {
+      overflow_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buffer_[tail % N] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.
+  bool pop(T &value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = buffer_[head % N];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  // Number of elements dropped because the queue was full.
+  uint32_t getOverflowCount() const {
+    return overflow_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::array<T, N> buffer_;
+  // Free-running; N divides their range, so wrapping is harmless.
+  std::atomic<size_t> head_ = 0;
+  std::atomic<size_t> tail_ = 0;
+  std::atomic<uint32_t> overflow_count_ = 0;
+};
@@ -4,19 +4,26 @@
 #include "sfloat.h"
 #include <algorithm>
 
-extern "C" uint32_t millis();
+namespace {
 
-StoveActuator::StoveActuator(Potentiometer &potentiometer,
+// Duration of each half of a boost pulse.
+constexpr uint32_t kBoostPulseMs = 1000;
+
+} // namespace
+
+StoveActuator::StoveActuator(const Context &context,
+                             Potentiometer &potentiometer,
                              DigitalWritePin &bypass_pin,
                              const ThrottleConfig &config)
-    : potentiometer_(potentiometer), bypass_pin_(bypass_pin), config_(config), is_bypass_(false) {
+    : clock_(context.clock), log_(context.log), potentiometer_(potentiometer),
+      bypass_pin_(bypass_pin), config_(config), is_bypass_(false) {
 }
 
 void StoveActuator::setBypass() {
   if (is_bypass_) {
     return;
   }
-  Log << "StoveActuator::setBypass()\n";
+  LOG_DEBUG(log_, kActuator) << "StoveActuator::setBypass()\n";
   bypass_pin_.set(PinState::Low);
   current_boost_ = config_.num_boosts;
   is_bypass_ = true;
@@ -25,7 +32,8 @@ void StoveActuator::setBypass() {
 
 void StoveActuator::setThrottle(const StoveThrottle &throttle) {
   if (is_bypass_ || !isNear(throttle, printed_throttle_)) {
-    Log << "StoveActuator::setThrottle(/*position=*/" << throttle.position
+    LOG_DEBUG(log_, kActuator)
+        << "StoveActuator::setThrottle(/*position=*/" << throttle.position
         << ", /*boost=*/" << throttle.boost << ")\n";
     printed_throttle_ = throttle;
   }
@@ -55,7 +63,7 @@ void StoveActuator::update() {
     return;
   }
 
-  uint32_t now = millis();
+  uint32_t now = clock_.millis();
   if (throttle_.boost < current_boost_) {
     potentiometer_.setValue(std::min(deboost_value, value));
     current_boost_ = 0;
@@ -64,7 +72,7 @@ void StoveActuator::update() {
     return;
   }
 
-  if (now - last_boost_change_ms_ < 1000) {
+  if (now - last_boost_change_ms_ < kBoostPulseMs) {
     return;
   }
 
@@ -78,3 +86,9 @@ void StoveActuator::update() {
   is_boost_pulse_active_ = !is_boost_pulse_active_;
   last_boost_change_ms_ = now;
 }
+
+void StoveActuator::schedule(Scheduler &scheduler) const {
+  if (!is_bypass_ && throttle_.boost > current_boost_) {
+    scheduler.requestUpdateAt(last_boost_change_ms_ + kBoostPulseMs);
+  }
+}
@@ -1,20 +1,26 @@
 #pragma once
 
+#include "Context.h"
 #include "Potentiometer.h"
+#include "Scheduler.h"
 #include "DigitalWritePin.h"
 #include "StoveThrottle.h"
 #include <cstdint>
 
 class StoveActuator {
 public:
-  StoveActuator(Potentiometer &potentiometer, DigitalWritePin &bypass_pin, const ThrottleConfig &config);
+  StoveActuator(const Context &context, Potentiometer &potentiometer,
+                DigitalWritePin &bypass_pin, const ThrottleConfig &config);
   virtual ~StoveActuator() = default;
 
   virtual void setBypass();
   virtual void setThrottle(const StoveThrottle &throttle);
   virtual void update();
+  virtual void schedule(Scheduler &scheduler) const;
 
 private:
+  const Clock &clock_;
+  Logger &log_;
   Potentiometer &potentiometer_;
   DigitalWritePin &bypass_pin_;
   const ThrottleConfig config_;
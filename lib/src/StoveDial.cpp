@@ -2,35 +2,106 @@
 #include "Logger.h"
 #include "StoveThrottle.h"
 #include <algorithm>
-#include <cassert>
 #include <cmath>
-#include <memory>
-#include <numeric>
 
-StoveDial::StoveDial(const AnalogReadPin &pin, const ThrottleConfig &config)
-    : pin_(pin), config_(config) {
+namespace {
+
+// Cutoff while the knob rests, and its rise per unit of dial per second.
+constexpr float kMinCutoffHz = 1.0f;
+constexpr float kCutoffPerRate = 10.0f;
+// Smoothing of the rate itself, against noise raising the cutoff.
+constexpr float kRateCutoffHz = 5.0f;
+// How far the value must fall back below min or boil to switch back.
+constexpr float kHysteresis = 0.02f;
+// Closer than this to a steady input, the output snaps to it.
+constexpr float kSettled = 1e-6f;
+
+// Weight of a new sample for a first-order low-pass.
+float getAlpha(float cutoff_hz, float dt_s) {
+  constexpr float kTwoPi = 6.2831853f;
+  return 1.0f / (1.0f + 1.0f / (kTwoPi * cutoff_hz * dt_s));
 }
 
-void StoveDial::update() {
-  auto begin = last_readings_.begin();
-  auto end = last_readings_.end();
+} // namespace
 
-  std::move(begin + 1, end, begin);
-  last_readings_.back() = pin_.read();
+StoveDial::StoveDial(const Context &context, const AnalogReadPin &pin,
+                     const ThrottleConfig &config)
+    : clock_(context.clock), log_(context.log), pin_(pin), config_(config) {}
 
-  float sum = std::accumulate(begin, end, 0.0f);
-  value_ = std::clamp(sum / last_readings_.size(), 0.0f, 1.0f);
+void StoveDial::update() {
+  std::array<float, kMaxBlockSize> block;
+  if (size_t count = pin_.readBlock(block.data(), block.size()); count > 0) {
+    last_block_mean_ = averageBlock(block.data(), count);
+  }
+  filter(std::clamp(last_block_mean_, 0.0f, 1.0f), clock_.millis());
+  updateThresholds();
 
   if (std::fabs(value_ - printed_value_) < 0.02f) {
     return;
   }
-  Log << "StoveDial::update() value " << value_ << ", position "
-      << getPosition() << "\n";
+  LOG_DEBUG(log_, kDial) << "StoveDial::update() value " << value_
+                         << ", position " << getPosition() << "\n";
   printed_value_ = value_;
 }
 
+void StoveDial::filter(float sample, uint32_t now_ms) {
+  if (window_count_ == 0) {
+    value_ = sample;
+  } else if (now_ms != last_update_ms_) {
+    float dt_s = (now_ms - last_update_ms_) / 1000.0f;
+    rate_ += getAlpha(kRateCutoffHz, dt_s) * (getRate(sample, now_ms) - rate_);
+    float cutoff_hz = kMinCutoffHz + kCutoffPerRate * std::fabs(rate_);
+    value_ += getAlpha(cutoff_hz, dt_s) * (sample - value_);
+    if (std::fabs(sample - value_) < kSettled) {
+      value_ = sample;
+    }
+  }
+  last_update_ms_ = now_ms;
+
+  // Slide the window, re-summing once per lap so rounding cannot build up.
+  if (window_count_ == kWindowSize) {
+    window_sum_ -= window_[window_head_];
+    window_head_ = (window_head_ + 1) % kWindowSize;
+    --window_count_;
+  }
+  size_t tail = (window_head_ + window_count_++) % kWindowSize;
+  window_[tail] = sample;
+  window_times_ms_[tail] = now_ms;
+  window_sum_ += sample;
+  if (window_head_ == 0 && window_count_ == kWindowSize) {
+    window_sum_ = 0.0f;
+    for (float mean : window_) {
+      window_sum_ += mean;
+    }
+  }
+}
+
+float StoveDial::getRate(float sample, uint32_t now_ms) const {
+  // On a ramp, a new sample leads the mean of the window by the slope times
+  // the time since the window's mean time.
+  uint32_t lead_sum_ms = 0;
+  for (size_t i = 0; i < window_count_; ++i) {
+    lead_sum_ms += now_ms - window_times_ms_[(window_head_ + i) % kWindowSize];
+  }
+  if (lead_sum_ms == 0) {
+    return 0.0f;
+  }
+  float lead_s = lead_sum_ms / 1000.0f / window_count_;
+  return (sample - window_sum_ / window_count_) / lead_s;
+}
+
+void StoveDial::updateThresholds() {
+  if (is_off_ ? value_ >= config_.min : value_ < config_.min - kHysteresis) {
+    is_off_ = !is_off_;
+  }
+  if (is_boil_ ? value_ <= config_.boil - kHysteresis
+               : value_ > config_.boil) {
+    is_boil_ = !is_boil_;
+  }
+}
+
 float StoveDial::getPosition() const {
-  if (value_ < config_.min || value_ > config_.boil) {
+  if (is_off_ || is_boil_) {
     return 0.0f;
   }
 
@@ -38,5 +109,5 @@ float StoveDial::getPosition() const {
     return 1.0f;
   }
 
-  return value_ / config_.max;
+  return std::max(value_, 0.0f) / config_.max;
 }
@@ -1,25 +1,58 @@
 #pragma once
 
 #include "AnalogReadPin.h"
+#include "Context.h"
 #include "StoveThrottle.h"
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
+// Smooths the dial voltage. Each update reduces the block of samples
+// converted since the last one to its mean, and feeds it to an adaptive
+// low-pass filter (after the "one euro" filter): the cutoff rises with the
+// rate of change, so a spun knob follows within a few updates while a
+// resting one barely jitters. isOff() and isBoil() switch back only once
+// the value leaves the threshold by a margin.
 class StoveDial {
 public:
-  StoveDial(const AnalogReadPin &pin, const ThrottleConfig &config);
+  // Samples taken from the pin per update at most.
+  static constexpr size_t kMaxBlockSize = 32;
+  // Updates over which the rate of change is estimated.
+  static constexpr size_t kWindowSize = 4;
+
+  StoveDial(const Context &context, const AnalogReadPin &pin,
+            const ThrottleConfig &config);
   virtual ~StoveDial() = default;
 
   virtual float getPosition() const;
-  virtual bool isOff() const { return value_ < config_.min; }
-  virtual bool isBoil() const { return value_ > config_.boil; }
+  virtual bool isOff() const { return is_off_; }
+  virtual bool isBoil() const { return is_boil_; }
   virtual void update();
 
 private:
+  void filter(float sample, uint32_t now_ms);
+  void updateThresholds();
+  // The rate of change of `sample` against the window (1/s).
+  float getRate(float sample, uint32_t now_ms) const;
+
+  const Clock &clock_;
+  Logger &log_;
   const AnalogReadPin &pin_;
   const ThrottleConfig config_;
 
-  std::array<float, 4> last_readings_ = {};
+  float last_block_mean_ = 0.0f; // Repeated while no samples are new
+
+  // The last block means, oldest at window_head_, with their running sum.
+  std::array<float, kWindowSize> window_ = {};
+  std::array<uint32_t, kWindowSize> window_times_ms_ = {};
+  size_t window_head_ = 0;
+  size_t window_count_ = 0;
+  float window_sum_ = 0.0f;
+
+  uint32_t last_update_ms_ = 0;
+  float rate_ = 0.0f; // Smoothed rate of change (1/s)
   float value_ = 0.0f;
+  bool is_off_ = true;
+  bool is_boil_ = false;
   float printed_value_ = 0.0f;
 };
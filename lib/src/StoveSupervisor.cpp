@@ -1,38 +1,49 @@
 #include "StoveSupervisor.h"
 #include "Logger.h"
+#include "Profiler.h"
 #include <algorithm>
 #include <cmath>
 
-extern "C" uint32_t millis();
+namespace {
 
-StoveSupervisor::StoveSupervisor(StoveDial &dial, StoveActuator &actuator,
+constexpr uint32_t cooldown_after_ms = 1000;
+constexpr uint32_t active_after_ms = 3 * 1000;
+constexpr uint32_t stove_clear_duration_ms = 300;
+constexpr uint32_t disconnected_after_ms = 30 * 1000;
+constexpr uint32_t sleep_after_ms = 10 * 1000;
+
+// How often the dial is sampled while the stove is in use, and while waiting
+// for it to be turned on.
+constexpr uint32_t dial_poll_ms = 10;
+constexpr uint32_t idle_dial_poll_ms = 100;
+
+} // namespace
+
+StoveSupervisor::StoveSupervisor(const Context &context, StoveDial &dial,
+                                 StoveActuator &actuator,
                                  ThermalController &controller, Beeper &beeper,
-                                 TrendAnalyzer &analyzer,
+                                 TemperatureEstimator &estimator,
                                  Thermometer &thermometer,
+                                 RelayAutotuner &autotuner,
                                  const StoveConfig &stove_config,
                                  const ThrottleConfig &throttle_config)
-    : dial_(dial), actuator_(actuator), controller_(controller),
-      beeper_(beeper), analyzer_(analyzer), thermometer_(thermometer),
+    : clock_(context.clock), log_(context.log), dial_(dial),
+      actuator_(actuator), controller_(controller), beeper_(beeper),
+      estimator_(estimator), thermometer_(thermometer), autotuner_(autotuner),
       stove_config_(stove_config), throttle_config_(throttle_config) {}
 
 static float lerp(float a, float b, float t) { return a + t * (b - a); }
 
 void StoveSupervisor::update() {
-  uint32_t now = millis();
+  PROFILE_SCOPE("StoveSupervisor::update");
+  uint32_t now = clock_.millis();
   dial_.update();
-  beeper_.update();
 
   if (!dial_.isOff()) {
     dial_off_start_ms_ = now;
   }
 
-  constexpr uint32_t cooldown_after_ms = 1000;
-  constexpr uint32_t active_after_ms = 3 * 1000;
-  constexpr uint32_t stove_clear_duration_ms = 300;
-  constexpr uint32_t disconnected_after_ms = 30 * 1000;
-  constexpr uint32_t sleep_after_ms = 10 * 1000;
-
-  if (state_ == State::SLEEP || state_ == State::COOLDOWN) {
+  if (isIdle()) {
     if (!dial_.isOff()) {
       return transitionTo(State::SCANNING);
     }
@@ -59,7 +70,14 @@ void StoveSupervisor::update() {
     }
     break;
   case State::ACTIVATING:
+    // Leaving auto and coming back before activation starts an autotune.
+    if (!dial_.isBoil()) {
+      dial_left_boil_ = true;
+    } else if (dial_left_boil_) {
+      return transitionTo(State::AUTOTUNE);
+    }
     if (now - state_entry_ms_ > active_after_ms) {
+      controller_.reset();
       return transitionTo(State::ACTIVE);
     }
     break;
@@ -67,21 +85,25 @@ void StoveSupervisor::update() {
     if (now - state_entry_ms_ < stove_clear_duration_ms) {
       return;
     }
-    if (now - analyzer_.getLastUpdateMs() > disconnected_after_ms) {
+    if (now - estimator_.getLastUpdateMs() > disconnected_after_ms) {
       return transitionTo(State::DISCONNECTED);
     }
-    if (float dial_target_temp =
-            lerp(stove_config_.min_temp_c, stove_config_.max_temp_c,
-                 dial_.getPosition());
-        std::abs(dial_target_temp - dial_target_temp_) > 0.02f) {
-      controller_.setTargetTemp(dial_target_temp);
-      dial_target_temp_ = dial_target_temp;
-    }
+    updateTargetTemp();
     controller_.update();
     actuator_.setThrottle(pidToThrottle(controller_.getPower()));
     break;
+  case State::AUTOTUNE:
+    if (now - state_entry_ms_ < stove_clear_duration_ms) {
+      return;
+    }
+    if (now - estimator_.getLastUpdateMs() > disconnected_after_ms) {
+      return transitionTo(State::DISCONNECTED);
+    }
+    updateTargetTemp();
+    updateAutotune();
+    break;
   case State::DISCONNECTED:
-    if (now - analyzer_.getLastUpdateMs() < disconnected_after_ms) {
+    if (now - estimator_.getLastUpdateMs() < disconnected_after_ms) {
       return transitionTo(State::ACTIVE);
     }
     break;
@@ -93,18 +115,56 @@ void StoveSupervisor::update() {
   }
 }
 
+void StoveSupervisor::updateTargetTemp() {
+  if (float dial_target_temp =
+          lerp(stove_config_.min_temp_c, stove_config_.max_temp_c,
+               dial_.getPosition());
+      std::abs(dial_target_temp - dial_target_temp_) > 0.02f) {
+    controller_.setTargetTemp(dial_target_temp);
+    dial_target_temp_ = dial_target_temp;
+  }
+}
+
+void StoveSupervisor::updateAutotune() {
+  switch (autotuner_.update(estimator_.getEstimate(),
+                            controller_.getTargetTemp())) {
+  case RelayAutotuner::Status::kRunning:
+    actuator_.setThrottle(pidToThrottle(autotuner_.getPower()));
+    break;
+  case RelayAutotuner::Status::kDone:
+    controller_.setConfig(autotuner_.getTunedConfig(controller_.getConfig()));
+    transitionTo(State::ACTIVE);
+    beeper_.beep(Beeper::Signal::ACCEPT);
+    break;
+  case RelayAutotuner::Status::kFailed:
+    transitionTo(State::ACTIVE);
+    beeper_.beep(Beeper::Signal::ERROR);
+    break;
+  }
+}
+
+void StoveSupervisor::schedule(Scheduler &scheduler) const {
+  scheduler.requestUpdateIn(isIdle() ? idle_dial_poll_ms : dial_poll_ms);
+  if (state_ == State::COOLDOWN) {
+    scheduler.requestUpdateAt(state_entry_ms_ + sleep_after_ms + 1);
+  }
+
+  actuator_.schedule(scheduler);
+}
+
 void StoveSupervisor::transitionTo(State new_state) {
   if (state_ == new_state) {
     return;
   }
 
-  Log << "StoveSupervisor: " << getStateName(state_) << " -> "
-      << getStateName(new_state) << "\n";
+  LOG_INFO(log_, kSupervisor) << "StoveSupervisor: " << getStateName(state_)
+                              << " -> " << getStateName(new_state) << "\n";
 
   state_ = new_state;
-  state_entry_ms_ = millis();
+  state_entry_ms_ = clock_.millis();
 
-  if (state_ != State::ACTIVE && state_ != State::DISCONNECTED) {
+  if (state_ != State::ACTIVE && state_ != State::AUTOTUNE &&
+      state_ != State::DISCONNECTED) {
     actuator_.setBypass();
   }
 
@@ -124,6 +184,14 @@ void StoveSupervisor::transitionTo(State new_state) {
     has_beeped_connected_ = true;
     break;
   case State::ACTIVATING:
+    dial_left_boil_ = false;
+    break;
+  case State::AUTOTUNE:
+    actuator_.setThrottle({std::max(0.0f, dial_.getPosition() - 0.1f), 0});
+    controller_.reset();
+    autotuner_.start();
+    dial_target_temp_ = -1.0f;
+    beeper_.beep(Beeper::Signal::ACCEPT);
     break;
   case State::ACTIVE:
     actuator_.setThrottle({std::max(0.0f, dial_.getPosition() - 0.1f), 0});
@@ -140,7 +208,7 @@ void StoveSupervisor::transitionTo(State new_state) {
   }
 }
 
-const char *StoveSupervisor::getStateName(State state) const {
+const char *StoveSupervisor::getStateName(State state) {
   switch (state) {
   case State::SLEEP:
     return "SLEEP";
@@ -152,6 +220,8 @@ const char *StoveSupervisor::getStateName(State state) const {
     return "ACTIVATING";
   case State::ACTIVE:
     return "ACTIVE";
+  case State::AUTOTUNE:
+    return "AUTOTUNE";
   case State::DISCONNECTED:
     return "DISCONNECTED";
   case State::COOLDOWN:
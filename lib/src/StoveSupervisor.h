@@ -1,12 +1,15 @@
 #pragma once
 
 #include "Beeper.h"
+#include "Context.h"
+#include "RelayAutotuner.h"
+#include "Scheduler.h"
 #include "StoveActuator.h"
 #include "StoveDial.h"
 #include "StoveThrottle.h"
 #include "Thermometer.h"
 #include "ThermalController.h"
-#include "TrendAnalyzer.h"
+#include "TemperatureEstimator.h"
 
 struct StoveConfig {
   float min_temp_c = 30.0f;
@@ -16,37 +19,52 @@ struct StoveConfig {
 
 class StoveSupervisor {
 public:
-  StoveSupervisor(StoveDial &dial, StoveActuator &actuator,
-                  ThermalController &controller, Beeper &beeper,
-                  TrendAnalyzer &analyzer, Thermometer &thermometer,
-                  const StoveConfig &stove_config,
-                  const ThrottleConfig &throttle_config);
-  virtual ~StoveSupervisor() = default;
-
-  void update();
-
-private:
-  enum class State {
+  enum class State : uint8_t {
     SLEEP,      // Waiting for dial activity, BLE off
     SCANNING,   // Waiting for thermometer connection
     CONNECTED,  // Waiting for auto pos
     ACTIVATING, // Waiting for 3sec
     ACTIVE,     // PID control active
+    AUTOTUNE,   // Relay oscillation to tune the controller
     DISCONNECTED, // Signal lost
     COOLDOWN    // Waiting for 30sec
   };
 
+  StoveSupervisor(const Context &context, StoveDial &dial,
+                  StoveActuator &actuator, ThermalController &controller,
+                  Beeper &beeper, TemperatureEstimator &estimator,
+                  Thermometer &thermometer, RelayAutotuner &autotuner,
+                  const StoveConfig &stove_config,
+                  const ThrottleConfig &throttle_config);
+  virtual ~StoveSupervisor() = default;
+
+  void update();
+  // Requests the next update, sparsely while the stove is off.
+  void schedule(Scheduler &scheduler) const;
+
+  State getState() const { return state_; }
+  // Off, waiting for the dial: SLEEP or COOLDOWN.
+  bool isIdle() const {
+    return state_ == State::SLEEP || state_ == State::COOLDOWN;
+  }
+  static const char *getStateName(State state);
+
+private:
   void transitionTo(State new_state);
-  const char *getStateName(State state) const;
 
   StoveThrottle pidToThrottle(float power) const;
+  void updateTargetTemp();
+  void updateAutotune();
 
+  const Clock &clock_;
+  Logger &log_;
   StoveDial &dial_;
   StoveActuator &actuator_;
   ThermalController &controller_;
   Beeper &beeper_;
-  TrendAnalyzer &analyzer_;
+  TemperatureEstimator &estimator_;
   Thermometer &thermometer_;
+  RelayAutotuner &autotuner_;
   const StoveConfig stove_config_;
   const ThrottleConfig throttle_config_;
 
@@ -54,5 +72,6 @@ private:
   uint32_t state_entry_ms_ = 0;
   uint32_t dial_off_start_ms_ = 0;
   bool has_beeped_connected_ = false;
+  bool dial_left_boil_ = false;
   float dial_target_temp_ = -1.0f;
 };
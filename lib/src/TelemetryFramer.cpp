@@ -0,0 +1,103 @@
+#include "TelemetryFramer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+class FrameWriter {
+public:
+  explicit FrameWriter(uint8_t *frame) : frame_(frame) {}
+
+  void u8(uint8_t value) { frame_[size_++] = value; }
+  void u16(uint16_t value) {
+    u8(static_cast<uint8_t>(value));
+    u8(static_cast<uint8_t>(value >> 8));
+  }
+  void u32(uint32_t value) {
+    u16(static_cast<uint16_t>(value));
+    u16(static_cast<uint16_t>(value >> 16));
+  }
+  // `value` in units of 1 / `scale`, saturated.
+  void fixed16(float value, float scale) {
+    if (std::isnan(value)) {
+      u16(static_cast<uint16_t>(TelemetryFramer::kNoValue));
+      return;
+    }
+    float scaled = std::round(value * scale);
+    scaled = std::clamp(scaled, static_cast<float>(INT16_MIN + 1),
+                        static_cast<float>(INT16_MAX));
+    u16(static_cast<uint16_t>(static_cast<int16_t>(scaled)));
+  }
+
+  size_t getSize() const { return size_; }
+
+private:
+  uint8_t *const frame_;
+  size_t size_ = 0;
+};
+
+} // namespace
+
+void TelemetryFramer::addSample(const TelemetrySample &sample) {
+  samples_[(head_ + count_) % kMaxSamples] = sample;
+  if (count_ < kMaxSamples) {
+    ++count_;
+  } else {
+    head_ = (head_ + 1) % kMaxSamples;
+  }
+}
+
+void TelemetryFramer::clear() {
+  head_ = 0;
+  count_ = 0;
+}
+
+size_t TelemetryFramer::getCapacity(size_t frame_size) {
+  frame_size = std::min(frame_size, kMaxFrameSize);
+  return frame_size < kHeaderSize ? 0
+                                  : (frame_size - kHeaderSize) / kSampleSize;
+}
+
+bool TelemetryFramer::isFrameReady(size_t frame_size, uint32_t now_ms,
+                                   uint32_t max_age_ms) const {
+  if (count_ == 0) {
+    return false;
+  }
+  return count_ >= getCapacity(frame_size) ||
+         now_ms - samples_[head_].time_ms >= max_age_ms;
+}
+
+size_t TelemetryFramer::pack(uint8_t *frame, size_t frame_size) {
+  size_t count = std::min(count_, getCapacity(frame_size));
+  if (count == 0) {
+    return 0;
+  }
+  uint32_t time_ms = samples_[head_].time_ms;
+  // Offsets must fit 16 bits; later samples go into the next frame.
+  for (size_t i = 1; i < count; ++i) {
+    if (samples_[(head_ + i) % kMaxSamples].time_ms - time_ms > UINT16_MAX) {
+      count = i;
+      break;
+    }
+  }
+
+  FrameWriter writer(frame);
+  writer.u8(kVersion);
+  writer.u8(static_cast<uint8_t>(count));
+  writer.u16(sequence_++);
+  writer.u32(time_ms);
+  for (size_t i = 0; i < count; ++i) {
+    const TelemetrySample &sample = samples_[(head_ + i) % kMaxSamples];
+    writer.u16(static_cast<uint16_t>(sample.time_ms - time_ms));
+    writer.fixed16(sample.target_temp, 100.0f);
+    writer.fixed16(sample.temp, 100.0f);
+    writer.fixed16(sample.slope, 1000.0f * 1000.0f);
+    writer.u8(static_cast<uint8_t>(
+        std::lround(std::clamp(sample.power, 0.0f, 1.0f) * 255.0f)));
+    writer.u8(sample.state);
+    writer.u8(sample.flags);
+  }
+  head_ = (head_ + count) % kMaxSamples;
+  count_ -= count;
+  return writer.getSize();
+}
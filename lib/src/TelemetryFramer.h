@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The controller state at one moment.
+struct TelemetrySample {
+  uint32_t time_ms = 0;
+  float target_temp = 0.0f; // °C
+  float temp = 0.0f;        // °C, NaN without readings
+  float slope = 0.0f;       // °C/ms
+  float power = 0.0f;       // 0 to 1
+  uint8_t state = 0;        // StoveSupervisor::State
+  uint8_t flags = 0;        // kLidOpen, ...
+};
+
+// Collects samples and packs the oldest into frames of up to one BLE
+// notification each, so many samples share one radio event. Frame format,
+// all little-endian:
+//
+//   uint8_t  version         kVersion
+//   uint8_t  sample_count
+//   uint16_t sequence        Counts frames, to spot lost ones
+//   uint32_t time_ms         Of the first sample, since boot
+//   sample_count times:
+//     uint16_t offset_ms     From time_ms
+//     int16_t  target_temp   0.01 °C
+//     int16_t  temp          0.01 °C, kNoValue without readings
+//     int16_t  slope         0.001 °C/s
+//     uint8_t  power         0 to 255 for 0 to 1
+//     uint8_t  state
+//     uint8_t  flags
+//
+// Values out of range saturate.
+class TelemetryFramer {
+public:
+  static constexpr uint8_t kVersion = 1;
+  static constexpr size_t kHeaderSize = 8;
+  static constexpr size_t kSampleSize = 11;
+  // A notification at the largest ATT MTU a data length extended packet
+  // carries whole, 247.
+  static constexpr size_t kMaxFrameSize = 244;
+  static constexpr size_t kMaxSamples =
+      (kMaxFrameSize - kHeaderSize) / kSampleSize;
+  static constexpr int16_t kNoValue = INT16_MIN;
+
+  static constexpr uint8_t kLidOpen = 1 << 0;
+  static constexpr uint8_t kPlantIdentified = 1 << 1;
+
+  // Drops the oldest sample when full.
+  void addSample(const TelemetrySample &sample);
+  void clear();
+
+  size_t getSampleCount() const { return count_; }
+  // How many samples a frame of `frame_size` bytes holds.
+  static size_t getCapacity(size_t frame_size);
+
+  // Whether a frame of `frame_size` bytes would be full, or the oldest
+  // sample is `max_age_ms` old.
+  bool isFrameReady(size_t frame_size, uint32_t now_ms,
+                    uint32_t max_age_ms) const;
+
+  // Moves the oldest samples into a frame of at most `frame_size` bytes,
+  // returning its length, 0 when there are no samples.
+  size_t pack(uint8_t *frame, size_t frame_size);
+
+private:
+  std::array<TelemetrySample, kMaxSamples> samples_;
+  size_t head_ = 0;
+  size_t count_ = 0;
+  uint16_t sequence_ = 0;
+};
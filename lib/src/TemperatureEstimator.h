@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// Tracks the probe temperature and its rate of change from noisy readings.
+// One thread adds readings and clears; any number of threads may read
+// estimates concurrently.
+class TemperatureEstimator {
+public:
+  // The state as of the newest reading.
+  struct Estimate {
+    uint32_t last_update_ms = 0;
+    float value = 0.0f;           // At last_update_ms (°C)
+    float slope = 0.0f;           // °C/ms
+    float value_variance = 0.0f;  // °C², infinite while unknown
+    float slope_variance = 0.0f;  // (°C/ms)², infinite while unknown
+    uint32_t count = 0;           // Readings contributing, 0 if none
+
+    // A reading stamped after `time` counts as current, not as one that
+    // wrapped around.
+    float getValue(uint32_t time) const {
+      int32_t age_ms = static_cast<int32_t>(time - last_update_ms);
+      return (age_ms > 0 ? age_ms : 0) * slope + value;
+    }
+  };
+
+  virtual ~TemperatureEstimator() = default;
+
+  virtual void addReading(float value, uint32_t time_ms) = 0;
+  virtual void clear() = 0;
+
+  // A consistent snapshot. Take one per update when using several fields.
+  virtual Estimate getEstimate() const = 0;
+
+  virtual float getValue(uint32_t time) const {
+    return getEstimate().getValue(time);
+  }
+
+  virtual float getSlope() const { return getEstimate().slope; }
+
+  virtual uint32_t getLastUpdateMs() const {
+    return getEstimate().last_update_ms;
+  }
+};
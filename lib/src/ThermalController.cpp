@@ -3,11 +3,23 @@
 #include <algorithm>
 #include <cmath>
 
-extern "C" uint32_t millis();
-
-ThermalController::ThermalController(const TrendAnalyzer &analyzer,
+ThermalController::ThermalController(const Context &context,
+                                     const TemperatureEstimator &estimator,
                                      const ThermalConfig &config)
-    : analyzer_(analyzer), config_(config), target_temp_(config.ambient_temp) {}
+    : clock_(context.clock), log_(context.log), estimator_(estimator),
+      base_config_(config), config_(config), identifier_(config.ambient_temp),
+      target_temp_(config.ambient_temp) {}
+
+void ThermalController::reset() {
+  config_ = base_config_;
+  identifier_.reset();
+  last_sample_ms_ = 0;
+  lid_open_ = false;
+}
+
+bool ThermalController::isPlantIdentified() const {
+  return config_.identify_plant && identifier_.isValid();
+}
 
 float ThermalController::getTargetTemp() const {
   return target_temp_.load(std::memory_order_relaxed);
@@ -15,15 +27,17 @@ float ThermalController::getTargetTemp() const {
 
 void ThermalController::setTargetTemp(float temp) {
   if (std::abs(temp - printed_target_temp_) > 1.0f) {
-    Log << "ThermalController::setTargetTemp(" << temp << ")\n";
+    LOG_DEBUG(log_, kController)
+        << "ThermalController::setTargetTemp(" << temp << ")\n";
     printed_target_temp_ = temp;
   }
   target_temp_.store(temp, std::memory_order_relaxed);
 }
 
 void ThermalController::update() {
-  uint32_t current_time_ms = millis();
-  float slope = analyzer_.getSlope();
+  uint32_t current_time_ms = clock_.millis();
+  TemperatureEstimator::Estimate estimate = estimator_.getEstimate();
+  float slope = estimate.slope;
 
   if (slope < -config_.lid_open_threshold) {
     lid_open_ = true;
@@ -34,18 +48,47 @@ void ThermalController::update() {
     if (slope < config_.lid_open_threshold) {
       return;
     }
-    Log << "ThermalController lid closed\n";
+    LOG_INFO(log_, kController) << "ThermalController lid closed\n";
     lid_open_ = false;
   }
 
-  uint32_t future_time = current_time_ms + config_.system_lag_ms;
-  float predicted_temp = analyzer_.getValue(future_time);
+  if (estimate.count != 0 && estimate.last_update_ms != last_sample_ms_) {
+    bool was_identified = isPlantIdentified();
+    identifier_.addSample(estimate.last_update_ms, estimate.value, slope,
+                          power_);
+    last_sample_ms_ = estimate.last_update_ms;
+    if (!was_identified && isPlantIdentified()) {
+      PlantModel model = identifier_.getModel();
+      LOG_INFO(log_, kController)
+          << "ThermalController plant identified: gain " << model.gain
+          << "°C, time constant " << model.time_constant_ms / 1000
+          << "s, dead time " << model.dead_time_ms / 1000 << "s\n";
+    }
+  }
+
+  uint32_t lag_ms = config_.system_lag_ms;
+  float heat_loss_factor = config_.heat_loss_factor;
+  if (isPlantIdentified()) {
+    PlantModel model = identifier_.getModel();
+    lag_ms = model.dead_time_ms;
+    heat_loss_factor = 1.0f / model.gain;
+  }
+
+  // Look ahead only as far as the slope can be told from noise: scale by the
+  // share of its square that is signal.
+  float slope_squared = slope * slope;
+  float confidence = estimate.slope_variance > 0.0f
+                         ? slope_squared /
+                               (slope_squared + estimate.slope_variance)
+                         : 1.0f;
+  uint32_t future_time = current_time_ms + lag_ms * confidence;
+  float predicted_temp = estimate.getValue(future_time);
 
   float error = target_temp_ - predicted_temp;
   float p_out = error * config_.p_factor;
 
-  float current_temp = analyzer_.getValue(current_time_ms);
-  float loss = (current_temp - config_.ambient_temp) * config_.heat_loss_factor;
+  float current_temp = estimate.getValue(current_time_ms);
+  float loss = (current_temp - config_.ambient_temp) * heat_loss_factor;
 
   power_ = std::clamp(p_out + loss, 0.0f, 1.0f);
 }
@@ -1,5 +1,7 @@
 #pragma once
-#include "TrendAnalyzer.h"
+#include "Context.h"
+#include "PlantIdentifier.h"
+#include "TemperatureEstimator.h"
 #include <atomic>
 #include <cstdint>
 
@@ -7,15 +9,21 @@ struct ThermalConfig {
   float p_factor = 0.1f;              // P-factor (1/K)
   float heat_loss_factor = 0.01f;     // Heat loss factor (1/K)
   uint32_t system_lag_ms = 10000;     // Lookahead time (ms)
+  bool identify_plant = true;         // Replace the two above once known
   float lid_open_threshold = 0.0005f; // Threshold for lid open (°C/ms)
   float ambient_temp = 20.0f;         // Ambient temperature (°C)
 };
 
 class ThermalController {
 public:
-  ThermalController(const TrendAnalyzer &analyzer, const ThermalConfig &config);
+  ThermalController(const Context &context,
+                    const TemperatureEstimator &estimator,
+                    const ThermalConfig &config);
   virtual ~ThermalController() = default;
 
+  // Starts a session with a possibly different pot, back on the config
+  // given at construction.
+  virtual void reset();
   virtual void update();
 
   virtual float getTargetTemp() const;
@@ -23,9 +31,23 @@ public:
   virtual float getPower() const { return power_; }
   virtual bool isLidOpen() const { return lid_open_; }
 
+  virtual const ThermalConfig &getConfig() const { return config_; }
+  // Replaces the tuning until the next reset(), for instance with the
+  // result of an autotune.
+  virtual void setConfig(const ThermalConfig &config) { config_ = config; }
+
+  // The model identified in this session, if any yet.
+  virtual bool isPlantIdentified() const;
+  virtual PlantModel getPlantModel() const { return identifier_.getModel(); }
+
 private:
-  const TrendAnalyzer &analyzer_;
-  const ThermalConfig config_;
+  const Clock &clock_;
+  Logger &log_;
+  const TemperatureEstimator &estimator_;
+  const ThermalConfig base_config_;
+  ThermalConfig config_;
+  PlantIdentifier identifier_;
+  uint32_t last_sample_ms_ = 0;
 
   std::atomic<float> target_temp_;
   float printed_target_temp_ = 0.0f;
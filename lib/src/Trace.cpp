@@ -0,0 +1,103 @@
+#include "Trace.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+uint32_t toBits(float value) {
+  static_assert(sizeof(float) == sizeof(uint32_t));
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+} // namespace
+
+void TraceWriter::header(const TraceHeader &header) {
+  has_header_ = true;
+  write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+}
+
+void TraceWriter::update(uint32_t time_ms) {
+  if (!has_header_) {
+    return;
+  }
+  uint32_t delta_ms = time_ms - last_time_ms_;
+  if (has_time_ && delta_ms <= UINT16_MAX) {
+    uint16_t delta = delta_ms;
+    record(TraceTag::kTick, &delta, sizeof(delta));
+  } else {
+    record(TraceTag::kTime, &time_ms, sizeof(time_ms));
+  }
+  has_time_ = true;
+  last_time_ms_ = time_ms;
+}
+
+void TraceWriter::reading(float temp, uint32_t time_ms) {
+  record(TraceTag::kReading, &temp, sizeof(temp), &time_ms, sizeof(time_ms));
+}
+
+void TraceWriter::dial(float value) {
+  if (!has_header_ || (has_dial_ && toBits(value) == dial_bits_)) {
+    return;
+  }
+  record(TraceTag::kDial, &value, sizeof(value));
+  dial_bits_ = toBits(value);
+  has_dial_ = true;
+}
+
+void TraceWriter::connected(bool is_connected) {
+  if (!has_header_ || connected_ == is_connected) {
+    return;
+  }
+  uint8_t value = is_connected;
+  record(TraceTag::kConnected, &value, sizeof(value));
+  connected_ = is_connected;
+}
+
+void TraceWriter::target(float temp) {
+  record(TraceTag::kTarget, &temp, sizeof(temp));
+}
+
+void TraceWriter::potentiometer(float value) {
+  if (!has_header_ ||
+      (has_potentiometer_ && toBits(value) == potentiometer_bits_)) {
+    return;
+  }
+  record(TraceTag::kPotentiometer, &value, sizeof(value));
+  potentiometer_bits_ = toBits(value);
+  has_potentiometer_ = true;
+}
+
+void TraceWriter::bypass(PinState state) {
+  uint8_t value = static_cast<uint8_t>(state);
+  record(TraceTag::kBypass, &value, sizeof(value));
+}
+
+void TraceWriter::state(StoveSupervisor::State state) {
+  if (!has_header_ || state_ == static_cast<int16_t>(state)) {
+    return;
+  }
+  uint8_t value = static_cast<uint8_t>(state);
+  record(TraceTag::kState, &value, sizeof(value));
+  state_ = value;
+}
+
+void TraceWriter::record(TraceTag tag, const void *payload, size_t size) {
+  record(tag, payload, size, nullptr, 0);
+}
+
+void TraceWriter::record(TraceTag tag, const void *payload1, size_t size1,
+                         const void *payload2, size_t size2) {
+  if (!has_header_) {
+    return;
+  }
+  std::array<uint8_t, 1 + 8> data;
+  data[0] = static_cast<uint8_t>(tag);
+  std::copy_n(static_cast<const uint8_t *>(payload1), size1, &data[1]);
+  if (size2 != 0) {
+    std::copy_n(static_cast<const uint8_t *>(payload2), size2, &data[1 + size1]);
+  }
+  write(data.data(), 1 + size1 + size2);
+}
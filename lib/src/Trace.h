@@ -0,0 +1,89 @@
+#pragma once
+
+#include "DigitalWritePin.h"
+#include "KalmanEstimator.h"
+#include "RelayAutotuner.h"
+#include "StoveSupervisor.h"
+#include "StoveThrottle.h"
+#include "ThermalController.h"
+#include <cstddef>
+#include <cstdint>
+
+// A session trace records every input and output of the control stack, so
+// that tools/replay can run the session again through the same code and
+// diff the outputs.
+//
+// The stream is a TraceHeader followed by records: a TraceTag byte and a
+// little-endian payload, packed without alignment. Each update of
+// StoveSupervisor is marked by a kTick or kTime record; the records up to
+// the next mark happened during or after that update. Bump kTraceVersion
+// whenever the records or the header change.
+constexpr uint32_t kTraceMagic = 0x5443524b; // "KRCT"
+constexpr uint16_t kTraceVersion = 2;
+
+enum class TraceTag : uint8_t {
+  kTime = 1,          // uint32_t: an update at this time (ms)
+  kTick = 2,          // uint16_t: an update this many ms after the last
+  kReading = 3,       // float °C, uint32_t ms: estimator input
+  kDial = 4,          // float: dial sample, when it changed
+  kConnected = 5,     // uint8_t: thermometer connection, when it changed
+  kTarget = 6,        // float °C: target temperature written over BLE
+  kPotentiometer = 7, // float: potentiometer output, when it changed
+  kBypass = 8,        // uint8_t PinState: bypass pin output
+  kState = 9,         // uint8_t StoveSupervisor::State, when it changed
+  kLost = 10,         // uint32_t: records dropped before this one
+};
+
+// The configuration the session ran with, written as is: all members are
+// 32-bit or smaller, which gives the same layout on the device and the host.
+struct TraceHeader {
+  uint32_t magic = kTraceMagic;
+  uint16_t version = kTraceVersion;
+  uint16_t size = sizeof(TraceHeader);
+  uint32_t estimator = 0; // 0 for TrendAnalyzer, 1 for KalmanEstimator
+  KalmanConfig kalman;
+  ThermalConfig thermal;
+  StoveConfig stove;
+  ThrottleConfig throttle;
+  AutotuneConfig autotune;
+};
+
+// Encodes trace records. Records before the header are dropped, so set-up
+// outputs that a replay repeats by itself stay out of the trace.
+class TraceWriter {
+public:
+  virtual ~TraceWriter() = default;
+
+  void header(const TraceHeader &header);
+
+  // Call right before each StoveSupervisor::update.
+  void update(uint32_t time_ms);
+
+  void reading(float temp, uint32_t time_ms);
+  void dial(float value);
+  void connected(bool is_connected);
+  void target(float temp);
+  void potentiometer(float value);
+  void bypass(PinState state);
+  void state(StoveSupervisor::State state);
+
+protected:
+  // Appends one encoded record, or the header.
+  virtual void write(const uint8_t *data, size_t size) = 0;
+
+private:
+  void record(TraceTag tag, const void *payload, size_t size);
+  void record(TraceTag tag, const void *payload1, size_t size1,
+              const void *payload2, size_t size2);
+
+  bool has_header_ = false;
+  bool has_time_ = false;
+  uint32_t last_time_ms_ = 0;
+  // Last values of the fields recorded on change, as bits.
+  uint32_t dial_bits_ = 0;
+  bool has_dial_ = false;
+  int8_t connected_ = -1;
+  uint32_t potentiometer_bits_ = 0;
+  bool has_potentiometer_ = false;
+  int16_t state_ = -1;
+};
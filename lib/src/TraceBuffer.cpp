@@ -0,0 +1,42 @@
+#include "TraceBuffer.h"
+#include <algorithm>
+
+void TraceBuffer::write(const uint8_t *data, size_t size) {
+  if (lost_ != 0) {
+    std::array<uint8_t, 1 + sizeof(lost_)> lost_record;
+    lost_record[0] = static_cast<uint8_t>(TraceTag::kLost);
+    std::copy_n(reinterpret_cast<const uint8_t *>(&lost_), sizeof(lost_),
+                &lost_record[1]);
+    if (kCapacity - size_ < lost_record.size() + size) {
+      ++lost_;
+      return;
+    }
+    push(lost_record.data(), lost_record.size());
+    lost_ = 0;
+  }
+  if (!push(data, size)) {
+    ++lost_;
+  }
+}
+
+bool TraceBuffer::push(const uint8_t *data, size_t size) {
+  if (kCapacity - size_ < size) {
+    return false;
+  }
+  size_t tail = (head_ + size_) % kCapacity;
+  size_t first = std::min(size, kCapacity - tail);
+  std::copy_n(data, first, &buffer_[tail]);
+  std::copy_n(data + first, size - first, buffer_.data());
+  size_ += size;
+  return true;
+}
+
+size_t TraceBuffer::read(uint8_t *data, size_t size) {
+  size = std::min(size, size_);
+  size_t first = std::min(size, kCapacity - head_);
+  std::copy_n(&buffer_[head_], first, data);
+  std::copy_n(buffer_.data(), size - first, data + first);
+  head_ = (head_ + size) % kCapacity;
+  size_ -= size;
+  return size;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Trace.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Keeps trace records in a RAM ring buffer until read() drains them, from
+// the main loop only. A record that does not fit is dropped and counted,
+// and a kLost record tells the replay where the trace breaks off.
+class TraceBuffer final : public TraceWriter {
+public:
+  static constexpr size_t kCapacity = 8192;
+
+  // Moves up to `size` bytes of the stream to `data`. Returns the number of
+  // bytes moved.
+  size_t read(uint8_t *data, size_t size);
+
+  size_t available() const { return size_; }
+
+protected:
+  void write(const uint8_t *data, size_t size) override;
+
+private:
+  bool push(const uint8_t *data, size_t size);
+
+  uint32_t lost_ = 0;
+
+  std::array<uint8_t, kCapacity> buffer_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "AnalogReadPin.h"
+#include "DigitalWritePin.h"
+#include "Potentiometer.h"
+#include "TemperatureEstimator.h"
+#include "Thermometer.h"
+#include "Trace.h"
+
+// Decorators that record what passes through them to a trace, if one is
+// given, and otherwise only forward.
+
+class TracingDialPin final : public AnalogReadPin {
+public:
+  TracingDialPin(const AnalogReadPin &pin, TraceWriter *trace)
+      : pin_(pin), trace_(trace) {}
+
+  float read() const override {
+    float value = pin_.read();
+    if (trace_) {
+      trace_->dial(value);
+    }
+    return value;
+  }
+
+  // Reduces each block to its mean, repeated while there is no new one, so
+  // a trace holds one sample per update and replays to the same dial value.
+  size_t readBlock(float *samples, size_t size) const override {
+    if (size == 0) {
+      return 0;
+    }
+    if (size_t count = pin_.readBlock(samples, size); count > 0) {
+      last_mean_ = averageBlock(samples, count);
+    }
+    samples[0] = last_mean_;
+    if (trace_) {
+      trace_->dial(last_mean_);
+    }
+    return 1;
+  }
+
+private:
+  const AnalogReadPin &pin_;
+  TraceWriter *const trace_;
+  mutable float last_mean_ = 0.0f;
+};
+
+class TracingThermometer final : public Thermometer {
+public:
+  TracingThermometer(Thermometer &thermometer, TraceWriter *trace)
+      : thermometer_(thermometer), trace_(trace) {}
+
+  void start() override { thermometer_.start(); }
+  void stop() override { thermometer_.stop(); }
+  bool connected() override {
+    bool is_connected = thermometer_.connected();
+    if (trace_) {
+      trace_->connected(is_connected);
+    }
+    return is_connected;
+  }
+
+private:
+  Thermometer &thermometer_;
+  TraceWriter *const trace_;
+};
+
+class TracingEstimator final : public TemperatureEstimator {
+public:
+  TracingEstimator(TemperatureEstimator &estimator, TraceWriter *trace)
+      : estimator_(estimator), trace_(trace) {}
+
+  void addReading(float value, uint32_t time_ms) override {
+    if (trace_) {
+      trace_->reading(value, time_ms);
+    }
+    estimator_.addReading(value, time_ms);
+  }
+  void clear() override { estimator_.clear(); }
+  Estimate getEstimate() const override { return estimator_.getEstimate(); }
+
+private:
+  TemperatureEstimator &estimator_;
+  TraceWriter *const trace_;
+};
+
+class TracingPotentiometer final : public Potentiometer {
+public:
+  TracingPotentiometer(Potentiometer &potentiometer, TraceWriter *trace)
+      : potentiometer_(potentiometer), trace_(trace) {}
+
+  void setValue(float value) override {
+    if (trace_) {
+      trace_->potentiometer(value);
+    }
+    potentiometer_.setValue(value);
+  }
+
+private:
+  Potentiometer &potentiometer_;
+  TraceWriter *const trace_;
+};
+
+class TracingBypassPin final : public DigitalWritePin {
+public:
+  TracingBypassPin(const DigitalWritePin &pin, TraceWriter *trace)
+      : pin_(pin), trace_(trace) {}
+
+  void set(PinState state) const override {
+    if (trace_) {
+      trace_->bypass(state);
+    }
+    pin_.set(state);
+  }
+
+private:
+  const DigitalWritePin &pin_;
+  TraceWriter *const trace_;
+};
@@ -2,77 +2,119 @@
 #include "Logger.h"
 #include "sfloat.h"
 #include <algorithm>
-#include <atomic>
 #include <cmath>
 #include <limits>
 
+TrendAnalyzer::TrendAnalyzer(const Context &context) : log_(context.log) {}
+
 void TrendAnalyzer::addReading(float value, uint32_t time_ms) {
-  Log << "TrendAnalyzer::addReading(/*value=*/" << value << ", /*time_ms=*/"
-      << time_ms << ")\n";
+  LOG_DEBUG(log_, kAnalyzer) << "TrendAnalyzer::addReading(/*value=*/" << value
+                             << ", /*time_ms=*/" << time_ms << ")\n";
 
   Reading reading = {value, time_ms};
-  auto begin = history_.begin();
-  auto end = begin + count_.load(std::memory_order_relaxed);
-  auto comp = [](const Reading &a, const Reading &b) {
-    return static_cast<int32_t>(a.time_ms - b.time_ms) > 0;
-  };
-  auto it = std::upper_bound(begin, end, reading, comp);
-
-  if (end < history_.end()) {
-    ++end;
-    count_.fetch_add(1, std::memory_order_relaxed);
+  size_t count = count_;
+
+  // Readings usually arrive in order, so this rarely iterates.
+  size_t index = count;
+  while (index > 0 &&
+         static_cast<int32_t>(at(index - 1).time_ms - time_ms) >= 0) {
+    --index;
   }
 
-  if (it == end) {
-    return;
+  if (count == history_.size()) {
+    if (index == 0) {
+      return;
+    }
+    removeFromSums(at(0), count--);
+    head_ = (head_ + 1) % history_.size();
+    --index;
   }
 
-  std::move_backward(it, end - 1, end);
-  *it = reading;
+  if (index == count) {
+    // Move the origin to the newest reading, which only shifts the mean.
+    mean_x_ -= static_cast<int32_t>(time_ms - origin_ms_);
+    origin_ms_ = time_ms;
+  }
 
-  const int next_idx =
-      1 - current_result_index_.load(std::memory_order_relaxed);
-  results_[next_idx] = calculateRegression(end - begin);
-  current_result_index_.store(next_idx, std::memory_order_release);
+  for (size_t i = count; i > index; --i) {
+    at(i) = at(i - 1);
+  }
+  at(index) = reading;
+  addToSums(reading, count++);
+  count_ = count;
+
+  estimate_.store(calculateRegression(count));
 }
 
 void TrendAnalyzer::clear() {
-  if (count_.exchange(0, std::memory_order_relaxed) == 0) {
+  if (count_ == 0) {
     return;
   }
-  Log << "TrendAnalyzer::clear()\n";
-  results_[current_result_index_.load(std::memory_order_acquire)] = {};
+  LOG_DEBUG(log_, kAnalyzer) << "TrendAnalyzer::clear()\n";
+  count_ = 0;
+  estimate_.store({});
 }
 
-TrendAnalyzer::AnalysisResult
-TrendAnalyzer::calculateRegression(size_t count) const {
-  uint32_t last_update_ms = history_[0].time_ms;
-
-  if (count < 2 || last_update_ms == history_[count - 1].time_ms) {
-    return {last_update_ms, history_[0].value, 0.0f};
+void TrendAnalyzer::addToSums(const Reading &reading, size_t count) {
+  if (count == 0) {
+    mean_x_ = mean_y_ = sum_xx_ = sum_xy_ = sum_yy_ = 0.0;
   }
 
-  float sum_x = 0.0f;
-  float sum_y = 0.0f;
-  float sum_xy = 0.0f;
-  float sum_xx = 0.0f;
+  double x = static_cast<int32_t>(reading.time_ms - origin_ms_);
+  double n = count + 1;
+  double dx = x - mean_x_;
+  double dy = reading.value - mean_y_;
+  mean_x_ += dx / n;
+  mean_y_ += dy / n;
+  sum_xx_ += dx * (x - mean_x_);
+  sum_xy_ += dx * (reading.value - mean_y_);
+  sum_yy_ += dy * (reading.value - mean_y_);
+}
 
-  for (size_t i = 0; i < count; ++i) {
-    float x = static_cast<int32_t>(history_[i].time_ms - last_update_ms);
-    float y = history_[i].value;
+void TrendAnalyzer::removeFromSums(const Reading &reading, size_t count) {
+  if (count <= 1) {
+    mean_x_ = mean_y_ = sum_xx_ = sum_xy_ = sum_yy_ = 0.0;
+    return;
+  }
 
-    sum_x += x;
-    sum_y += y;
-    sum_xy += x * y;
-    sum_xx += x * x;
+  double x = static_cast<int32_t>(reading.time_ms - origin_ms_);
+  double n = count - 1;
+  double dx = x - mean_x_;
+  double dy = reading.value - mean_y_;
+  mean_x_ -= dx / n;
+  mean_y_ -= dy / n;
+  sum_xx_ -= dx * (x - mean_x_);
+  sum_xy_ -= dx * (reading.value - mean_y_);
+  sum_yy_ -= dy * (reading.value - mean_y_);
+}
+
+TrendAnalyzer::Estimate
+TrendAnalyzer::calculateRegression(size_t count) const {
+  constexpr float kUnknown = std::numeric_limits<float>::infinity();
+  uint32_t n = count;
+  // Distinct integer timestamps give sum_xx_ >= 0.5, so anything below is
+  // all readings at the same time plus rounding.
+  if (count < 2 || sum_xx_ < 0.25) {
+    return {origin_ms_, static_cast<float>(mean_y_), 0.0f, kUnknown, kUnknown,
+            n};
   }
 
-  float denominator = count * sum_xx - sum_x * sum_x;
-  if (std::abs(denominator) < std::numeric_limits<float>::epsilon()) {
-    return {last_update_ms, sum_y / count, 0.0f};
+  double slope = sum_xy_ / sum_xx_;
+  double intercept = mean_y_ - slope * mean_x_;
+  if (count < 3) {
+    return {origin_ms_, static_cast<float>(intercept),
+            static_cast<float>(slope), kUnknown, kUnknown, n};
   }
 
-  float slope = (count * sum_xy - sum_x * sum_y) / denominator;
-  float intercept = (sum_y - slope * sum_x) / count;
-  return {last_update_ms, intercept, slope};
+  // Residual variance, and the variances of the fit at the newest reading,
+  // where x = 0.
+  double residual = std::max(sum_yy_ - slope * sum_xy_, 0.0) / (count - 2);
+  double slope_variance = residual / sum_xx_;
+  double value_variance = residual / count + mean_x_ * mean_x_ * slope_variance;
+  return {origin_ms_,
+          static_cast<float>(intercept),
+          static_cast<float>(slope),
+          static_cast<float>(value_variance),
+          static_cast<float>(slope_variance),
+          n};
 }
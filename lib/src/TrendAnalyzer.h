@@ -1,50 +1,57 @@
 #pragma once
 
+#include "Context.h"
+#include "SeqLock.h"
+#include "TemperatureEstimator.h"
 #include <array>
-#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
-// Thread-safe for one writer and multiple readers.
-class TrendAnalyzer {
+// Fits a line to the most recent readings by least squares. The variances
+// follow from the residuals, so they need at least three readings.
+class TrendAnalyzer : public TemperatureEstimator {
   struct Reading {
     float value;
     uint32_t time_ms;
   };
 
-  struct AnalysisResult {
-    uint32_t last_update_ms = 0;
-    float intercept = 0.0f;
-    float slope = 0.0f;
-  };
-
 public:
-  virtual ~TrendAnalyzer() = default;
-
-  virtual void addReading(float value, uint32_t time_ms);
-  virtual void clear();
-
-  virtual float getValue(uint32_t time) const {
-    const auto &result = getAnalysisResult();
-    return (time - result.last_update_ms) * result.slope + result.intercept;
-  }
+  // Number of most recent readings the regression is fitted to. Updates cost
+  // the same for any window size.
+  static constexpr size_t kWindowSize = 15;
 
-  virtual float getSlope() const { return getAnalysisResult().slope; }
+  explicit TrendAnalyzer(const Context &context);
 
-  virtual uint32_t getLastUpdateMs() const {
-    return getAnalysisResult().last_update_ms;
-  }
+  void addReading(float value, uint32_t time_ms) override;
+  void clear() override;
+  Estimate getEstimate() const override { return estimate_.load(); }
 
 private:
-  const AnalysisResult &getAnalysisResult() const {
-    return results_[current_result_index_.load(std::memory_order_acquire)];
+  // Reading at position `index` of the window, oldest first.
+  Reading &at(size_t index) {
+    return history_[(head_ + index) % history_.size()];
   }
 
-  AnalysisResult calculateRegression(size_t count) const;
+  void addToSums(const Reading &reading, size_t count);
+  void removeFromSums(const Reading &reading, size_t count);
+  Estimate calculateRegression(size_t count) const;
+
+  Logger &log_;
+
+  // Ring buffer sorted by time, the oldest reading at head_.
+  std::array<Reading, kWindowSize> history_;
+  size_t head_ = 0;
+  size_t count_ = 0;
 
-  std::array<Reading, 15> history_;
-  std::atomic<size_t> count_ = 0;
+  // Running sums over the window, centered on the means (Welford). Times are
+  // relative to origin_ms_, the newest reading, to keep them small. Double,
+  // as float rounding lets the means drift over a long session of sliding.
+  uint32_t origin_ms_ = 0;
+  double mean_x_ = 0.0;
+  double mean_y_ = 0.0;
+  double sum_xx_ = 0.0; // sum of (x - mean_x)^2
+  double sum_xy_ = 0.0; // sum of (x - mean_x) * (y - mean_y)
+  double sum_yy_ = 0.0; // sum of (y - mean_y)^2
 
-  std::array<AnalysisResult, 2> results_;
-  std::atomic<int> current_result_index_{0};
+  SeqLock<Estimate> estimate_;
 };
@@ -0,0 +1,27 @@
+#include "Zone.h"
+
+Zone::Zone(const Context &context, const ZoneDevices &devices,
+           const ZoneConfig &config)
+    : clock_(context.clock), trace_(devices.trace),
+      actuator_(context, devices.potentiometer, devices.bypass_pin,
+                config.throttle),
+      dial_(context, devices.dial_pin, config.throttle),
+      beeper_(context, devices.buzzer), analyzer_(context),
+      traced_analyzer_(analyzer_, devices.trace),
+      fusion_(context, traced_analyzer_, config.fusion), probes_(fusion_),
+      controller_(context, analyzer_, config.thermal),
+      autotuner_(context, config.autotune),
+      supervisor_(context, dial_, actuator_, controller_, beeper_, analyzer_,
+                  devices.thermometer, autotuner_, config.stove,
+                  config.throttle) {}
+
+void Zone::update() {
+  probes_.has_input = false;
+  if (trace_) {
+    trace_->update(clock_.millis());
+  }
+  supervisor_.update();
+  if (trace_) {
+    trace_->state(supervisor_.getState());
+  }
+}
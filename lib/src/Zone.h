@@ -0,0 +1,107 @@
+#pragma once
+
+#include "AnalogReadPin.h"
+#include "Beeper.h"
+#include "Buzzer.h"
+#include "Context.h"
+#include "DigitalWritePin.h"
+#include "Potentiometer.h"
+#include "ProbeFusion.h"
+#include "RelayAutotuner.h"
+#include "Scheduler.h"
+#include "StoveActuator.h"
+#include "StoveDial.h"
+#include "StoveSupervisor.h"
+#include "ThermalController.h"
+#include "Thermometer.h"
+#include "Trace.h"
+#include "TracingDevices.h"
+#include "TrendAnalyzer.h"
+
+// The devices of one burner. Zones may share the buzzer, and share the
+// thermometer through a ProbeRouter. Tracing decorators go in as devices;
+// `trace`, if given, gets the zone's updates and readings as well.
+struct ZoneDevices {
+  const AnalogReadPin &dial_pin;
+  Potentiometer &potentiometer;
+  DigitalWritePin &bypass_pin;
+  Buzzer &buzzer;
+  Thermometer &thermometer;
+  TraceWriter *trace = nullptr;
+};
+
+struct ZoneConfig {
+  ThrottleConfig throttle;
+  StoveConfig stove;
+  ThermalConfig thermal;
+  AutotuneConfig autotune;
+  FusionConfig fusion;
+};
+
+// The control stack of one burner: its probes' readings go through its own
+// ProbeFusion to its TrendAnalyzer, which its ThermalController and
+// StoveSupervisor use. The firmware runs one.
+class Zone {
+public:
+  Zone(const Context &context, const ZoneDevices &devices,
+       const ZoneConfig &config);
+
+  Zone(const Zone &) = delete;
+  Zone &operator=(const Zone &) = delete;
+
+  // After the devices' begin(): bypasses the burner until the dial is on.
+  void begin() { actuator_.setBypass(); }
+  void update();
+  void schedule(Scheduler &scheduler) const { supervisor_.schedule(scheduler); }
+
+  // Where its probes' readings go.
+  ProbeSink &getProbes() { return probes_; }
+  // A probe joined, left or sent a reading since the last update.
+  bool hasInput() const { return probes_.has_input; }
+
+  StoveActuator &getActuator() { return actuator_; }
+  ThermalController &getController() { return controller_; }
+  const StoveDial &getDial() const { return dial_; }
+  const TrendAnalyzer &getAnalyzer() const { return analyzer_; }
+  const ThermalController &getController() const { return controller_; }
+  const StoveSupervisor &getSupervisor() const { return supervisor_; }
+
+private:
+  // Passes the probes on to the fusion, noting that there is input.
+  class InputSink final : public ProbeSink {
+  public:
+    explicit InputSink(ProbeSink &sink) : sink_(sink) {}
+
+    void addProbe(size_t probe, const PeerAddress &address) override {
+      has_input = true;
+      sink_.addProbe(probe, address);
+    }
+    void addReading(size_t probe, float value, uint32_t time_ms) override {
+      has_input = true;
+      sink_.addReading(probe, value, time_ms);
+    }
+    void removeProbe(size_t probe) override {
+      has_input = true;
+      sink_.removeProbe(probe);
+    }
+
+    bool has_input = false;
+
+  private:
+    ProbeSink &sink_;
+  };
+
+  const Clock &clock_;
+  TraceWriter *const trace_;
+
+  StoveActuator actuator_;
+  StoveDial dial_;
+  Beeper beeper_;
+  TrendAnalyzer analyzer_;
+  TracingEstimator traced_analyzer_;
+  ProbeFusion fusion_;
+  InputSink probes_;
+  ThermalController controller_;
+  RelayAutotuner autotuner_;
+  StoveSupervisor supervisor_;
+};
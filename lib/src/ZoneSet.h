@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Clock.h"
+#include "Scheduler.h"
+#include "Zone.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Runs N zones from one main loop. When each zone is next due is kept in
+// one array apart from the zones, so an iteration reads N words and N input
+// flags, and only updates the zones that are due or have new input, instead
+// of walking every zone's modules. A zone off polls its dial every 100 ms,
+// so zones off cost next to nothing in the iterations of a zone cooking.
+template <size_t N> class ZoneSet {
+public:
+  ZoneSet(const Clock &clock, uint32_t max_sleep_ms,
+          const std::array<Zone *, N> &zones)
+      : clock_(clock), max_sleep_ms_(max_sleep_ms), zones_(zones) {
+    due_ms_.fill(clock.millis());
+  }
+
+  // Updates the zones that are due or have new input, and returns how many.
+  size_t update() {
+    uint32_t now = clock_.millis();
+    size_t updated = 0;
+    for (size_t i = 0; i < N; ++i) {
+      Zone &zone = *zones_[i];
+      if (static_cast<int32_t>(now - due_ms_[i]) < 0 && !zone.hasInput()) {
+        continue;
+      }
+      zone.update();
+      Scheduler scheduler(clock_, max_sleep_ms_);
+      scheduler.begin();
+      zone.schedule(scheduler);
+      due_ms_[i] = now + scheduler.getSleepMs();
+      ++updated;
+    }
+    return updated;
+  }
+
+  void schedule(Scheduler &scheduler) const {
+    for (uint32_t due_ms : due_ms_) {
+      scheduler.requestUpdateAt(due_ms);
+    }
+  }
+
+  Zone &getZone(size_t index) { return *zones_[index]; }
+  uint32_t getDueMs(size_t index) const { return due_ms_[index]; }
+
+private:
+  const Clock &clock_;
+  const uint32_t max_sleep_ms_;
+  const std::array<Zone *, N> zones_;
+  std::array<uint32_t, N> due_ms_;
+};
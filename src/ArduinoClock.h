@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Clock.h"
+#include <Arduino.h>
+
+class ArduinoClock final : public Clock {
+public:
+  uint32_t millis() const override { return ::millis(); }
+};
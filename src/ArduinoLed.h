@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Led.h"
+#include "PwmSequencer.h"
+#include <Arduino.h>
+
+// An LED that lights when its pin is low, like the ones on the XIAO, with
+// patterns played by a PWM instance of its own. PWM0 to PWM2 belong to
+// analogWrite() and PWM3 to the buzzer, so it needs one of those freed.
+class ArduinoLed final : public Led {
+public:
+  ArduinoLed(NRF_PWM_Type *pwm, int pin) : sequencer_(pwm), pin_(pin) {}
+
+  void begin() {
+    pinMode(pin_, OUTPUT);
+    digitalWrite(pin_, HIGH);
+  }
+
+  void play(const Pattern &brightness) override {
+    size_t count = compileBrightness(brightness, sequencer_.getBuffer(),
+                                     PwmSequencer::kMaxEntries);
+    if (count == 0) {
+      stop();
+      return;
+    }
+    sequencer_.connect(pin_);
+    sequencer_.play(count, brightness.repeat);
+  }
+
+  void stop() override {
+    sequencer_.disconnect();
+    digitalWrite(pin_, HIGH);
+  }
+
+private:
+  PwmSequencer sequencer_;
+  const int pin_;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Suspends the loop task until a timeout or until another task wakes it.
+// FreeRTOS idles the CPU meanwhile, with the tick suppressed.
+class ArduinoSleeper final {
+public:
+  void begin() { task_ = xTaskGetCurrentTaskHandle(); }
+
+  void sleep(uint32_t duration_ms) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(duration_ms));
+  }
+
+  // Safe to call from other tasks, e.g. BLE callbacks.
+  void wake() {
+    if (task_) {
+      xTaskNotifyGive(task_);
+    }
+  }
+
+private:
+  TaskHandle_t task_ = nullptr;
+};
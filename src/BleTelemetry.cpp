@@ -1,30 +1,61 @@
 #include "BleTelemetry.h"
 #include "Logger.h"
+#include "Profiler.h"
 #include "sfloat.h"
 #include <Arduino.h>
+#include <cmath>
+
+// 8f1c0001-5b7e-4e8a-9d3a-6c0e1a2b3c4d, 8f1c0002-... and 8f1c0003-...,
+// little-endian.
+static const uint8_t kVendorServiceUuid[16] = {
+    0x4d, 0x3c, 0x2b, 0x1a, 0x0e, 0x6c, 0x3a, 0x9d,
+    0x8a, 0x4e, 0x7e, 0x5b, 0x01, 0x00, 0x1c, 0x8f};
+static const uint8_t kLoopTimingUuid[16] = {
+    0x4d, 0x3c, 0x2b, 0x1a, 0x0e, 0x6c, 0x3a, 0x9d,
+    0x8a, 0x4e, 0x7e, 0x5b, 0x02, 0x00, 0x1c, 0x8f};
+static const uint8_t kFramesUuid[16] = {
+    0x4d, 0x3c, 0x2b, 0x1a, 0x0e, 0x6c, 0x3a, 0x9d,
+    0x8a, 0x4e, 0x7e, 0x5b, 0x03, 0x00, 0x1c, 0x8f};
+
+static constexpr uint32_t kSampleIntervalMs = 100;
+// A frame goes out when full, or once its oldest sample is this old.
+static constexpr uint32_t kMaxFrameAgeMs = 2000;
+static constexpr uint16_t kMaxMtu = TelemetryFramer::kMaxFrameSize + 3;
+static constexpr uint16_t kDefaultMtu = 23;
 
 static void connectCallback(uint16_t conn_handle) {
   BLEConnection *conn = Bluefruit.Connection(conn_handle);
   if (!conn) {
-    Log << "Failed to get connection\n";
+    LOG_WARNING(Log, kBle) << "Failed to get connection\n";
     return;
   }
 
   std::array<char, 32> name = {};
   conn->getPeerName(name.data(), name.size() - 1);
-  Log << "BleTelemetry::connectCallback(" << name.data() << ")\n";
+  LOG_INFO(Log, kBle) << "BleTelemetry::connectCallback(" << name.data()
+                      << ")\n";
+
+  // Whole telemetry frames in one packet, where the central agrees.
+  conn->requestDataLengthUpdate();
+  conn->requestMtuExchange(kMaxMtu);
 }
 
 static void disconnectCallback(uint16_t conn_handle, uint8_t reason) {
-  Log << "BleTelemetry::disconnectCallback(/*handle=*/" << conn_handle
-      << ", /*reason=*/" << reason << ")\n";
+  LOG_INFO(Log, kBle) << "BleTelemetry::disconnectCallback(/*handle=*/"
+                      << conn_handle << ", /*reason=*/" << reason << ")\n";
 }
 
 BleTelemetry::BleTelemetry(BLEUart &blueuart,
                            ThermalController &thermal_controller,
-                           const TrendAnalyzer &trend_analyzer)
+                           const TemperatureEstimator &estimator,
+                           const StoveSupervisor &supervisor,
+                           ArduinoSleeper &sleeper,
+                           const LoopMonitor &loop_monitor, TraceWriter *trace)
     : bleuart_(blueuart), thermal_controller_(thermal_controller),
-      trend_analyzer_(trend_analyzer) {}
+      estimator_(estimator), supervisor_(supervisor), sleeper_(sleeper),
+      loop_monitor_(loop_monitor), trace_(trace),
+      vendor_service_(kVendorServiceUuid), loop_timing_(kLoopTimingUuid),
+      frames_(kFramesUuid) {}
 
 void BleTelemetry::begin() {
   Bluefruit.Periph.setConnectCallback(connectCallback);
@@ -46,6 +77,17 @@ void BleTelemetry::begin() {
   current_temp_.setFixedLen(5); // 1 byte flags + 4 bytes float
   current_temp_.begin();
 
+  vendor_service_.begin();
+  loop_timing_.setProperties(CHR_PROPS_READ);
+  loop_timing_.setPermission(SECMODE_OPEN, SECMODE_NO_ACCESS);
+  loop_timing_.setFixedLen(LoopMonitor::kEncodedSize);
+  loop_timing_.begin();
+
+  frames_.setProperties(CHR_PROPS_NOTIFY);
+  frames_.setPermission(SECMODE_OPEN, SECMODE_NO_ACCESS);
+  frames_.setMaxLen(TelemetryFramer::kMaxFrameSize);
+  frames_.begin();
+
   Bluefruit.ScanResponse.addName();
 
   Bluefruit.Advertising.addFlags(BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE);
@@ -60,6 +102,12 @@ void BleTelemetry::begin() {
 }
 
 void BleTelemetry::update() {
+  for (float temp; target_temps_.pop(temp);) {
+    if (trace_) {
+      trace_->target(temp);
+    }
+    thermal_controller_.setTargetTemp(temp);
+  }
 
   if (!Bluefruit.connected()) {
     return;
@@ -67,6 +115,21 @@ void BleTelemetry::update() {
 
   bleuart_.flushTXD();
 
+  is_sampling_ = frames_.notifyEnabled();
+  if (is_sampling_) {
+    uint32_t now = millis();
+    if (now - last_sample_ms_ >= kSampleIntervalMs) {
+      addSample(now);
+      // On the 100 ms grid, unless the loop slept through a sample.
+      last_sample_ms_ = now - last_sample_ms_ < 2 * kSampleIntervalMs
+                            ? last_sample_ms_ + kSampleIntervalMs
+                            : now;
+    }
+    sendFrames(now);
+  } else {
+    framer_.clear();
+  }
+
   if (millis() - last_update_ < 1000) {
     return;
   }
@@ -75,20 +138,68 @@ void BleTelemetry::update() {
   auto controller_temp = encodeIEEE11073(thermal_controller_.getTargetTemp());
   target_temp_.notify(controller_temp.data(), controller_temp.size());
 
-  if (trend_analyzer_.getLastUpdateMs() != 0) {
-    auto trend_temp = encodeIEEE11073(trend_analyzer_.getValue(millis()));
+  if (auto estimate = estimator_.getEstimate(); estimate.count != 0) {
+    auto trend_temp = encodeIEEE11073(estimate.getValue(millis()));
     current_temp_.notify(trend_temp.data(), trend_temp.size());
   }
+
+  auto loop_timing = loop_monitor_.encode();
+  loop_timing_.write(loop_timing.data(), loop_timing.size());
+}
+
+void BleTelemetry::schedule(Scheduler &scheduler) const {
+  if (Bluefruit.connected()) {
+    scheduler.requestUpdateAt(last_update_ + 1000);
+    if (is_sampling_) {
+      scheduler.requestUpdateAt(last_sample_ms_ + kSampleIntervalMs);
+    }
+  }
+}
+
+void BleTelemetry::addSample(uint32_t now) {
+  TelemetrySample sample;
+  sample.time_ms = now;
+  sample.target_temp = thermal_controller_.getTargetTemp();
+  if (auto estimate = estimator_.getEstimate(); estimate.count != 0) {
+    sample.temp = estimate.getValue(now);
+    sample.slope = estimate.slope;
+  } else {
+    sample.temp = NAN;
+  }
+  sample.power = thermal_controller_.getPower();
+  sample.state = static_cast<uint8_t>(supervisor_.getState());
+  if (thermal_controller_.isLidOpen()) {
+    sample.flags |= TelemetryFramer::kLidOpen;
+  }
+  if (thermal_controller_.isPlantIdentified()) {
+    sample.flags |= TelemetryFramer::kPlantIdentified;
+  }
+  framer_.addSample(sample);
+}
+
+void BleTelemetry::sendFrames(uint32_t now) {
+  BLEConnection *conn = Bluefruit.Connection(Bluefruit.connHandle());
+  uint16_t mtu = conn ? conn->getMtu() : kDefaultMtu;
+  size_t frame_size = mtu - 3; // ATT notification header
+  std::array<uint8_t, TelemetryFramer::kMaxFrameSize> frame;
+  while (framer_.isFrameReady(frame_size, now, kMaxFrameAgeMs)) {
+    size_t size = framer_.pack(frame.data(), frame_size);
+    // Out of transmit buffers: the samples are lost, the sequence tells.
+    if (!frames_.notify(frame.data(), size)) {
+      break;
+    }
+  }
 }
 
 void BleTelemetry::tempMeasurementWrittenCallback(uint16_t conn_hdl,
                                                   BLECharacteristic *chr,
                                                   uint8_t *data, uint16_t len) {
+  PROFILE_SCOPE("BleTelemetry::tempMeasurementWrittenCallback");
   if (len < 5) {
     return; // Flags (1) + Float (4) minimum
   }
 
-  float temp = decodeIEEE11073(data, len);
-  static_cast<TempMeasurement *>(chr)
-      ->telemetry->thermal_controller_.setTargetTemp(temp);
+  BleTelemetry *telemetry = static_cast<TempMeasurement *>(chr)->telemetry;
+  telemetry->target_temps_.push(decodeIEEE11073(data, len));
+  telemetry->sleeper_.wake();
 }
@@ -1,8 +1,15 @@
 #ifndef BLETELEMETRY_H_
 #define BLETELEMETRY_H_
 
+#include "ArduinoSleeper.h"
+#include "LoopMonitor.h"
+#include "Scheduler.h"
+#include "SpscQueue.h"
+#include "StoveSupervisor.h"
+#include "TelemetryFramer.h"
 #include "ThermalController.h"
-#include "TrendAnalyzer.h"
+#include "Trace.h"
+#include "TemperatureEstimator.h"
 #include <bluefruit.h>
 
 class BleTelemetry final {
@@ -17,22 +24,44 @@ class BleTelemetry final {
 
 public:
   BleTelemetry(BLEUart &bleuart, ThermalController &thermalController,
-               const TrendAnalyzer &trendAnalyzer);
+               const TemperatureEstimator &estimator,
+               const StoveSupervisor &supervisor, ArduinoSleeper &sleeper,
+               const LoopMonitor &loop_monitor, TraceWriter *trace = nullptr);
   void begin();
   void update();
+  void schedule(Scheduler &scheduler) const;
 
 private:
   static void tempMeasurementWrittenCallback(uint16_t conn_hdl, BLECharacteristic *chr,
                                       uint8_t *data, uint16_t len);
+  void addSample(uint32_t now);
+  void sendFrames(uint32_t now);
 
   BLEUart &bleuart_;
   ThermalController &thermal_controller_;
-  const TrendAnalyzer &trend_analyzer_;
+  const TemperatureEstimator &estimator_;
+  const StoveSupervisor &supervisor_;
+  ArduinoSleeper &sleeper_;
+  const LoopMonitor &loop_monitor_;
+  TraceWriter *const trace_;
+
+  // Target temperatures from the BLE callback task to the loop.
+  SpscQueue<float, 4> target_temps_;
 
   BLEService service_ = {UUID16_SVC_HEALTH_THERMOMETER};
   TempMeasurement target_temp_ = {this};
   BLECharacteristic current_temp_ = {UUID16_CHR_INTERMEDIATE_TEMPERATURE};
 
+  // Vendor service with the LoopMonitor statistics, see LoopMonitor::encode,
+  // and the controller state at 10 Hz, see TelemetryFramer.
+  BLEService vendor_service_;
+  BLECharacteristic loop_timing_;
+  BLECharacteristic frames_;
+
+  TelemetryFramer framer_;
+  // Whether a central subscribed to the frames.
+  bool is_sampling_ = false;
+  uint32_t last_sample_ms_ = 0;
   uint32_t last_update_ = 0;
 };
 
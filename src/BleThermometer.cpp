@@ -1,5 +1,6 @@
 #include "BleThermometer.h"
 #include "Logger.h"
+#include "Profiler.h"
 #include "sfloat.h"
 #include <Arduino.h>
 #include <algorithm>
@@ -21,16 +22,24 @@ struct DeniedClient {
 static std::array<DeniedClient, 16> sDenyList;
 static size_t sDenyListCount = 0;
 
-static void logAddress(const uint8_t *addr) {
+namespace {
+struct BleAddress {
+  const uint8_t *addr;
+};
+} // namespace
+
+static Logger &operator<<(Logger &logger, BleAddress address) {
+  const uint8_t *addr = address.addr;
   for (const uint8_t *it = addr + BLE_GAP_ADDR_LEN; it-- > addr;) {
     char hex[3] = {};
     hex[0] = "0123456789ABCDEF"[*it >> 4];
     hex[1] = "0123456789ABCDEF"[*it & 0x0F];
-    Log << hex;
+    logger << hex;
     if (it != addr) {
-      Log << ":";
+      logger << ":";
     }
   }
+  return logger;
 }
 
 static void addDeniedClient(const uint8_t *address, uint32_t timeout_ms) {
@@ -66,9 +75,14 @@ static void trimDenyList() {
   sDenyListCount = std::distance(begin, end);
 }
 
-BleThermometer::BleThermometer(TrendAnalyzer &analyzer) : analyzer_(analyzer) {
+BleThermometer::BleThermometer(const Context &context, ProbeSink &probes,
+                               ArduinoSleeper &sleeper)
+    : sleeper_(sleeper), feed_(context, probes) {
   assert(sBleThermometer == nullptr && "Too many BleThermometers");
   sBleThermometer = this;
+  for (std::atomic<uint16_t> &conn_handle : probe_conn_handles_) {
+    conn_handle = BLE_CONN_HANDLE_INVALID;
+  }
 }
 
 BleThermometer::~BleThermometer() {
@@ -77,55 +91,149 @@ BleThermometer::~BleThermometer() {
   }
 }
 
-static void globalDisconnectCallback(uint16_t conn_handle, uint8_t reason) {
-  Log << "globalDisconnectCallback(/*handle=*/" << conn_handle
-      << ", /*reason=*/" << reason << ")\n";
+// Scanner and connection times are in units of 0.625 ms.
+static uint16_t toBleUnits(uint16_t duration_ms) {
+  return static_cast<uint16_t>(duration_ms * 8 / 5);
 }
 
 void BleThermometer::begin() {
-  Log << "BleThermometer::begin()\n";
+  LOG_DEBUG(Log, kBle) << "BleThermometer::begin()\n";
 
   Bluefruit.Central.setConnectCallback(globalConnectCallback);
   Bluefruit.Central.setDisconnectCallback(globalDisconnectCallback);
 
-  service_.begin();
-  char_.setNotifyCallback(globalNotifyCallback);
-  char_.begin(&service_);
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    Link &link = links_[i];
+    link.service.begin();
+    link.chr.client = this;
+    link.chr.probe = i;
+    link.chr.setNotifyCallback(globalNotifyCallback);
+    link.chr.begin(&link.service);
+  }
 
+  // ScanPolicy sets the interval and restarts the scan after disconnects.
   Bluefruit.Scanner.setRxCallback(globalScanCallback);
-  Bluefruit.Scanner.setInterval(160, 80); // Scan every 200ms for 100ms
+  Bluefruit.Scanner.restartOnDisconnect(false);
   Bluefruit.Scanner.useActiveScan(false);
-  Bluefruit.Scanner.filterUuid(service_.uuid);
+  Bluefruit.Scanner.filterUuid(links_[0].service.uuid);
 }
 
-bool BleThermometer::connected() { return service_.discovered(); }
+bool BleThermometer::connected() { return getProbeCount() > 0; }
 
-void BleThermometer::start() {
-  Log << "BleThermometer::start()\n";
-  if (service_.discovered()) {
+size_t BleThermometer::getProbeCount() const {
+  return std::count_if(probe_conn_handles_.begin(), probe_conn_handles_.end(),
+                       [](const std::atomic<uint16_t> &conn_handle) {
+                         return conn_handle != BLE_CONN_HANDLE_INVALID;
+                       });
+}
+
+bool BleThermometer::update(uint32_t *received_us) {
+  uint32_t dropped = 0;
+  bool has_readings = feed_.update(received_us, &dropped);
+  if (dropped) {
+    search_start_ms_ = millis();
+    is_step_applied_ = false;
+  }
+  updateSearch();
+
+  if (uint32_t overflow_count = feed_.getOverflowCount();
+      overflow_count != reported_overflow_count_) {
+    LOG_WARNING(Log, kBle) << "BleThermometer: "
+                           << overflow_count - reported_overflow_count_
+                           << " readings dropped\n";
+    reported_overflow_count_ = overflow_count;
+  }
+  return has_readings;
+}
+
+void BleThermometer::schedule(Scheduler &scheduler) const {
+  if (!is_searching_ || is_connecting_ || getProbeCount() >= kMaxProbes) {
     return;
   }
-  if (Bluefruit.Scanner.isRunning()) {
-    Bluefruit.Scanner.stop();
+  ScanPolicy::Step step =
+      ScanPolicy::getStep(millis() - search_start_ms_, has_last_probe_);
+  if (step.end_ms != ScanPolicy::kForever) {
+    scheduler.requestUpdateAt(search_start_ms_ + step.end_ms);
+  }
+}
+
+void BleThermometer::start() {
+  LOG_DEBUG(Log, kBle) << "BleThermometer::start()\n";
+  if (is_searching_) {
+    return;
   }
-  Bluefruit.Scanner.restartOnDisconnect(true);
-  Bluefruit.Scanner.start(0);
+  is_searching_ = true;
+  search_start_ms_ = millis();
+  is_step_applied_ = false;
+  search_interrupted_ = false;
+  updateSearch();
 }
 
 void BleThermometer::stop() {
-  Log << "BleThermometer::stop()\n";
+  LOG_DEBUG(Log, kBle) << "BleThermometer::stop()\n";
 
-  Bluefruit.Scanner.restartOnDisconnect(false);
-  Bluefruit.Scanner.stop();
-  if (service_.discovered()) {
-    if (BLEConnection *conn = Bluefruit.Connection(service_.connHandle())) {
+  is_searching_ = false;
+  stopSearchStep();
+  for (Link &link : links_) {
+    if (!link.service.discovered()) {
+      continue;
+    }
+    if (BLEConnection *conn = Bluefruit.Connection(link.service.connHandle())) {
       conn->disconnect();
     }
   }
 }
 
+void BleThermometer::updateSearch() {
+  if (!is_searching_) {
+    return;
+  }
+  // A connection stops the scan or the direct connect, whatever its fate.
+  if (search_interrupted_.exchange(false)) {
+    is_step_applied_ = false;
+  }
+  if (is_connecting_ || getProbeCount() >= kMaxProbes) {
+    return;
+  }
+
+  ScanPolicy::Step step =
+      ScanPolicy::getStep(millis() - search_start_ms_, has_last_probe_);
+  if (!is_step_applied_ || step != applied_step_) {
+    applyStep(step);
+  }
+}
+
+void BleThermometer::applyStep(const ScanPolicy::Step &step) {
+  stopSearchStep();
+  // Direct connects scan for the peer with the same parameters.
+  Bluefruit.Scanner.setInterval(toBleUnits(step.interval_ms),
+                                toBleUnits(step.window_ms));
+  if (step.mode == ScanPolicy::Mode::kDirect) {
+    ble_gap_addr_t probe = last_probe_.load();
+    LOG_INFO(Log, kBle) << "BleThermometer: connecting to "
+                        << BleAddress{probe.addr} << "\n";
+    Bluefruit.Central.connect(&probe);
+  } else {
+    LOG_DEBUG(Log, kBle) << "BleThermometer: scanning " << step.window_ms
+                         << " ms every " << step.interval_ms << " ms\n";
+    Bluefruit.Scanner.start(0);
+  }
+  applied_step_ = step;
+  is_step_applied_ = true;
+}
+
+void BleThermometer::stopSearchStep() {
+  if (is_step_applied_ && applied_step_.mode == ScanPolicy::Mode::kDirect) {
+    sd_ble_gap_connect_cancel();
+  }
+  if (Bluefruit.Scanner.isRunning()) {
+    Bluefruit.Scanner.stop();
+  }
+  is_step_applied_ = false;
+}
+
 bool BleThermometer::connectCallback(const char *name) {
-  Log << "BleThermometer::connectCallback(" << name << ")\n";
+  LOG_DEBUG(Log, kBle) << "BleThermometer::connectCallback(" << name << ")\n";
 
   for (const char *supported_name : {"DUROMATIC", "HOTPAN", "FAKEPOT"}) {
     if (strcmp(name, supported_name) != 0) {
@@ -137,29 +245,28 @@ bool BleThermometer::connectCallback(const char *name) {
   return false;
 }
 
-void BleThermometer::notifyCallback(uint8_t *data, uint16_t len) {
+void BleThermometer::notifyCallback(size_t probe, const PeerAddress &address,
+                                    uint8_t *data, uint16_t len) {
   if (len < 5) {
     return; // Flags (1) + Float (4) minimum
   }
 
-  float temp = decodeIEEE11073(data, len);
-
-  Log << "BleThermometer::notifyCallback(" << temp << "°C)\n";
-
-  analyzer_.addReading(temp, millis());
+  feed_.addReading({static_cast<uint8_t>(probe), address,
+                    decodeIEEE11073(data, len), millis(), micros()});
+  sleeper_.wake();
 }
 
 void BleThermometer::globalScanCallback(ble_gap_evt_adv_report_t *report) {
+  PROFILE_SCOPE("BleThermometer::globalScanCallback");
   std::array<uint8_t, BLE_GAP_ADDR_LEN> addr;
   std::copy_n(report->peer_addr.addr, BLE_GAP_ADDR_LEN, addr.begin());
 
-  Log << "BleThermometer::globalScanCallback(";
-  logAddress(addr.data());
-  Log << ")\n";
+  LOG_DEBUG(Log, kBle) << "BleThermometer::globalScanCallback("
+                       << BleAddress{addr.data()} << ")\n";
 
   std::unique_ptr<BLEScanner, void (*)(BLEScanner *)> resumer(
       &Bluefruit.Scanner, [](BLEScanner *scanner) {
-        Log << "  Resuming scanner\n";
+        LOG_DEBUG(Log, kBle) << "  Resuming scanner\n";
         scanner->resume();
       });
 
@@ -168,38 +275,80 @@ void BleThermometer::globalScanCallback(ble_gap_evt_adv_report_t *report) {
     if (sDenyList[i].addr != addr) {
       continue;
     }
-    Log << "  Denied\n";
+    LOG_DEBUG(Log, kBle) << "  Denied\n";
     return;
   }
 
   if (!sBleThermometer || !Bluefruit.Scanner.checkReportForService(
-                              report, sBleThermometer->service_)) {
+                              report, sBleThermometer->links_[0].service)) {
     return;
   }
 
-  if (sBleThermometer->service_.discovered()) {
-    Log << "  Already connected\n";
+  if (sBleThermometer->getProbeCount() >= kMaxProbes) {
+    LOG_DEBUG(Log, kBle) << "  All links in use\n";
     return;
   }
 
   resumer.release();
-  Log << "  Connecting to 0x"
-      << sBleThermometer->service_.uuid.toString().c_str() << "\n";
+  LOG_INFO(Log, kBle)
+      << "  Connecting to 0x"
+      << sBleThermometer->links_[0].service.uuid.toString().c_str() << "\n";
   addDeniedClient(report->peer_addr.addr, 10 * 1000);
   Bluefruit.Central.connect(report);
 }
 
+class BleThermometer::ProbeGattClient final : public GattClient {
+public:
+  ProbeGattClient(BleThermometer &thermometer, Link &link, BLEConnection &conn)
+      : thermometer_(thermometer), link_(link), conn_(conn) {}
+
+  bool discover(ProbeHandles *handles) override {
+    if (!link_.service.discover(conn_.handle())) {
+      LOG_WARNING(Log, kBle) << "  Service discovery failed\n";
+      return false;
+    }
+    if (!link_.chr.discover()) {
+      LOG_WARNING(Log, kBle) << "  Failed to discover characteristic\n";
+      return false;
+    }
+    *handles = link_.chr.getHandles();
+    return true;
+  }
+
+  bool isSupported() override {
+    std::array<char, 32> name = {};
+    conn_.getPeerName(name.data(), name.size() - 1);
+    return thermometer_.connectCallback(name.data());
+  }
+
+  bool enableNotify(const ProbeHandles &handles) override {
+    link_.service.restore(conn_.handle());
+    link_.chr.restore(handles);
+    if (!link_.chr.enableNotify()) {
+      link_.service.restore(BLE_CONN_HANDLE_INVALID);
+      return false;
+    }
+    return true;
+  }
+
+private:
+  BleThermometer &thermometer_;
+  Link &link_;
+  BLEConnection &conn_;
+};
+
 void BleThermometer::globalConnectCallback(uint16_t conn_handle) {
+  PROFILE_SCOPE("BleThermometer::globalConnectCallback");
 
   BLEConnection *conn = Bluefruit.Connection(conn_handle);
   if (!conn) {
-    Log << "Failed to get connection\n";
+    LOG_WARNING(Log, kBle) << "Failed to get connection\n";
     return;
   }
 
-  std::array<char, 32> name = {};
-  conn->getPeerName(name.data(), name.size() - 1);
-  Log << "BleThermometer::globalConnectCallback(" << name.data() << ")\n";
+  ble_gap_addr_t peer = conn->getPeerAddr();
+  LOG_INFO(Log, kBle) << "BleThermometer::globalConnectCallback("
+                      << BleAddress{peer.addr} << ")\n";
 
   std::unique_ptr<BLEConnection, void (*)(BLEConnection *)> disconnector(
       conn, [](BLEConnection *connection) { connection->disconnect(); });
@@ -208,40 +357,78 @@ void BleThermometer::globalConnectCallback(uint16_t conn_handle) {
     return;
   }
 
-  if (sBleThermometer->service_.discovered()) {
-    Log << "  Service already discovered\n";
-    return;
-  }
+  // Let the loop search on, however this ends.
+  sBleThermometer->is_connecting_ = true;
+  std::unique_ptr<BleThermometer, void (*)(BleThermometer *)> finisher(
+      sBleThermometer, [](BleThermometer *thermometer) {
+        thermometer->is_connecting_ = false;
+        thermometer->search_interrupted_ = true;
+        thermometer->sleeper_.wake();
+      });
 
-  if (!sBleThermometer->service_.discover(conn_handle)) {
-    Log << "  Service discovery failed\n";
+  auto link = std::find_if(
+      sBleThermometer->links_.begin(), sBleThermometer->links_.end(),
+      [](Link &candidate) { return !candidate.service.discovered(); });
+  if (link == sBleThermometer->links_.end()) {
+    LOG_WARNING(Log, kBle) << "  All links in use\n";
     return;
   }
-
-  if (!sBleThermometer->connectCallback(name.data())) {
-    addDeniedClient(conn->getPeerAddr().addr, 10 * 60 * 1000);
-    Log << "  Refused to connect, added ";
-    logAddress(conn->getPeerAddr().addr);
-    Log << " to deny list\n";
+  size_t probe = std::distance(sBleThermometer->links_.begin(), link);
+
+  PeerAddress address;
+  address.type = peer.addr_type;
+  std::copy_n(peer.addr, BLE_GAP_ADDR_LEN, address.bytes.begin());
+  link->chr.address = address;
+
+  ProbeGattClient client(*sBleThermometer, *link, *conn);
+  switch (sBleThermometer->connector_.connect(client, address)) {
+  case ProbeConnector::Result::kCached:
+    LOG_INFO(Log, kBle) << "  Using cached handles\n";
+    break;
+  case ProbeConnector::Result::kDiscovered:
+    break;
+  case ProbeConnector::Result::kNotFound:
     return;
-  }
-
-  if (!sBleThermometer->char_.discover()) {
-    Log << "  Failed to discover characteristic\n";
+  case ProbeConnector::Result::kNotSupported:
+    addDeniedClient(peer.addr, 10 * 60 * 1000);
+    LOG_INFO(Log, kBle) << "  Refused to connect, added "
+                        << BleAddress{peer.addr} << " to deny list\n";
     return;
-  }
-
-  if (!sBleThermometer->char_.enableNotify()) {
-    Log << "  Failed to enable notifications\n";
+  case ProbeConnector::Result::kFailed:
+    LOG_WARNING(Log, kBle) << "  Failed to enable notifications\n";
     return;
   }
 
   disconnector.release();
-  Log << "  Connected\n";
+  sBleThermometer->has_last_probe_ = false;
+  sBleThermometer->probe_addresses_[probe] = peer;
+  sBleThermometer->probe_conn_handles_[probe] = conn_handle;
+  LOG_INFO(Log, kBle) << "  Connected as probe " << probe << "\n";
+}
+
+void BleThermometer::globalDisconnectCallback(uint16_t conn_handle,
+                                              uint8_t reason) {
+  LOG_INFO(Log, kBle) << "globalDisconnectCallback(/*handle=*/" << conn_handle
+                      << ", /*reason=*/" << reason << ")\n";
+  if (!sBleThermometer) {
+    return;
+  }
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    uint16_t probe_conn_handle = conn_handle;
+    if (sBleThermometer->probe_conn_handles_[i].compare_exchange_strong(
+            probe_conn_handle, BLE_CONN_HANDLE_INVALID)) {
+      sBleThermometer->last_probe_.store(sBleThermometer->probe_addresses_[i]);
+      sBleThermometer->has_last_probe_ = true;
+      sBleThermometer->feed_.dropProbe(i);
+    }
+  }
+  sBleThermometer->search_interrupted_ = true;
+  sBleThermometer->sleeper_.wake();
 }
 
 void BleThermometer::globalNotifyCallback(
     BLEClientCharacteristic *characteristic, uint8_t *data, uint16_t len) {
-  static_cast<IntermediateTemp *>(characteristic)
-      ->client->notifyCallback(data, len);
+  PROFILE_SCOPE("BleThermometer::globalNotifyCallback");
+  auto *temp = static_cast<IntermediateTemp *>(characteristic);
+  temp->client->notifyCallback(temp->probe, temp->address, data, len);
 }
@@ -1,40 +1,126 @@
 #pragma once
 
+#include "ArduinoSleeper.h"
+#include "GattClient.h"
+#include "Context.h"
+#include "ProbeConnector.h"
+#include "ProbeFeed.h"
+#include "ProbeSink.h"
+#include "ScanPolicy.h"
+#include "Scheduler.h"
+#include "SeqLock.h"
 #include "Thermometer.h"
-#include "TrendAnalyzer.h"
 #include <array>
+#include <atomic>
 #include <bluefruit.h>
+#include <cstddef>
 #include <cstdint>
 
+// Connects to up to kMaxProbes probes at once and passes their readings to
+// a ProbeSink, a ProbeFusion or a ProbeRouter. Searches while fewer are
+// connected.
 class BleThermometer : public Thermometer {
 
   class IntermediateTemp final : public BLEClientCharacteristic {
   public:
-    IntermediateTemp(BleThermometer *client)
-        : BLEClientCharacteristic(UUID16_CHR_INTERMEDIATE_TEMPERATURE), client(client) {}
-    BleThermometer *client;
+    IntermediateTemp()
+        : BLEClientCharacteristic(UUID16_CHR_INTERMEDIATE_TEMPERATURE) {}
+    BleThermometer *client = nullptr;
+    size_t probe = 0;    // Index of its link
+    PeerAddress address; // Of the probe, set before notifications are on
+
+    ProbeHandles getHandles() const {
+      return {_chr.handle_value, _cccd_handle};
+    }
+    // Takes the handles of an earlier discovery, as discover() would.
+    void restore(const ProbeHandles &handles) {
+      _chr.handle_value = handles.value_handle;
+      _chr.char_props.notify = 1;
+      _cccd_handle = handles.cccd_handle;
+    }
+  };
+
+  class ThermometerService final : public BLEClientService {
+  public:
+    ThermometerService() : BLEClientService(UUID16_SVC_HEALTH_THERMOMETER) {}
+
+    // Binds to a connection without discovery, for restored handles.
+    void restore(uint16_t conn_handle) { _conn_hdl = conn_handle; }
+  };
+
+  // One probe connection.
+  struct Link {
+    ThermometerService service;
+    IntermediateTemp chr;
   };
 
+  // The GattClient on a new connection, for the ProbeConnector.
+  class ProbeGattClient;
+
 public:
-  BleThermometer(TrendAnalyzer &analyzer);
+  // Each uses a central connection of its own: Bluefruit.begin() must allow
+  // as many.
+  static constexpr size_t kMaxProbes = 2;
+  static_assert(kMaxProbes <= ProbeFeed::kMaxProbes, "Too many probes");
+
+  BleThermometer(const Context &context, ProbeSink &probes,
+                 ArduinoSleeper &sleeper);
   ~BleThermometer();
 
   void begin();
+  // Passes the readings received since the last call to the ProbeSink.
+  // Returns whether there were any, and when the oldest arrived in micros().
+  bool update(uint32_t *received_us = nullptr);
+  void schedule(Scheduler &scheduler) const;
   void start() override;
   void stop() override;
   bool connected() override;
 
 private:
   bool connectCallback(const char *name);
-  void notifyCallback(uint8_t *data, uint16_t len);
+  void notifyCallback(size_t probe, const PeerAddress &address, uint8_t *data,
+                      uint16_t len);
+
+  size_t getProbeCount() const;
+
+  // Follows the ScanPolicy while searching and short of probes.
+  void updateSearch();
+  void applyStep(const ScanPolicy::Step &step);
+  void stopSearchStep();
 
   static void globalConnectCallback(uint16_t conn_handle);
+  static void globalDisconnectCallback(uint16_t conn_handle, uint8_t reason);
   static void globalScanCallback(ble_gap_evt_adv_report_t *report);
   static void globalNotifyCallback(BLEClientCharacteristic *chr, uint8_t *data,
                                    uint16_t len);
 
-  TrendAnalyzer &analyzer_;
+  ArduinoSleeper &sleeper_;
+
+  // From the BLE callback task to the loop.
+  ProbeFeed feed_;
+  uint32_t reported_overflow_count_ = 0;
+
+  // Between start() and stop().
+  bool is_searching_ = false;
+  uint32_t search_start_ms_ = 0;
+  ScanPolicy::Step applied_step_ = {};
+  bool is_step_applied_ = false;
+
+  // The last probe lost, for a direct reconnect until any probe connects.
+  // Only its address: the probes are not bonded, so there is no IRK to
+  // resolve a private one.
+  SeqLock<ble_gap_addr_t> last_probe_;
+  std::atomic<bool> has_last_probe_{false};
+  // Of the accepted probe on each link, or BLE_CONN_HANDLE_INVALID.
+  std::array<std::atomic<uint16_t>, kMaxProbes> probe_conn_handles_;
+  // Set by the BLE task while it sets up a connection, and when one was set
+  // up or refused, or ended: either stops the scan or the direct connect.
+  std::atomic<bool> is_connecting_{false};
+  std::atomic<bool> search_interrupted_{false};
+
+  // Used from the BLE task only.
+  ProbeConnector connector_;
+  std::array<ble_gap_addr_t, kMaxProbes> probe_addresses_ = {};
 
-  BLEClientService service_= {UUID16_SVC_HEALTH_THERMOMETER};
-  IntermediateTemp char_  = {this};
+  std::array<Link, kMaxProbes> links_;
 };
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "PwmSequence.h"
+#include <Arduino.h>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <nrf_pwm.h>
+
+// Plays compiled sequences on an nRF52 PWM instance by EasyDMA, looping in
+// hardware when asked to, so the CPU can sleep through a pattern. From the
+// main loop only.
+class PwmSequencer final {
+public:
+  static constexpr size_t kMaxEntries = 96;
+
+  explicit PwmSequencer(NRF_PWM_Type *pwm) : pwm_(pwm) {}
+
+  // Channels 0 to 2, -1 for none.
+  void connect(int pin0, int pin1 = -1, int pin2 = -1) {
+    int pins[] = {pin0, pin1, pin2};
+    for (size_t i = 0; i < std::size(pins); ++i) {
+      pwm_->PSEL.OUT[i] =
+          pins[i] < 0 ? 0xFFFFFFFF : g_ADigitalPinMap[pins[i]];
+    }
+  }
+
+  void disconnect() {
+    stop();
+    for (size_t i = 0; i < 4; ++i) {
+      pwm_->PSEL.OUT[i] = 0xFFFFFFFF;
+    }
+  }
+
+  // The buffer to compile the next sequence into, not the one playing.
+  PwmEntry *getBuffer() { return buffers_[next_].data(); }
+
+  // Plays the first `count` entries of getBuffer(). A sequence that started
+  // while another plays takes over at the end of the current PWM period.
+  void play(size_t count, bool repeat) {
+    if (count == 0) {
+      stop();
+      return;
+    }
+    const PwmEntry *entries = buffers_[next_].data();
+    next_ = 1 - next_;
+
+    pwm_->MODE = PWM_MODE_UPDOWN_Up;
+    pwm_->PRESCALER = PWM_PRESCALER_PRESCALER_DIV_2; // kPwmClockHz
+    pwm_->DECODER = (PWM_DECODER_LOAD_WaveForm << PWM_DECODER_LOAD_Pos) |
+                    (PWM_DECODER_MODE_RefreshCount << PWM_DECODER_MODE_Pos);
+    // Both sequences are the same, played back to back, and LOOPSDONE starts
+    // them over.
+    for (size_t i = 0; i < 2; ++i) {
+      pwm_->SEQ[i].PTR = reinterpret_cast<uint32_t>(entries);
+      pwm_->SEQ[i].CNT = count * sizeof(PwmEntry) / sizeof(uint16_t);
+      pwm_->SEQ[i].REFRESH = kPwmPeriodsPerEntry - 1;
+      pwm_->SEQ[i].ENDDELAY = 0;
+    }
+    pwm_->LOOP = repeat ? 1 : 0;
+    pwm_->SHORTS = repeat ? PWM_SHORTS_LOOPSDONE_SEQSTART0_Msk
+                          : PWM_SHORTS_SEQEND0_STOP_Msk;
+    pwm_->ENABLE = 1;
+    pwm_->TASKS_SEQSTART[0] = 1;
+  }
+
+  void stop() {
+    pwm_->SHORTS = 0;
+    pwm_->TASKS_STOP = 1;
+    pwm_->ENABLE = 0;
+  }
+
+private:
+  NRF_PWM_Type *const pwm_;
+  // Double buffered, as EasyDMA may still read the one that played last.
+  std::array<std::array<PwmEntry, kMaxEntries>, 2> buffers_ = {};
+  size_t next_ = 0;
+};
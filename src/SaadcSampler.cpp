@@ -0,0 +1,177 @@
+#include "SaadcSampler.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <cassert>
+#include <nrf_soc.h>
+
+namespace {
+
+// RTC ticks at 32768 Hz / (prescaler + 1), about 496 Hz.
+constexpr uint32_t kRtcPrescaler = 65;
+// About 80 Hz, so a block of 8 scans spans the 100 ms idle dial poll.
+constexpr uint32_t kIdleRtcPrescaler = 409;
+// STOP takes effect within one 32 kHz tick, and PRESCALER only takes
+// writes while the RTC is stopped.
+constexpr uint32_t kRtcStopUs = 50;
+// PPI channels 0 to 16 are free for the application under the SoftDevice.
+constexpr uint8_t kSamplePpiChannel = 14;
+constexpr uint8_t kRestartPpiChannel = 15;
+
+SaadcSampler *sSampler = nullptr;
+
+// The SAADC input of an Arduino pin, 0 (not connected) for digital-only pins.
+uint32_t getAnalogInput(int pin) {
+  switch (g_ADigitalPinMap[pin]) {
+  case 2:
+    return SAADC_CH_PSELP_PSELP_AnalogInput0;
+  case 3:
+    return SAADC_CH_PSELP_PSELP_AnalogInput1;
+  case 4:
+    return SAADC_CH_PSELP_PSELP_AnalogInput2;
+  case 5:
+    return SAADC_CH_PSELP_PSELP_AnalogInput3;
+  case 28:
+    return SAADC_CH_PSELP_PSELP_AnalogInput4;
+  case 29:
+    return SAADC_CH_PSELP_PSELP_AnalogInput5;
+  case 30:
+    return SAADC_CH_PSELP_PSELP_AnalogInput6;
+  case 31:
+    return SAADC_CH_PSELP_PSELP_AnalogInput7;
+  default:
+    return SAADC_CH_PSELP_PSELP_NC;
+  }
+}
+
+} // namespace
+
+extern "C" void SAADC_IRQHandler() { SaadcSampler::handleInterrupt(); }
+
+SaadcSampler::Channel &SaadcSampler::addChannel(int pin, float scale) {
+  assert(channel_count_ < kMaxChannels);
+  Channel &channel = channels_[channel_count_];
+  channel.sampler_ = this;
+  channel.index_ = channel_count_;
+  channel.scale_ = scale;
+  pins_[channel_count_++] = pin;
+  return channel;
+}
+
+void SaadcSampler::begin() {
+  sSampler = this;
+
+  NRF_SAADC->ENABLE = SAADC_ENABLE_ENABLE_Disabled;
+  NRF_SAADC->RESOLUTION = SAADC_RESOLUTION_VAL_12bit;
+  NRF_SAADC->OVERSAMPLE = SAADC_OVERSAMPLE_OVERSAMPLE_Over8x;
+  NRF_SAADC->SAMPLERATE = SAADC_SAMPLERATE_MODE_Task
+                          << SAADC_SAMPLERATE_MODE_Pos;
+  for (size_t i = 0; i < SAADC_CH_NUM; ++i) {
+    NRF_SAADC->CH[i].PSELP = SAADC_CH_PSELP_PSELP_NC;
+    NRF_SAADC->CH[i].PSELN = SAADC_CH_PSELN_PSELN_NC;
+  }
+  // The 3.6 V range of analogRead(), oversampled per channel in a burst so
+  // that scanning several channels averages each on its own.
+  for (size_t i = 0; i < channel_count_; ++i) {
+    NRF_SAADC->CH[i].CONFIG =
+        (SAADC_CH_CONFIG_GAIN_Gain1_6 << SAADC_CH_CONFIG_GAIN_Pos) |
+        (SAADC_CH_CONFIG_REFSEL_Internal << SAADC_CH_CONFIG_REFSEL_Pos) |
+        (SAADC_CH_CONFIG_TACQ_10us << SAADC_CH_CONFIG_TACQ_Pos) |
+        (SAADC_CH_CONFIG_MODE_SE << SAADC_CH_CONFIG_MODE_Pos) |
+        (SAADC_CH_CONFIG_BURST_Enabled << SAADC_CH_CONFIG_BURST_Pos);
+    NRF_SAADC->CH[i].PSELP = getAnalogInput(pins_[i]);
+  }
+  NRF_SAADC->RESULT.PTR = reinterpret_cast<uint32_t>(buffers_[0].data());
+  NRF_SAADC->RESULT.MAXCNT = kBlockFrames * channel_count_;
+
+  NRF_SAADC->EVENTS_STARTED = 0;
+  NRF_SAADC->EVENTS_END = 0;
+  NRF_SAADC->INTENSET = SAADC_INTENSET_STARTED_Msk | SAADC_INTENSET_END_Msk;
+  NVIC_SetPriority(SAADC_IRQn, 6);
+  NVIC_ClearPendingIRQ(SAADC_IRQn);
+  NVIC_EnableIRQ(SAADC_IRQn);
+  NRF_SAADC->ENABLE = SAADC_ENABLE_ENABLE_Enabled;
+
+  // RTC2 samples every channel on each tick, and a full buffer restarts
+  // DMA into the other half.
+  NRF_RTC2->TASKS_STOP = 1;
+  NRF_RTC2->TASKS_CLEAR = 1;
+  NRF_RTC2->PRESCALER = kRtcPrescaler;
+  NRF_RTC2->EVTENSET = RTC_EVTENSET_TICK_Msk;
+  sd_ppi_channel_assign(kSamplePpiChannel, &NRF_RTC2->EVENTS_TICK,
+                        &NRF_SAADC->TASKS_SAMPLE);
+  sd_ppi_channel_assign(kRestartPpiChannel, &NRF_SAADC->EVENTS_END,
+                        &NRF_SAADC->TASKS_START);
+  sd_ppi_channel_enable_set((1u << kSamplePpiChannel) |
+                            (1u << kRestartPpiChannel));
+
+  NRF_SAADC->TASKS_START = 1;
+  NRF_RTC2->TASKS_START = 1;
+}
+
+void SaadcSampler::setIdle(bool is_idle) {
+  if (is_idle == is_idle_) {
+    return;
+  }
+  is_idle_ = is_idle;
+  NRF_RTC2->TASKS_STOP = 1;
+  delayMicroseconds(kRtcStopUs);
+  NRF_RTC2->PRESCALER = is_idle ? kIdleRtcPrescaler : kRtcPrescaler;
+  NRF_RTC2->TASKS_START = 1;
+}
+
+void SaadcSampler::handleInterrupt() {
+  SaadcSampler *sampler = sSampler;
+  // END before STARTED: when both are pending, the restart that PPI
+  // triggered on END has already begun on the other half.
+  if (NRF_SAADC->EVENTS_END) {
+    NRF_SAADC->EVENTS_END = 0;
+    sampler->completed_blocks_.store(
+        sampler->completed_blocks_.load(std::memory_order_relaxed) + 1,
+        std::memory_order_release);
+  }
+  if (NRF_SAADC->EVENTS_STARTED) {
+    NRF_SAADC->EVENTS_STARTED = 0;
+    // DMA latched the pointer, so the next START can have the other half.
+    uint32_t next =
+        (sampler->completed_blocks_.load(std::memory_order_relaxed) + 1) % 2;
+    NRF_SAADC->RESULT.PTR =
+        reinterpret_cast<uint32_t>(sampler->buffers_[next].data());
+  }
+}
+
+const int16_t *SaadcSampler::getBlock(uint32_t *count) const {
+  *count = completed_blocks_.load(std::memory_order_acquire);
+  return *count == 0 ? nullptr : buffers_[(*count - 1) % 2].data();
+}
+
+float SaadcSampler::Channel::read() const {
+  uint32_t count;
+  const int16_t *block = sampler_->getBlock(&count);
+  if (!block) {
+    return 0.0f;
+  }
+  size_t frame = kBlockFrames - 1;
+  return std::max<int16_t>(
+             0, block[frame * sampler_->channel_count_ + index_]) *
+         scale_;
+}
+
+size_t SaadcSampler::Channel::readBlock(float *samples, size_t size) const {
+  uint32_t count;
+  const int16_t *block = sampler_->getBlock(&count);
+  if (!block || count == blocks_read_) {
+    return 0;
+  }
+  blocks_read_ = count;
+
+  // The half being read is rewritten two blocks later, some 30 ms away.
+  size_t frames = std::min(size, kBlockFrames);
+  for (size_t i = 0; i < frames; ++i) {
+    size_t frame = kBlockFrames - frames + i;
+    // Single-ended results dip below zero with noise at 0 V.
+    samples[i] = std::max<int16_t>(
+                     0, block[frame * sampler_->channel_count_ + index_]) *
+                 scale_;
+  }
+  return frames;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "AnalogReadPin.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Samples analog inputs continuously with the SAADC, without the CPU: RTC2
+// triggers a scan of all channels through PPI at about 500 Hz, each channel
+// oversampled 8x in a burst, and EasyDMA writes the results into one half of
+// a double buffer while the other half is read. The interrupt only swaps
+// the halves, every kBlockFrames scans.
+//
+// While the stove is off, setIdle() slows the scans to about 80 Hz, a
+// block per idle dial poll.
+//
+// Owns the SAADC, so analogRead() must not be used once begin() ran.
+class SaadcSampler final {
+public:
+  static constexpr size_t kMaxChannels = 2;
+  static constexpr size_t kBlockFrames = 8;
+
+  // A channel of the sampler as an AnalogReadPin. read() is the newest
+  // sample, readBlock() the newest completed block.
+  class Channel final : public AnalogReadPin {
+  public:
+    float read() const override;
+    size_t readBlock(float *samples, size_t size) const override;
+
+  private:
+    friend class SaadcSampler;
+
+    const SaadcSampler *sampler_ = nullptr;
+    size_t index_ = 0;
+    float scale_ = 1.0f;
+    mutable uint32_t blocks_read_ = 0;
+  };
+
+  // Adds an input, before begin(). `scale` converts the 12-bit value, as
+  // for ArduinoAnalogReadPin.
+  Channel &addChannel(int pin, float scale);
+
+  // After Bluefruit.begin(), which enables the SoftDevice that owns PPI.
+  void begin();
+
+  // Scans slowly while `is_idle`, at the full rate otherwise.
+  void setIdle(bool is_idle);
+
+  // From SAADC_IRQHandler only.
+  static void handleInterrupt();
+
+private:
+  // The block DMA completed last, and how many completed.
+  const int16_t *getBlock(uint32_t *count) const;
+
+  std::array<Channel, kMaxChannels> channels_;
+  std::array<int, kMaxChannels> pins_ = {};
+  size_t channel_count_ = 0;
+  bool is_idle_ = false;
+
+  // Halves of the double buffer, one frame of all channels after another.
+  std::array<std::array<int16_t, kBlockFrames * kMaxChannels>, 2> buffers_ = {};
+  std::atomic<uint32_t> completed_blocks_{0};
+};
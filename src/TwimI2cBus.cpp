@@ -0,0 +1,77 @@
+#include "TwimI2cBus.h"
+#include <algorithm>
+
+namespace {
+
+// Open drain with the pull-ups on, as Wire configures its pins.
+void configurePin(int pin) {
+  nrf_gpio_cfg(g_ADigitalPinMap[pin], NRF_GPIO_PIN_DIR_INPUT,
+               NRF_GPIO_PIN_INPUT_CONNECT, NRF_GPIO_PIN_PULLUP,
+               NRF_GPIO_PIN_S0D1, NRF_GPIO_PIN_NOSENSE);
+}
+
+} // namespace
+
+TwimI2cBus::TwimI2cBus(NRF_TWIM_Type *twim, int sda_pin, int scl_pin)
+    : twim_(twim), sda_pin_(sda_pin), scl_pin_(scl_pin) {}
+
+void TwimI2cBus::begin() {
+  twim_->ENABLE = TWIM_ENABLE_ENABLE_Disabled;
+  configurePin(sda_pin_);
+  configurePin(scl_pin_);
+  twim_->PSEL.SDA = g_ADigitalPinMap[sda_pin_];
+  twim_->PSEL.SCL = g_ADigitalPinMap[scl_pin_];
+  twim_->FREQUENCY = TWIM_FREQUENCY_FREQUENCY_K400;
+  twim_->SHORTS = TWIM_SHORTS_LASTTX_STOP_Msk;
+  twim_->INTENCLR = 0xFFFFFFFF;
+  twim_->ENABLE = TWIM_ENABLE_ENABLE_Enabled;
+}
+
+bool TwimI2cBus::startWrite(uint8_t address, const uint8_t *data,
+                            size_t size) {
+  if (getStatus() == Status::kBusy || size > buffer_.size()) {
+    return false;
+  }
+  std::copy(data, data + size, buffer_.begin());
+  twim_->ADDRESS = address;
+  twim_->TXD.PTR = reinterpret_cast<uint32_t>(buffer_.data());
+  twim_->TXD.MAXCNT = size;
+  twim_->EVENTS_STOPPED = 0;
+  twim_->EVENTS_ERROR = 0;
+  twim_->ERRORSRC = twim_->ERRORSRC; // Write 1 to clear
+  twim_->TASKS_STARTTX = 1;
+  is_busy_ = true;
+  is_stopping_ = false;
+  return true;
+}
+
+I2cBus::Status TwimI2cBus::getStatus() {
+  if (!is_busy_) {
+    return status_;
+  }
+  // After a NACK the last byte never goes out, so nothing triggers the
+  // shortcut to STOP.
+  if (twim_->EVENTS_ERROR && !is_stopping_) {
+    twim_->EVENTS_ERROR = 0;
+    twim_->TASKS_STOP = 1;
+    is_stopping_ = true;
+  }
+  if (!twim_->EVENTS_STOPPED) {
+    return Status::kBusy;
+  }
+  twim_->EVENTS_STOPPED = 0;
+
+  uint32_t error_source = twim_->ERRORSRC;
+  twim_->ERRORSRC = error_source;
+  if (error_source & TWIM_ERRORSRC_ANACK_Msk) {
+    status_ = Status::kAddressNack;
+  } else if (error_source & TWIM_ERRORSRC_DNACK_Msk) {
+    status_ = Status::kDataNack;
+  } else if (is_stopping_ || twim_->TXD.AMOUNT != twim_->TXD.MAXCNT) {
+    status_ = Status::kError;
+  } else {
+    status_ = Status::kOk;
+  }
+  is_busy_ = false;
+  return status_;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "I2cBus.h"
+#include <Arduino.h>
+#include <array>
+
+// An I2C controller on a TWIM peripheral at 400 kHz: EasyDMA sends the bytes
+// and the STOP condition follows by a shortcut, so startWrite() returns at
+// once. getStatus() polls the events, so no interrupt vector is claimed
+// from the core's Wire, which must not use the same TWIM.
+class TwimI2cBus final : public I2cBus {
+public:
+  TwimI2cBus(NRF_TWIM_Type *twim, int sda_pin, int scl_pin);
+
+  void begin();
+
+  bool startWrite(uint8_t address, const uint8_t *data, size_t size) override;
+  Status getStatus() override;
+
+private:
+  NRF_TWIM_Type *const twim_;
+  const int sda_pin_;
+  const int scl_pin_;
+
+  // EasyDMA reads from RAM until the transfer ends.
+  std::array<uint8_t, kMaxWriteSize> buffer_ = {};
+  bool is_busy_ = false;
+  bool is_stopping_ = false;
+  Status status_ = Status::kOk;
+};
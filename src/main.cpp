@@ -1,26 +1,48 @@
 #include <Adafruit_TinyUSB.h>
 #include <Arduino.h>
-#include <Wire.h>
 #include <algorithm>
+#include <array>
 #include <bluefruit.h>
+#include <cstring>
 
-#include "AdafruitPotentiometer.h"
-#include "ArduinoAnalogReadPin.h"
 #include "ArduinoAnalogWritePin.h"
 #include "ArduinoBuzzer.h"
+#include "ArduinoClock.h"
 #include "ArduinoDigitalWritePin.h"
 #include "ArduinoLogger.h"
+#include "ArduinoSleeper.h"
 #include "Beeper.h"
+#include "BinaryLogger.h"
 #include "BleTelemetry.h"
 #include "BleThermometer.h"
-#include "StoveActuator.h"
-#include "StoveDial.h"
-#include "StoveSupervisor.h"
-#include "ThermalController.h"
-#include "TrendAnalyzer.h"
+#include "Context.h"
+#include "DS3502Potentiometer.h"
+#include "LatchedClock.h"
+#include "LoopMonitor.h"
+#include "SaadcSampler.h"
+#include "ProbeFusion.h"
+#include "ProbeRouter.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "TraceBuffer.h"
+#include "TracingDevices.h"
+#include "TwimI2cBus.h"
+#include "Zone.h"
+#include "ZoneSet.h"
 
 void delayUs(uint32_t us) { delayMicroseconds(us); }
 
+#ifdef KRC_PROFILE
+uint32_t readProfileTicks() { return DWT->CYCCNT; }
+
+// Starts the cycle counter of the Data Watchpoint and Trace unit.
+static void beginProfileTicks() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+#endif
+
 constexpr int kBuzzerPPin = D0;
 constexpr int kBuzzerNPin = D1;
 constexpr int kSclPin = D2;
@@ -36,11 +58,49 @@ constexpr int kLedBluePin = LED_BLUE;
 
 BLEDfu bledfu;
 
-// Tee stream for logging to Serial and BLE
 BLEUart bleuart;
+#ifdef KRC_TRACE
+// Session trace, drained to Serial. Replay with tools/replay.
+TraceBuffer trace_buffer;
+TraceWriter *trace = &trace_buffer;
+constexpr size_t kTraceDrainBytes = 1024;
+constexpr uint32_t kTraceDrainIntervalMs = 20;
+#else
+TraceWriter *trace = nullptr;
+#endif
+
+#ifdef KRC_BINARY_LOG
+// Binary records, drained to Serial and BLE in idle time. Decode with
+// tools/logdecode.
+BinaryLogger logger;
+constexpr size_t kLogDrainBytes = 256;
+constexpr uint32_t kLogDrainIntervalMs = 20;
+#elif defined(KRC_TRACE)
+// Serial carries the trace, so log to BLE only.
+class NullPrint final : public Print {
+public:
+  size_t write(uint8_t) override { return 1; }
+};
+NullPrint null_print;
+ArduinoLogger logger(null_print, bleuart);
+#else
+// Tee stream for logging to Serial and BLE
 ArduinoLogger logger(Serial, bleuart);
+#endif
 Logger &Log = logger;
 
+ArduinoClock arduino_clock;
+// One time per loop iteration, as in a replay.
+LatchedClock loop_clock(arduino_clock);
+Context context{loop_clock, logger};
+
+// Main loop pacing
+constexpr uint32_t kMaxSleepMs = 1000;
+constexpr uint32_t kLogIntervalMs = 60 * 1000;
+ArduinoSleeper sleeper;
+Scheduler scheduler(arduino_clock, kMaxSleepMs);
+LoopMonitor loop_monitor;
+
 // Actuator Pins
 class BypassPin : public DigitalWritePin {
 public:
@@ -59,34 +119,47 @@ private:
   ArduinoDigitalWritePin led_pin_{kLedGreenPin};
 };
 
-AdafruitPotentiometer potentiometer;
+// TWIM0, which Wire would use, but nothing else is on the bus
+TwimI2cBus i2c_bus(NRF_TWIM0, kSdaPin, kSclPin);
+DS3502Potentiometer potentiometer(context, i2c_bus);
 BypassPin bypass_pin;
-ThrottleConfig throttle_config; // Defaults
-StoveActuator actuator(potentiometer, bypass_pin, throttle_config);
+TracingPotentiometer traced_potentiometer(potentiometer, trace);
+TracingBypassPin traced_bypass_pin(bypass_pin, trace);
 
-// Sensor Pins
-ArduinoAnalogReadPin input_read_pin(kStoveDialPin, 1.0f / 4095.0f / 0.9f);
-StoveDial dial(input_read_pin, throttle_config);
+// Sensor Pins, sampled continuously by the SAADC
+SaadcSampler saadc;
+const AnalogReadPin &input_read_pin =
+    saadc.addChannel(kStoveDialPin, 1.0f / 4095.0f / 0.9f);
+TracingDialPin traced_input_read_pin(input_read_pin, trace);
 
 // Feedback
 ArduinoBuzzer buzzer(NRF_PWM3, kBuzzerPPin, kBuzzerNPin);
-Beeper beeper(buzzer);
-ArduinoAnalogReadPin output_read_pin(kOutputReadPin, 1.0f / 4095.0f);
+const AnalogReadPin &output_read_pin =
+    saadc.addChannel(kOutputReadPin, 1.0f / 4095.0f);
 ArduinoAnalogWritePin output_led_pin(kLedRedPin);
 
-// Logic Modules
-TrendAnalyzer analyzer;
-ThermalConfig thermal_config; // Defaults
-ThermalController controller(analyzer, thermal_config);
+// BLE Modules. The router starts and stops the thermometer, which hands it
+// the probes.
+extern BleThermometer thermometer;
+ProbeRouter router(context, thermometer);
+BleThermometer thermometer(context, router, sleeper);
+static_assert(BleThermometer::kMaxProbes <= ProbeRouter::kMaxProbes,
+              "ProbeRouter would drop the readings of the extra links");
+static_assert(BleThermometer::kMaxProbes <= ProbeFusion::kMaxProbes,
+              "ProbeFusion would drop the readings of the extra links");
+TracingThermometer traced_thermometer(router.getThermometer(0), trace);
 
-// BLE Modules
-BleThermometer thermometer(analyzer);
-BleTelemetry telemetry(bleuart, controller, analyzer);
+// The one burner
+ZoneConfig zone_config; // Defaults
+Zone zone(context,
+          {traced_input_read_pin, traced_potentiometer, traced_bypass_pin,
+           buzzer, traced_thermometer, trace},
+          zone_config);
+ZoneSet<1> zones(loop_clock, kMaxSleepMs, {&zone});
 
-// Supervisor
-StoveConfig stove_config;
-StoveSupervisor supervisor(dial, actuator, controller, beeper, analyzer,
-                           thermometer, stove_config, throttle_config);
+// Reports the supervisor state, so after it
+BleTelemetry telemetry(bleuart, zone.getController(), zone.getAnalyzer(),
+                       zone.getSupervisor(), sleeper, loop_monitor, trace);
 
 void setup() {
   Serial.begin(115200);
@@ -94,57 +167,171 @@ void setup() {
     delay(10);
   }
 
-  Log << "KRC Interceptor Starting...\n";
-
-  analogReadResolution(12);
-  Wire.setPins(kSdaPin, kSclPin);
+  LOG_INFO(Log, kSystem) << "KRC Interceptor Starting...\n";
+#ifdef KRC_PROFILE
+  beginProfileTicks();
+#endif
 
+  i2c_bus.begin();
   bypass_pin.begin();
-  input_read_pin.begin();
-  output_read_pin.begin();
   output_led_pin.begin();
   buzzer.begin();
   potentiometer.begin();
 
-  Bluefruit.begin(1, 1);
+  Bluefruit.begin(1, BleThermometer::kMaxProbes);
   Bluefruit.setName("KRC Interposer");
   Bluefruit.configPrphBandwidth(BANDWIDTH_MAX);
   Bluefruit.Security.setIOCaps(false, false, false);
   Bluefruit.Security.setMITM(false);
 
+  saadc.begin();
   bledfu.begin();
   thermometer.begin();
   telemetry.begin();
+#ifdef KRC_PROFILE
+  bleuart.setRxCallback([](uint16_t) { sleeper.wake(); });
+#endif
 
-  actuator.setBypass();
+  loop_clock.latch();
+  zone.begin();
+  if (trace) {
+    TraceHeader header;
+    header.thermal = zone_config.thermal;
+    header.stove = zone_config.stove;
+    header.throttle = zone_config.throttle;
+    header.autotune = zone_config.autotune;
+    trace->header(header);
+  }
+  sleeper.begin();
 }
 
+static uint32_t last_log_ms = 0;
+
 static void log(uint32_t time_ms) {
-  static uint32_t last_log_ms = 0;
-  if (time_ms - last_log_ms < 60 * 1000) {
+  if (time_ms - last_log_ms < kLogIntervalMs) {
     return;
   }
   last_log_ms = time_ms;
 
-  if (analyzer.getLastUpdateMs() != 0) {
-    Log << "Analyzer: " << analyzer.getValue(last_log_ms) << "°C "
-        << analyzer.getSlope() << "°C/ms\n";
+  if (auto estimate = zone.getAnalyzer().getEstimate(); estimate.count != 0) {
+    LOG_DEBUG(Log, kSystem) << "Analyzer: " << estimate.getValue(last_log_ms)
+                            << "°C " << estimate.slope << "°C/ms, "
+                            << estimate.count << " readings\n";
   }
-  Log << "Dial: position " << dial.getPosition() << "\n";
-  Log << "Controller: power " << controller.getPower()
-      << (controller.isLidOpen() ? " (lid open)" : "") << "\n";
+  const ThermalController &controller = zone.getController();
+  LOG_DEBUG(Log, kSystem) << "Dial: position " << zone.getDial().getPosition()
+                          << "\n";
+  LOG_DEBUG(Log, kSystem) << "Controller: power " << controller.getPower()
+                          << (controller.isLidOpen() ? " (lid open)" : "")
+                          << "\n";
+  LOG_DEBUG(Log, kSystem) << "Loop: p99 duration "
+                          << loop_monitor.getDuration().getPercentile(0.99f)
+                          << "us, lateness "
+                          << loop_monitor.getLateness().getPercentile(0.99f)
+                          << "us, latency "
+                          << loop_monitor.getLatency().getPercentile(0.99f)
+                          << "us\n";
 }
 
+#ifdef KRC_BINARY_LOG
+static void drainLog() {
+  uint8_t buffer[64];
+  for (size_t drained = 0; drained < kLogDrainBytes;) {
+    size_t size = logger.read(buffer, sizeof(buffer));
+    if (size == 0) {
+      break;
+    }
+    Serial.write(buffer, size);
+    bleuart.write(buffer, size);
+    drained += size;
+  }
+  if (logger.available()) {
+    scheduler.requestUpdateIn(kLogDrainIntervalMs);
+  }
+}
+#endif
+
+#ifdef KRC_TRACE
+static void drainTrace() {
+  uint8_t buffer[64];
+  for (size_t drained = 0; drained < kTraceDrainBytes;) {
+    size_t size = trace_buffer.read(buffer, sizeof(buffer));
+    if (size == 0) {
+      break;
+    }
+    Serial.write(buffer, size);
+    drained += size;
+  }
+  if (trace_buffer.available()) {
+    scheduler.requestUpdateIn(kTraceDrainIntervalMs);
+  }
+}
+#endif
+
+#ifdef KRC_PROFILE
+// Commands typed into the BLE UART, one per line: "profile" dumps the
+// profile, "profile clear" starts over.
+static void handleUartCommands() {
+  static std::array<char, 32> line;
+  static size_t length = 0;
+  while (bleuart.available()) {
+    char c = bleuart.read();
+    if (c != '\n' && c != '\r') {
+      if (length < line.size() - 1) {
+        line[length++] = c;
+      }
+      continue;
+    }
+    line[length] = '\0';
+    length = 0;
+    if (strcmp(line.data(), "profile") == 0) {
+      Profiler::dump(Log, SystemCoreClock / 1000000);
+    } else if (strcmp(line.data(), "profile clear") == 0) {
+      Profiler::clear();
+    }
+  }
+}
+#endif
+
 void loop() {
-  uint32_t now = millis();
+  loop_monitor.beginIteration(micros());
 
-  supervisor.update();
+  uint32_t received_us;
+  bool has_readings = thermometer.update(&received_us);
+  // After the readings, stamped with millis() as they arrived, so that none
+  // is newer than the loop's time.
+  loop_clock.latch();
+  uint32_t now = loop_clock.millis();
+  // The zone runs when due, and at once when the readings were its own.
+  zones.update();
+  saadc.setIdle(zone.getSupervisor().isIdle());
+  potentiometer.update();
+  if (has_readings) {
+    loop_monitor.addActuation(micros(), received_us);
+  }
 
   float output_val = std::clamp(output_read_pin.read(), 0.0f, 1.0f);
   output_led_pin.write(1.0f - output_val);
 
   log(now);
   telemetry.update();
+#ifdef KRC_PROFILE
+  handleUartCommands();
+#endif
 
-  delay(10);
+  scheduler.begin();
+  zones.schedule(scheduler);
+  potentiometer.schedule(scheduler);
+  thermometer.schedule(scheduler);
+  telemetry.schedule(scheduler);
+  scheduler.requestUpdateAt(last_log_ms + kLogIntervalMs);
+#ifdef KRC_BINARY_LOG
+  drainLog();
+#endif
+#ifdef KRC_TRACE
+  drainTrace();
+#endif
+  uint32_t sleep_ms = scheduler.getSleepMs();
+  loop_monitor.endIteration(micros(), sleep_ms);
+  sleeper.sleep(sleep_ms);
 }
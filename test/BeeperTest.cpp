@@ -2,86 +2,67 @@
 #include "Buzzer.h"
 #include <ArduinoFake.h>
 #include <doctest.h>
+#include <vector>
 
 using namespace fakeit;
 
 namespace {
 constexpr uint16_t LOW_FREQ = 800;
 constexpr uint16_t HIGH_FREQ = 1200;
-constexpr uint8_t TONE_DURATION_MS = 100;
+constexpr uint16_t TONE_DURATION_MS = 200;
+
+std::vector<uint16_t> getValues(const Pattern &pattern) {
+  std::vector<uint16_t> values;
+  for (size_t i = 0; i < pattern.size; ++i) {
+    CHECK(pattern.steps[i].duration_ms >= TONE_DURATION_MS);
+    values.push_back(pattern.steps[i].value);
+  }
+  return values;
+}
 } // namespace
 
 TEST_CASE("Beeper Logic") {
+  Mock<Clock> clock_mock;
   Mock<Buzzer> buzzer_mock;
-  Beeper beeper(buzzer_mock.get());
+  Context context{clock_mock.get(), Log};
+  Beeper beeper(context, buzzer_mock.get());
 
-  Fake(Method(buzzer_mock, enable));
-  Fake(Method(buzzer_mock, disable));
+  const Pattern *played = nullptr;
+  When(Method(buzzer_mock, play)).AlwaysDo([&](const Pattern &pattern) {
+    played = &pattern;
+  });
+  Fake(Method(buzzer_mock, stop));
 
-  SUBCASE("beep() is instantaneous") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+  SUBCASE("beep() hands the whole pattern over at once") {
     beeper.beep(Beeper::Signal::ACCEPT);
-    Verify(Method(buzzer_mock, enable).Using(LOW_FREQ)).Once();
-    beeper.update();
+    Verify(Method(buzzer_mock, play)).Once();
+    CHECK(played == &Beeper::getPattern(Beeper::Signal::ACCEPT));
     VerifyNoOtherInvocations(buzzer_mock);
+    VerifyNoOtherInvocations(clock_mock);
   }
 
   SUBCASE("beep(NONE) turns buzzer off") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
     beeper.beep(Beeper::Signal::ERROR);
-    Verify(Method(buzzer_mock, enable).Using(LOW_FREQ)).Once();
-
     beeper.beep(Beeper::Signal::NONE);
-    Verify(Method(buzzer_mock, disable)).Once();
+    Verify(Method(buzzer_mock, play), Method(buzzer_mock, stop)).Once();
   }
 
   SUBCASE("ACCEPT signal") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
-    beeper.beep(Beeper::Signal::ACCEPT);
-    Verify(Method(buzzer_mock, enable).Using(LOW_FREQ)).Once();
-
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + TONE_DURATION_MS);
-    beeper.update();
-    Verify(Method(buzzer_mock, enable).Using(HIGH_FREQ)).Once();
-
-    When(Method(ArduinoFake(), millis))
-        .AlwaysReturn(1000 + 2 * TONE_DURATION_MS);
-    beeper.update();
-    Verify(Method(buzzer_mock, disable)).Once();
+    const Pattern &pattern = Beeper::getPattern(Beeper::Signal::ACCEPT);
+    CHECK(getValues(pattern) == std::vector<uint16_t>{LOW_FREQ, HIGH_FREQ});
+    CHECK_FALSE(pattern.repeat);
   }
 
   SUBCASE("REJECT signal") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
-    beeper.beep(Beeper::Signal::REJECT);
-    Verify(Method(buzzer_mock, enable).Using(HIGH_FREQ)).Once();
-
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + TONE_DURATION_MS);
-    beeper.update();
-    Verify(Method(buzzer_mock, enable).Using(LOW_FREQ)).Once();
-
-    When(Method(ArduinoFake(), millis))
-        .AlwaysReturn(1000 + 2 * TONE_DURATION_MS);
-    beeper.update();
-    Verify(Method(buzzer_mock, disable)).Once();
+    const Pattern &pattern = Beeper::getPattern(Beeper::Signal::REJECT);
+    CHECK(getValues(pattern) == std::vector<uint16_t>{HIGH_FREQ, LOW_FREQ});
+    CHECK_FALSE(pattern.repeat);
   }
 
   SUBCASE("ERROR signal") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
-    beeper.beep(Beeper::Signal::ERROR);
-    Verify(Method(buzzer_mock, enable).Using(LOW_FREQ)).Once();
-
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + TONE_DURATION_MS);
-    beeper.update();
-    Verify(Method(buzzer_mock, disable)).Once();
-
-    When(Method(ArduinoFake(), millis))
-        .AlwaysReturn(1000 + 2 * TONE_DURATION_MS);
-    beeper.update();
-    Verify(Method(buzzer_mock, enable).Using(LOW_FREQ)).Twice();
-
-    When(Method(ArduinoFake(), millis))
-        .AlwaysReturn(1000 + 3 * TONE_DURATION_MS);
-    beeper.update();
-    Verify(Method(buzzer_mock, disable)).Twice();
+    const Pattern &pattern = Beeper::getPattern(Beeper::Signal::ERROR);
+    CHECK(getValues(pattern) ==
+          std::vector<uint16_t>{LOW_FREQ, 0, LOW_FREQ, 0});
+    CHECK(pattern.repeat);
   }
 }
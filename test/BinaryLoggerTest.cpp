@@ -0,0 +1,134 @@
+#include <doctest.h>
+#include "BinaryLogger.h"
+#include "LogDecoder.h"
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char kTemp[] = "Temp: ";
+const char kUnit[] = "°C\n";
+
+// Stands in for the firmware ELF.
+std::optional<std::string> resolve(uint32_t address) {
+  static const std::map<uint32_t, std::string> literals = {
+      {static_cast<uint32_t>(reinterpret_cast<uintptr_t>(kTemp)), kTemp},
+      {static_cast<uint32_t>(reinterpret_cast<uintptr_t>(kUnit)), kUnit},
+  };
+  auto it = literals.find(address);
+  if (it == literals.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::vector<uint8_t> drain(BinaryLogger &logger) {
+  std::vector<uint8_t> data;
+  uint8_t buffer[100];
+  while (size_t size = logger.read(buffer, sizeof(buffer))) {
+    data.insert(data.end(), buffer, buffer + size);
+  }
+  return data;
+}
+
+} // namespace
+
+TEST_CASE("BinaryLogger Logic") {
+  BinaryLogger logger;
+  LogDecoder decoder(resolve);
+  auto decode = [&](const std::vector<uint8_t> &data) {
+    return decoder.decode(data.data(), data.size());
+  };
+
+  SUBCASE("Round trip") {
+    char name[] = "FAKEPOT"; // Copied, not a literal
+    logger << kTemp << 21.5f << kUnit;
+    logger << name << -3 << kTemp << 7u;
+    CHECK(decode(drain(logger)) == "Temp: 21.50°C\nFAKEPOT-3Temp: 7");
+    CHECK(decoder.getErrorCount() == 0);
+  }
+
+  SUBCASE("Literals are stored by address") {
+    logger << kTemp;
+    // Tag, address, COBS overhead and delimiter.
+    CHECK(logger.available() == 7);
+  }
+
+  SUBCASE("Zero bytes in values are stuffed") {
+    logger << 0 << 256 << 0.0f << "\n";
+    std::vector<uint8_t> data = drain(logger);
+    CHECK(std::count(data.begin(), data.end(), 0) == 4);
+    CHECK(decode(data).find("0256") == 0);
+  }
+
+  SUBCASE("Long text is split into records") {
+    std::string text(200, 'x');
+    logger << text.c_str();
+    CHECK(decode(drain(logger)) == text);
+  }
+
+  SUBCASE("Unknown literal is shown by address") {
+    logger << "not in the ELF";
+    CHECK(decode(drain(logger)).find("<literal 0x") == 0);
+  }
+
+  SUBCASE("Decoder joins a stream mid-record") {
+    logger << 12345 << 678;
+    std::vector<uint8_t> data = drain(logger);
+    std::vector<uint8_t> tail(data.begin() + 2, data.end());
+    CHECK(decode(tail) == "678");
+    CHECK(decoder.getErrorCount() == 1);
+  }
+
+  SUBCASE("Records split across reads") {
+    logger << kTemp << 1.25f;
+    std::vector<uint8_t> data = drain(logger);
+    std::string text;
+    for (uint8_t byte : data) {
+      text += decoder.decode(&byte, 1);
+    }
+    CHECK(text == "Temp: 1.25");
+  }
+
+  SUBCASE("Full buffer drops and counts records") {
+    for (size_t i = 0; i < BinaryLogger::kCapacity; ++i) {
+      logger << 1;
+    }
+    std::string text = decode(drain(logger));
+    size_t kept = std::count(text.begin(), text.end(), '1');
+    CHECK(kept == text.size());
+
+    logger << 2;
+    CHECK(decode(drain(logger)) ==
+          "<" + std::to_string(BinaryLogger::kCapacity - kept) +
+              " records lost>2");
+  }
+
+  SUBCASE("Concurrent writers") {
+    constexpr int kRecords = 100;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&] {
+        for (int j = 0; j < kRecords; ++j) {
+          logger << 5;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    logger << 6;
+
+    std::string text = decode(drain(logger));
+    size_t kept = std::count(text.begin(), text.end(), '5');
+    size_t lost = 0;
+    if (size_t pos = text.find('<'); pos != std::string::npos) {
+      lost = std::stoul(text.substr(pos + 1));
+    }
+    CHECK(kept + lost == 4 * kRecords);
+    CHECK(text.back() == '6');
+    CHECK(decoder.getErrorCount() == 0);
+  }
+}
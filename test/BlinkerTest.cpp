@@ -1,70 +1,52 @@
 #include "Blinker.h"
-#include "DigitalWritePin.h"
+#include "Led.h"
 #include <ArduinoFake.h>
 #include <doctest.h>
 
 using namespace fakeit;
 
 TEST_CASE("Blinker Logic") {
-  Mock<DigitalWritePin> led_mock;
-  Blinker blinker(led_mock.get());
-
-  Fake(Method(led_mock, set));
-
-  SUBCASE("blink() is instantaneous") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+  Mock<Clock> clock_mock;
+  Mock<Led> led_mock;
+  Context context{clock_mock.get(), Log};
+  Blinker blinker(context, led_mock.get());
+
+  const Pattern *played = nullptr;
+  When(Method(led_mock, play)).AlwaysDo([&](const Pattern &pattern) {
+    played = &pattern;
+  });
+  Fake(Method(led_mock, stop));
+
+  SUBCASE("blink() hands the whole pattern over at once") {
     blinker.blink(Blinker::Signal::ONCE);
-    Verify(Method(led_mock, set).Using(PinState::Low)).Once();
-    blinker.update();
+    Verify(Method(led_mock, play)).Once();
+    CHECK(played == &Blinker::getPattern(Blinker::Signal::ONCE));
     VerifyNoOtherInvocations(led_mock);
   }
 
   SUBCASE("blink(NONE) turns led off") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
     blinker.blink(Blinker::Signal::REPEAT);
-    Verify(Method(led_mock, set).Using(PinState::Low)).Once();
-
     blinker.blink(Blinker::Signal::NONE);
-    Verify(Method(led_mock, set).Using(PinState::High)).Once();
+    Verify(Method(led_mock, play), Method(led_mock, stop)).Once();
   }
 
   SUBCASE("ONCE signal") {
-    // First, LED should be on
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
-    blinker.blink(Blinker::Signal::ONCE);
-    Verify(Method(led_mock, set).Using(PinState::Low)).Once();
-
-    // After 100ms, LED should be off and signal finished
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + 100);
-    blinker.update();
-    Verify(Method(led_mock, set).Using(PinState::High)).Once();
-
-    // After that, it should stay off
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + 200);
-    blinker.update();
-    VerifyNoOtherInvocations(led_mock);
+    // On for 100 ms, then off for good
+    const Pattern &pattern = Blinker::getPattern(Blinker::Signal::ONCE);
+    REQUIRE(pattern.size == 1);
+    CHECK(pattern.steps[0].duration_ms == 100);
+    CHECK(pattern.steps[0].value == Led::kOn);
+    CHECK_FALSE(pattern.repeat);
   }
 
   SUBCASE("REPEAT signal") {
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
-    blinker.blink(Blinker::Signal::REPEAT);
-
-    // First update, LED should be on for 100ms
-    Verify(Method(led_mock, set).Using(PinState::Low)).Once();
-
-    // After 100ms, LED should be off for 200ms
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + 100);
-    blinker.update();
-    Verify(Method(led_mock, set).Using(PinState::High)).Once();
-
-    // In the middle of the pause
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + 100 + 500);
-    blinker.update();
-    VerifyNoOtherInvocations(led_mock);
-
-    // After 1000ms pause, it should be on again
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000 + 100 + 1000);
-    blinker.update();
-    Verify(Method(led_mock, set).Using(PinState::Low)).Twice();
+    // On for 100 ms, off for 1000 ms, over and over
+    const Pattern &pattern = Blinker::getPattern(Blinker::Signal::REPEAT);
+    REQUIRE(pattern.size == 2);
+    CHECK(pattern.steps[0].duration_ms == 100);
+    CHECK(pattern.steps[0].value == Led::kOn);
+    CHECK(pattern.steps[1].duration_ms == 1000);
+    CHECK(pattern.steps[1].value == Led::kOff);
+    CHECK(pattern.repeat);
   }
 }
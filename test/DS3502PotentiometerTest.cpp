@@ -0,0 +1,99 @@
+#include <doctest.h>
+#include "DS3502Potentiometer.h"
+#include "NullLogger.h"
+#include "Scheduler.h"
+#include "SimulatedI2cBus.h"
+#include "VirtualClock.h"
+#include <vector>
+
+TEST_CASE("DS3502Potentiometer Logic") {
+  VirtualClock clock;
+  NullLogger log;
+  Context context{clock, log};
+  // A slow bus, 5 ms per write.
+  SimulatedI2cBus bus(clock, 5);
+  DS3502Potentiometer potentiometer(context, bus);
+
+  auto wait = [&](uint32_t duration_ms) {
+    for (uint32_t i = 0; i < duration_ms; ++i) {
+      clock.advance(1);
+      potentiometer.update();
+    }
+  };
+
+  potentiometer.begin();
+  wait(5);
+
+  SUBCASE("Writes the wiper register in volatile mode") {
+    REQUIRE(bus.getCompleted().size() == 1);
+    CHECK(bus.getCompleted()[0].address == 0x28);
+    CHECK(bus.getCompleted()[0].data == std::vector<uint8_t>{0x02, 0x80});
+
+    potentiometer.setValue(0.5f);
+    wait(5);
+    REQUIRE(bus.getCompleted().size() == 2);
+    CHECK(bus.getCompleted()[1].data == std::vector<uint8_t>{0x00, 63});
+    CHECK(potentiometer.isIdle());
+  }
+
+  SUBCASE("Does not wait for the bus") {
+    // The clock only moves between calls, so a blocking write would hang.
+    potentiometer.setValue(1.0f);
+    CHECK_FALSE(potentiometer.isIdle());
+    CHECK(bus.getStarted().size() == 2);
+    CHECK(bus.getCompleted().size() == 1);
+  }
+
+  SUBCASE("Collapses values set while busy into the newest") {
+    potentiometer.setValue(0.1f);
+    for (float value : {0.2f, 0.3f, 0.4f}) {
+      clock.advance(1);
+      potentiometer.setValue(value);
+    }
+    wait(10);
+    REQUIRE(bus.getCompleted().size() == 3);
+    CHECK(bus.getCompleted()[1].data[1] == 12);
+    CHECK(bus.getCompleted()[2].data[1] == 50);
+    CHECK(potentiometer.isIdle());
+  }
+
+  SUBCASE("Skips a value the device already has") {
+    potentiometer.setValue(0.5f);
+    wait(5);
+    potentiometer.setValue(0.5f);
+    CHECK(bus.getStarted().size() == 2);
+    CHECK(potentiometer.isIdle());
+  }
+
+  SUBCASE("Retries a failed write") {
+    bus.failNext(I2cBus::Status::kAddressNack);
+    potentiometer.setValue(0.5f);
+    wait(5);
+    CHECK(potentiometer.getErrorCount() == 1);
+    CHECK_FALSE(potentiometer.isIdle());
+
+    Scheduler scheduler(clock, 1000);
+    scheduler.begin();
+    potentiometer.schedule(scheduler);
+    CHECK(scheduler.getSleepMs() == 100);
+
+    wait(99);
+    CHECK(bus.getStarted().size() == 2);
+    wait(6);
+    REQUIRE(bus.getCompleted().size() == 2);
+    CHECK(bus.getCompleted()[1].data[1] == 63);
+    CHECK(potentiometer.isIdle());
+  }
+
+  SUBCASE("Polls while a write is in flight") {
+    Scheduler scheduler(clock, 1000);
+    scheduler.begin();
+    potentiometer.schedule(scheduler);
+    CHECK(scheduler.getSleepMs() == 1000);
+
+    potentiometer.setValue(0.5f);
+    scheduler.begin();
+    potentiometer.schedule(scheduler);
+    CHECK(scheduler.getSleepMs() == 1);
+  }
+}
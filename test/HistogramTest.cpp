@@ -0,0 +1,71 @@
+#include <doctest.h>
+#include "Histogram.h"
+
+TEST_CASE("Histogram Logic") {
+  Histogram histogram;
+
+  SUBCASE("Empty") {
+    CHECK(histogram.getCount() == 0);
+    CHECK(histogram.getMin() == 0);
+    CHECK(histogram.getMax() == 0);
+    CHECK(histogram.getMean() == 0.0f);
+    CHECK(histogram.getPercentile(0.99f) == 0);
+  }
+
+  SUBCASE("Buckets cover every value in order") {
+    for (size_t bucket = 0; bucket < Histogram::kBuckets; ++bucket) {
+      uint32_t min = Histogram::getBucketMin(bucket);
+      uint32_t max = Histogram::getBucketMax(bucket);
+      CHECK(Histogram::getBucket(min) == bucket);
+      CHECK(Histogram::getBucket(max) == bucket);
+      if (bucket > 0) {
+        CHECK(min == Histogram::getBucketMax(bucket - 1) + 1);
+      }
+      if (min >= 16) {
+        // Within 12.5% of the value.
+        CHECK(max - min < min / 8);
+      }
+    }
+    CHECK(Histogram::getBucketMax(Histogram::kBuckets - 1) == UINT32_MAX);
+  }
+
+  SUBCASE("Small values are exact") {
+    for (uint32_t value = 1; value <= 10; ++value) {
+      histogram.record(value);
+    }
+    CHECK(histogram.getCount() == 10);
+    CHECK(histogram.getMin() == 1);
+    CHECK(histogram.getMax() == 10);
+    CHECK(histogram.getMean() == doctest::Approx(5.5f));
+    CHECK(histogram.getPercentile(0.5f) == 5);
+    CHECK(histogram.getPercentile(0.9f) == 9);
+    CHECK(histogram.getPercentile(1.0f) == 10);
+  }
+
+  SUBCASE("Percentiles of a long tail") {
+    for (int i = 0; i < 990; ++i) {
+      histogram.record(1000);
+    }
+    for (int i = 0; i < 10; ++i) {
+      histogram.record(50000);
+    }
+    CHECK(histogram.getMin() == 1000);
+    CHECK(histogram.getMax() == 50000);
+    uint32_t p50 = histogram.getPercentile(0.5f);
+    CHECK(p50 >= 1000);
+    CHECK(p50 <= 1000 * 9 / 8);
+    CHECK(histogram.getPercentile(0.99f) == p50);
+    CHECK(histogram.getPercentile(0.999f) == 50000);
+    CHECK(histogram.getMean() ==
+          doctest::Approx(0.99f * 1000 + 0.01f * 50000).epsilon(0.07));
+  }
+
+  SUBCASE("Clear") {
+    histogram.record(UINT32_MAX);
+    histogram.clear();
+    CHECK(histogram.getCount() == 0);
+    histogram.record(7);
+    CHECK(histogram.getMin() == 7);
+    CHECK(histogram.getMax() == 7);
+  }
+}
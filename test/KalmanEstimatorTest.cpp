@@ -0,0 +1,84 @@
+#include <doctest.h>
+#include "KalmanEstimator.h"
+#include "VirtualClock.h"
+#include <cmath>
+
+TEST_CASE("KalmanEstimator Logic") {
+  VirtualClock clock;
+  Context context{clock, Log};
+  KalmanConfig config;
+  KalmanEstimator estimator(context, config);
+  float reading_variance = config.reading_noise * config.reading_noise;
+
+  SUBCASE("Initial state") {
+    CHECK(estimator.getEstimate().count == 0);
+    CHECK(estimator.getValue(0) == 0.0f);
+  }
+
+  SUBCASE("First reading") {
+    estimator.addReading(25.0f, 1000);
+    KalmanEstimator::Estimate estimate = estimator.getEstimate();
+    CHECK(estimate.last_update_ms == 1000);
+    CHECK(estimate.value == 25.0f);
+    CHECK(estimate.slope == 0.0f);
+    CHECK(estimate.value_variance ==
+          doctest::Approx(reading_variance).scale(0));
+    CHECK(estimate.count == 1);
+  }
+
+  SUBCASE("Tracks a ramp") {
+    // 1°C/s, one reading per second.
+    for (uint32_t t = 0; t <= 120 * 1000; t += 1000) {
+      estimator.addReading(20.0f + 0.001f * t, t);
+    }
+    KalmanEstimator::Estimate estimate = estimator.getEstimate();
+    CHECK(estimate.slope == doctest::Approx(0.001f).epsilon(0.02).scale(0));
+    CHECK(estimate.value == doctest::Approx(140.0f).epsilon(0.001));
+    CHECK(estimate.getValue(130 * 1000) ==
+          doctest::Approx(150.0f).epsilon(0.002));
+  }
+
+  SUBCASE("Averages noise on a constant") {
+    float previous_variance = INFINITY;
+    for (uint32_t i = 0; i < 60; ++i) {
+      estimator.addReading(i % 2 ? 50.05f : 49.95f, i * 1000);
+      CHECK(estimator.getEstimate().value_variance <= previous_variance);
+      previous_variance = estimator.getEstimate().value_variance;
+    }
+    KalmanEstimator::Estimate estimate = estimator.getEstimate();
+    CHECK(estimate.value == doctest::Approx(50.0f).epsilon(0.001));
+    CHECK(std::abs(estimate.slope) < 1e-5f);
+    CHECK(estimate.value_variance < reading_variance);
+    CHECK(estimate.slope_variance > 0.0f);
+  }
+
+  SUBCASE("Follows a change of slope") {
+    for (uint32_t t = 0; t <= 300 * 1000; t += 1000) {
+      estimator.addReading(20.0f, t);
+    }
+    for (uint32_t t = 301 * 1000; t <= 360 * 1000; t += 1000) {
+      estimator.addReading(20.0f + 0.0005f * (t - 300 * 1000), t);
+    }
+    CHECK(estimator.getSlope() ==
+          doctest::Approx(0.0005f).epsilon(0.1).scale(0));
+  }
+
+  SUBCASE("Ignores readings older than the last") {
+    estimator.addReading(10.0f, 2000);
+    estimator.addReading(90.0f, 1000);
+    CHECK(estimator.getEstimate().count == 1);
+    CHECK(estimator.getValue(2000) == 10.0f);
+  }
+
+  SUBCASE("Clear") {
+    estimator.addReading(10.0f, 1000);
+    estimator.addReading(20.0f, 2000);
+    estimator.clear();
+    CHECK(estimator.getEstimate().count == 0);
+    CHECK(estimator.getLastUpdateMs() == 0);
+
+    estimator.addReading(30.0f, 3000);
+    CHECK(estimator.getValue(3000) == 30.0f);
+    CHECK(estimator.getSlope() == 0.0f);
+  }
+}
@@ -0,0 +1,63 @@
+#include <doctest.h>
+#include "Logger.h"
+#include <string>
+
+namespace {
+
+class StringLogger final : public Logger {
+public:
+  void log(const char *msg, size_t length) override {
+    text.append(msg, length);
+  }
+  void log(long val) override { text += std::to_string(val); }
+  void log(unsigned long val) override { text += std::to_string(val); }
+  void log(float val) override { text += std::to_string(val); }
+
+  std::string text;
+};
+
+} // namespace
+
+TEST_CASE("Logger Levels") {
+  StringLogger logger;
+  int evaluations = 0;
+  auto value = [&] { return ++evaluations; };
+
+  SUBCASE("Everything is enabled by default") {
+    LOG_DEBUG(logger, kDial) << "dial " << value();
+    LOG_WARNING(logger, kBle) << ", ble";
+    CHECK(logger.text == "dial 1, ble");
+  }
+
+  SUBCASE("Runtime threshold skips the arguments") {
+    logger.setLevel(LogLevel::kInfo);
+    LOG_DEBUG(logger, kAnalyzer) << "reading " << value();
+    CHECK(logger.text.empty());
+    CHECK(evaluations == 0);
+
+    LOG_INFO(logger, kSupervisor) << "transition";
+    CHECK(logger.text == "transition");
+  }
+
+  SUBCASE("Per category threshold") {
+    logger.setLevel(LogLevel::kWarning);
+    logger.setLevel(LogCategory::kDial, LogLevel::kDebug);
+    LOG_INFO(logger, kSupervisor) << "transition";
+    LOG_DEBUG(logger, kDial) << "dial";
+    CHECK(logger.text == "dial");
+  }
+
+  SUBCASE("kNone disables everything") {
+    logger.setLevel(LogLevel::kNone);
+    LOG_WARNING(logger, kBle) << "failed";
+    CHECK(logger.text.empty());
+  }
+
+  SUBCASE("Binds like a single statement") {
+    if (evaluations == 0)
+      LOG_INFO(logger, kSystem) << "then";
+    else
+      LOG_INFO(logger, kSystem) << "else";
+    CHECK(logger.text == "then");
+  }
+}
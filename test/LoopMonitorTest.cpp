@@ -0,0 +1,73 @@
+#include <doctest.h>
+#include "LoopMonitor.h"
+
+namespace {
+
+uint32_t decode(const std::array<uint8_t, LoopMonitor::kEncodedSize> &data,
+                size_t histogram, size_t stat) {
+  size_t offset = (histogram * LoopMonitor::kStatsPerHistogram + stat) * 4;
+  return data[offset] | data[offset + 1] << 8 | data[offset + 2] << 16 |
+         static_cast<uint32_t>(data[offset + 3]) << 24;
+}
+
+} // namespace
+
+TEST_CASE("LoopMonitor Logic") {
+  LoopMonitor monitor;
+
+  SUBCASE("Iteration duration") {
+    monitor.beginIteration(1000);
+    monitor.endIteration(1250, 10);
+    CHECK(monitor.getDuration().getCount() == 1);
+    CHECK(monitor.getDuration().getMax() == 250);
+    // Nothing to compare the first wake with.
+    CHECK(monitor.getLateness().getCount() == 0);
+  }
+
+  SUBCASE("Lateness of timed wakes only") {
+    monitor.beginIteration(0);
+    monitor.endIteration(100, 10); // Wake due at 10100
+    monitor.beginIteration(10600);
+    monitor.endIteration(10700, 10); // Wake due at 20700
+    monitor.beginIteration(15000);   // Woken by an event
+    CHECK(monitor.getLateness().getCount() == 1);
+    CHECK(monitor.getLateness().getMax() == 500);
+  }
+
+  SUBCASE("Survives the microsecond wrap") {
+    monitor.beginIteration(UINT32_MAX - 99);
+    monitor.endIteration(100, 0);
+    monitor.beginIteration(110);
+    CHECK(monitor.getDuration().getMax() == 200);
+    CHECK(monitor.getLateness().getMax() == 10);
+  }
+
+  SUBCASE("Notification to actuation latency") {
+    monitor.addActuation(5000, 2000);
+    monitor.addActuation(5000, 4000);
+    CHECK(monitor.getLatency().getCount() == 2);
+    CHECK(monitor.getLatency().getMin() == 1000);
+    CHECK(monitor.getLatency().getMax() == 3000);
+  }
+
+  SUBCASE("Encoding") {
+    for (uint32_t i = 0; i < 100; ++i) {
+      monitor.beginIteration(i * 10000);
+      monitor.endIteration(i * 10000 + 1 + i % 10, 0);
+    }
+    monitor.addActuation(70000, 0);
+
+    auto data = monitor.encode();
+    CHECK(decode(data, 0, 0) == 100);
+    CHECK(decode(data, 0, 1) == 1);
+    CHECK(decode(data, 0, 2) == 5);
+    CHECK(decode(data, 0, 3) == 10);
+    CHECK(decode(data, 0, 4) == 10);
+    CHECK(decode(data, 1, 0) == 99);
+    CHECK(decode(data, 2, 0) == 1);
+    CHECK(decode(data, 2, 4) == 70000);
+
+    monitor.clear();
+    CHECK(decode(monitor.encode(), 0, 0) == 0);
+  }
+}
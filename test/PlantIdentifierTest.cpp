@@ -0,0 +1,80 @@
+#include <doctest.h>
+#include "PlantIdentifier.h"
+#include <vector>
+
+namespace {
+
+constexpr float kAmbient = 20.0f;
+
+// Feeds one reading every `period_ms` from an exact first-order-plus-dead-
+// time plant, switching power every five minutes.
+void runPlant(PlantIdentifier &identifier, const PlantModel &plant,
+              uint32_t duration_ms, uint32_t period_ms = 1000) {
+  float temp = kAmbient;
+  std::vector<float> powers;
+  for (uint32_t t = 0; t < duration_ms; t += period_ms) {
+    float power = (t / (300 * 1000)) % 2 ? 0.2f : 0.6f;
+    powers.push_back(power);
+    float delayed_power =
+        t >= plant.dead_time_ms
+            ? powers[(t - plant.dead_time_ms) / period_ms]
+            : 0.0f;
+    float slope = (plant.gain * delayed_power - (temp - kAmbient)) /
+                  plant.time_constant_ms;
+    identifier.addSample(t, temp, slope, power);
+    temp += slope * period_ms;
+  }
+}
+
+} // namespace
+
+TEST_CASE("PlantIdentifier Logic") {
+  PlantIdentifier identifier(kAmbient);
+  PlantModel plant{200.0f, 1000.0f * 1000, 20000};
+
+  SUBCASE("Invalid without samples") {
+    CHECK_FALSE(identifier.isValid());
+    CHECK(identifier.getModel().gain == 0.0f);
+  }
+
+  SUBCASE("Invalid after too few samples") {
+    runPlant(identifier, plant, 60 * 1000);
+    CHECK_FALSE(identifier.isValid());
+  }
+
+  SUBCASE("Identifies the plant") {
+    runPlant(identifier, plant, 60 * 60 * 1000);
+    REQUIRE(identifier.isValid());
+    PlantModel model = identifier.getModel();
+    CHECK(model.gain == doctest::Approx(plant.gain).epsilon(0.05));
+    CHECK(model.time_constant_ms ==
+          doctest::Approx(plant.time_constant_ms).epsilon(0.05));
+    CHECK(model.dead_time_ms == plant.dead_time_ms);
+  }
+
+  SUBCASE("Picks the dead time") {
+    plant.dead_time_ms = 45000;
+    runPlant(identifier, plant, 60 * 60 * 1000);
+    REQUIRE(identifier.isValid());
+    CHECK(identifier.getModel().dead_time_ms == 45000);
+  }
+
+  SUBCASE("Picks a long dead time at two readings per second") {
+    plant.dead_time_ms = 60000;
+    runPlant(identifier, plant, 60 * 60 * 1000, 500);
+    REQUIRE(identifier.isValid());
+    CHECK(identifier.getModel().dead_time_ms == 60000);
+  }
+
+  SUBCASE("Reset forgets the plant") {
+    runPlant(identifier, plant, 60 * 60 * 1000);
+    identifier.reset();
+    CHECK_FALSE(identifier.isValid());
+  }
+
+  SUBCASE("Rejects a cooling plant") {
+    plant.gain = -100.0f;
+    runPlant(identifier, plant, 60 * 60 * 1000);
+    CHECK_FALSE(identifier.isValid());
+  }
+}
@@ -0,0 +1,111 @@
+#include <doctest.h>
+#include "FakeGattClient.h"
+#include "GattHandleCache.h"
+#include "ProbeConnector.h"
+
+using Result = ProbeConnector::Result;
+
+namespace {
+
+PeerAddress makeAddress(uint8_t last) {
+  PeerAddress address;
+  address.type = 1;
+  address.bytes = {1, 2, 3, 4, 5, last};
+  return address;
+}
+
+constexpr ProbeHandles kHandles = {0x0012, 0x0013};
+
+} // namespace
+
+TEST_CASE("ProbeConnector Logic") {
+  ProbeConnector connector;
+  PeerAddress address = makeAddress(6);
+
+  SUBCASE("Discovers a new probe") {
+    FakeGattClient probe(kHandles);
+    CHECK(connector.connect(probe, address) == Result::kDiscovered);
+    CHECK(probe.is_subscribed);
+    CHECK(probe.discover_count == 1);
+  }
+
+  SUBCASE("Reconnects without discovery") {
+    FakeGattClient first(kHandles);
+    connector.connect(first, address);
+
+    FakeGattClient again(kHandles);
+    CHECK(connector.connect(again, address) == Result::kCached);
+    CHECK(again.is_subscribed);
+    CHECK(again.discover_count == 0);
+    CHECK(again.round_trips == 1);
+    CHECK(first.round_trips > 4 * again.round_trips);
+  }
+
+  SUBCASE("Falls back to discovery when the handles moved") {
+    FakeGattClient before(kHandles);
+    connector.connect(before, address);
+
+    FakeGattClient updated({0x0020, 0x0021});
+    CHECK(connector.connect(updated, address) == Result::kDiscovered);
+    CHECK(updated.is_subscribed);
+    CHECK(updated.discover_count == 1);
+
+    // And caches the new ones.
+    FakeGattClient again({0x0020, 0x0021});
+    CHECK(connector.connect(again, address) == Result::kCached);
+  }
+
+  SUBCASE("Keeps addresses apart") {
+    FakeGattClient first(kHandles);
+    connector.connect(first, address);
+    FakeGattClient other(kHandles);
+    CHECK(connector.connect(other, makeAddress(7)) == Result::kDiscovered);
+  }
+
+  SUBCASE("Does not cache what it refuses") {
+    FakeGattClient stranger(kHandles, /*is_supported=*/false);
+    CHECK(connector.connect(stranger, address) == Result::kNotSupported);
+    CHECK_FALSE(stranger.is_subscribed);
+    CHECK(connector.connect(stranger, address) == Result::kNotSupported);
+    CHECK(stranger.discover_count == 2);
+  }
+
+  SUBCASE("No temperature characteristic") {
+    FakeGattClient other({0, 0});
+    CHECK(connector.connect(other, address) == Result::kNotFound);
+  }
+}
+
+TEST_CASE("GattHandleCache Logic") {
+  GattHandleCache cache;
+  ProbeHandles handles;
+
+  SUBCASE("Finds what it stored") {
+    CHECK_FALSE(cache.find(makeAddress(1), &handles));
+    cache.store(makeAddress(1), kHandles);
+    REQUIRE(cache.find(makeAddress(1), &handles));
+    CHECK(handles.value_handle == kHandles.value_handle);
+    CHECK(handles.cccd_handle == kHandles.cccd_handle);
+
+    cache.erase(makeAddress(1));
+    CHECK_FALSE(cache.find(makeAddress(1), &handles));
+  }
+
+  SUBCASE("Tells address types apart") {
+    cache.store(makeAddress(1), kHandles);
+    PeerAddress public_address = makeAddress(1);
+    public_address.type = 0;
+    CHECK_FALSE(cache.find(public_address, &handles));
+  }
+
+  SUBCASE("Evicts the least recently used") {
+    for (uint8_t i = 0; i < GattHandleCache::kMaxPeers; ++i) {
+      cache.store(makeAddress(i), kHandles);
+    }
+    CHECK(cache.find(makeAddress(0), &handles));
+    cache.store(makeAddress(100), kHandles);
+    CHECK(cache.find(makeAddress(0), &handles));
+    CHECK_FALSE(cache.find(makeAddress(1), &handles));
+    CHECK(cache.find(makeAddress(100), &handles));
+  }
+}
@@ -0,0 +1,128 @@
+#include <doctest.h>
+#include "NullLogger.h"
+#include "ProbeFeed.h"
+#include "VirtualClock.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+PeerAddress makeAddress(uint8_t last) {
+  PeerAddress address;
+  address.bytes = {1, 2, 3, 4, 5, last};
+  return address;
+}
+
+const PeerAddress kProbeA = makeAddress(0xA);
+const PeerAddress kProbeB = makeAddress(0xB);
+
+// Keeps what reaches the sink, in order.
+class RecordingSink final : public ProbeSink {
+public:
+  void addProbe(size_t probe, const PeerAddress &address) override {
+    events.push_back("add " + std::to_string(probe) + " " +
+                     std::to_string(address.bytes[5]));
+  }
+  void addReading(size_t probe, float value, uint32_t) override {
+    events.push_back("reading " + std::to_string(probe) + " " +
+                     std::to_string(static_cast<int>(value)));
+  }
+  void removeProbe(size_t probe) override {
+    events.push_back("remove " + std::to_string(probe));
+  }
+
+  std::vector<std::string> events;
+};
+
+} // namespace
+
+TEST_CASE("ProbeFeed Logic") {
+  VirtualClock clock;
+  NullLogger log;
+  Context context{clock, log};
+  RecordingSink sink;
+  ProbeFeed feed(context, sink);
+  using Events = std::vector<std::string>;
+
+  auto reading = [](size_t probe, const PeerAddress &address, float temp,
+                    uint32_t received_us = 0) {
+    return ProbeFeed::Reading{static_cast<uint8_t>(probe), address, temp, 0,
+                              received_us};
+  };
+
+  SUBCASE("Names a probe before its first reading") {
+    feed.addReading(reading(1, kProbeA, 60.0f, 100));
+    feed.addReading(reading(1, kProbeA, 61.0f, 200));
+    uint32_t received_us = 0;
+    uint32_t dropped = 1;
+    CHECK(feed.update(&received_us, &dropped));
+    CHECK(sink.events == Events{"add 1 10", "reading 1 60", "reading 1 61"});
+    CHECK(received_us == 100);
+    CHECK(dropped == 0);
+
+    CHECK_FALSE(feed.update());
+  }
+
+  SUBCASE("Leaves out readings queued before a dropout") {
+    feed.addReading(reading(0, kProbeA, 60.0f));
+    feed.update();
+    sink.events.clear();
+
+    feed.addReading(reading(0, kProbeA, 61.0f));
+    feed.dropProbe(0);
+    uint32_t dropped = 0;
+    CHECK_FALSE(feed.update(nullptr, &dropped));
+    CHECK(sink.events == Events{"remove 0"});
+    CHECK(dropped == 1);
+
+    // Another probe on the same link is named anew.
+    feed.addReading(reading(0, kProbeB, 40.0f));
+    feed.update();
+    CHECK(sink.events == Events{"remove 0", "add 0 11", "reading 0 40"});
+  }
+
+  SUBCASE("Names a probe again after its dropout") {
+    feed.addReading(reading(0, kProbeA, 60.0f));
+    feed.update();
+    feed.dropProbe(0);
+    feed.update();
+    feed.addReading(reading(0, kProbeA, 62.0f));
+    feed.update();
+    CHECK(sink.events == Events{"add 0 10", "reading 0 60", "remove 0",
+                                "add 0 10", "reading 0 62"});
+  }
+
+  SUBCASE("Keeps the other links through a dropout") {
+    feed.addReading(reading(0, kProbeA, 60.0f));
+    feed.addReading(reading(1, kProbeB, 40.0f));
+    feed.update();
+    sink.events.clear();
+
+    feed.addReading(reading(0, kProbeA, 61.0f));
+    feed.addReading(reading(1, kProbeB, 41.0f));
+    feed.dropProbe(0);
+    feed.update();
+    CHECK(sink.events == Events{"remove 0", "reading 1 41"});
+  }
+
+  SUBCASE("Tells the sink nothing of a probe it never named") {
+    feed.addReading(reading(0, kProbeA, 60.0f));
+    feed.dropProbe(0);
+    feed.update();
+    CHECK(sink.events.empty());
+  }
+
+  SUBCASE("Ignores unknown links") {
+    feed.addReading(reading(ProbeFeed::kMaxProbes, kProbeA, 60.0f));
+    feed.dropProbe(ProbeFeed::kMaxProbes);
+    CHECK_FALSE(feed.update());
+    CHECK(sink.events.empty());
+  }
+
+  SUBCASE("Counts readings lost to a full queue") {
+    for (int i = 0; i < 10; ++i) {
+      feed.addReading(reading(0, kProbeA, 60.0f));
+    }
+    CHECK(feed.getOverflowCount() == 2);
+  }
+}
@@ -0,0 +1,141 @@
+#include <doctest.h>
+#include "NullLogger.h"
+#include "ProbeFusion.h"
+#include "VirtualClock.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Keeps the fused readings.
+class RecordingEstimator final : public TemperatureEstimator {
+public:
+  void addReading(float value, uint32_t time_ms) override {
+    readings.push_back(value);
+    estimate_.last_update_ms = time_ms;
+    estimate_.value = value;
+    ++estimate_.count;
+  }
+  void clear() override { readings.clear(); }
+  Estimate getEstimate() const override { return estimate_; }
+
+  std::vector<float> readings;
+
+private:
+  Estimate estimate_;
+};
+
+float getDeviation(const std::vector<float> &values, float mean) {
+  float sum = 0.0f;
+  for (float value : values) {
+    sum += (value - mean) * (value - mean);
+  }
+  return std::sqrt(sum / values.size());
+}
+
+} // namespace
+
+TEST_CASE("ProbeFusion Logic") {
+  VirtualClock clock;
+  NullLogger log;
+  Context context{clock, log};
+  FusionConfig config;
+  RecordingEstimator estimator;
+  ProbeFusion fusion(context, estimator, config);
+
+  SUBCASE("Passes a single probe through") {
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    for (uint32_t t = 0; t < 100 * 1000; t += 1000) {
+      float value = 40.0f + 0.0005f * t + noise(rng);
+      fusion.addReading(1, value, t);
+      REQUIRE(estimator.readings.back() == value);
+    }
+    CHECK(fusion.getProbeCount(100 * 1000) == 1);
+  }
+
+  SUBCASE("Averages the noise of two probes") {
+    std::mt19937 rng(2);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    std::vector<float> single;
+    for (uint32_t t = 0; t < 600 * 1000; t += 1000) {
+      float value = 60.0f + noise(rng);
+      single.push_back(value);
+      fusion.addReading(0, value, t);
+      fusion.addReading(1, 60.0f + noise(rng), t + 500);
+    }
+    std::vector<float> fused(estimator.readings.begin() + 100,
+                             estimator.readings.end());
+    CHECK(getDeviation(fused, 60.0f) < 0.85f * getDeviation(single, 60.0f));
+  }
+
+  SUBCASE("Weights the quieter probe more") {
+    std::mt19937 rng(3);
+    std::normal_distribution<float> quiet(0.0f, 0.05f);
+    std::normal_distribution<float> loud(0.0f, 0.5f);
+    for (uint32_t t = 0; t < 600 * 1000; t += 1000) {
+      fusion.addReading(0, 60.0f + quiet(rng), t);
+      fusion.addReading(1, 60.0f + loud(rng), t + 500);
+    }
+    std::vector<float> fused(estimator.readings.end() - 200,
+                             estimator.readings.end());
+    CHECK(getDeviation(fused, 60.0f) < 0.15f);
+  }
+
+  SUBCASE("Settles between probes that disagree") {
+    for (uint32_t t = 0; t < 1200 * 1000; t += 1000) {
+      fusion.addReading(0, 60.0f, t);
+      fusion.addReading(1, 64.0f, t + 500);
+    }
+    CHECK(estimator.readings.back() == doctest::Approx(62.0f).epsilon(0.005));
+  }
+
+  SUBCASE("Joins without a step") {
+    for (uint32_t t = 0; t < 10 * 1000; t += 1000) {
+      fusion.addReading(0, 60.0f, t);
+    }
+    fusion.addReading(1, 64.0f, 10 * 1000);
+    CHECK(estimator.readings.back() == doctest::Approx(60.0f).epsilon(0.001));
+  }
+
+  SUBCASE("Survives a probe dropping out") {
+    uint32_t t = 0;
+    for (; t < 1200 * 1000; t += 1000) {
+      fusion.addReading(0, 60.0f, t);
+      fusion.addReading(1, 64.0f, t + 500);
+    }
+    float before = estimator.readings.back();
+    fusion.removeProbe(1);
+    float largest_step = 0.0f;
+    for (uint32_t end = t + 60 * 1000; t < end; t += 1000) {
+      float last = estimator.readings.back();
+      fusion.addReading(0, 60.0f, t);
+      largest_step =
+          std::max(largest_step, std::fabs(estimator.readings.back() - last));
+    }
+    CHECK(fusion.getProbeCount(t) == 1);
+    CHECK(std::fabs(estimator.readings.back() - before) < 2.0f);
+    CHECK(largest_step < 0.05f);
+  }
+
+  SUBCASE("Leaves out a silent probe") {
+    fusion.addReading(0, 60.0f, 0);
+    fusion.addReading(1, 60.0f, 0);
+    CHECK(fusion.getProbeCount(config.timeout_ms) == 2);
+    CHECK(fusion.getProbeCount(config.timeout_ms + 1) == 0);
+
+    // Fades out as its last reading ages, while the other rises by 1°C.
+    for (uint32_t t = 1000; t <= config.timeout_ms / 2; t += 1000) {
+      fusion.addReading(0, 60.0f + t / (config.timeout_ms / 2.0f), t);
+    }
+    float with_stale = estimator.readings.back();
+    CHECK(with_stale > 60.8f);
+    CHECK(with_stale < 61.0f);
+  }
+
+  SUBCASE("Ignores unknown probes") {
+    fusion.addReading(ProbeFusion::kMaxProbes, 60.0f, 0);
+    CHECK(estimator.readings.empty());
+  }
+}
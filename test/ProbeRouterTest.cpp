@@ -0,0 +1,238 @@
+#include <doctest.h>
+#include "NullLogger.h"
+#include "ProbeRouter.h"
+#include "VirtualClock.h"
+#include <vector>
+
+namespace {
+
+PeerAddress makeAddress(uint8_t last) {
+  PeerAddress address;
+  address.bytes = {1, 2, 3, 4, 5, last};
+  return address;
+}
+
+const PeerAddress kProbeA = makeAddress(0xA);
+const PeerAddress kProbeB = makeAddress(0xB);
+const PeerAddress kProbeC = makeAddress(0xC);
+
+// Keeps what reaches one zone.
+class RecordingSink final : public ProbeSink {
+public:
+  void addProbe(size_t probe, const PeerAddress &) override {
+    added.push_back(probe);
+  }
+  void addReading(size_t probe, float value, uint32_t) override {
+    readings.push_back({probe, value});
+  }
+  void removeProbe(size_t probe) override { removed.push_back(probe); }
+
+  struct Reading {
+    size_t probe;
+    float value;
+  };
+  std::vector<size_t> added;
+  std::vector<Reading> readings;
+  std::vector<size_t> removed;
+};
+
+class SharedThermometer final : public Thermometer {
+public:
+  void start() override { ++start_count, is_started = true; }
+  void stop() override { ++stop_count, is_started = false; }
+  bool connected() override { return is_started; }
+
+  int start_count = 0;
+  int stop_count = 0;
+  bool is_started = false;
+};
+
+} // namespace
+
+TEST_CASE("ProbeRouter Logic") {
+  VirtualClock clock;
+  NullLogger log;
+  Context context{clock, log};
+  SharedThermometer shared;
+  ProbeRouter router(context, shared);
+  RecordingSink sinks[2];
+  router.setProbes(0, sinks[0]);
+  router.setProbes(1, sinks[1]);
+  Thermometer &zone0 = router.getThermometer(0);
+  Thermometer &zone1 = router.getThermometer(1);
+
+  SUBCASE("Starts the thermometer while any zone is started") {
+    zone0.start();
+    zone1.start();
+    CHECK(shared.start_count == 1);
+    zone0.stop();
+    CHECK(shared.stop_count == 0);
+    zone1.stop();
+    CHECK(shared.stop_count == 1);
+    zone1.stop();
+    CHECK(shared.stop_count == 1);
+  }
+
+  SUBCASE("Drops readings no zone wants") {
+    router.addProbe(0, kProbeA);
+    router.addReading(0, 60.0f, 0);
+    CHECK(router.getZone(0) == ProbeRouter::kNoZone);
+    CHECK(sinks[0].readings.empty());
+    CHECK_FALSE(zone0.connected());
+  }
+
+  SUBCASE("Drops readings of links without a probe") {
+    zone0.start();
+    router.addReading(0, 60.0f, 0);
+    CHECK(router.getZone(0) == ProbeRouter::kNoZone);
+    CHECK(sinks[0].readings.empty());
+  }
+
+  SUBCASE("Gives a new probe to the zone searching") {
+    zone1.start();
+    router.addProbe(2, kProbeA);
+    router.addReading(2, 60.0f, 0);
+    CHECK(router.getZone(2) == 1);
+    CHECK(zone1.connected());
+    CHECK_FALSE(zone0.connected());
+    CHECK(sinks[1].added == std::vector<size_t>{2});
+    REQUIRE(sinks[1].readings.size() == 1);
+    CHECK(sinks[1].readings[0].probe == 2);
+
+    // The next zone to start gets the next probe.
+    zone0.start();
+    router.addProbe(0, kProbeB);
+    router.addReading(0, 40.0f, 1000);
+    router.addReading(2, 61.0f, 1000);
+    CHECK(router.getZone(0) == 0);
+    CHECK(sinks[0].readings.size() == 1);
+    CHECK(sinks[1].readings.size() == 2);
+
+    // No zone is left searching: a third probe is ignored.
+    router.addProbe(1, kProbeC);
+    router.addReading(1, 20.0f, 2000);
+    CHECK(router.getZone(1) == ProbeRouter::kNoZone);
+  }
+
+  SUBCASE("Holds a new probe while several zones search") {
+    zone0.start();
+    zone1.start();
+    router.addProbe(0, kProbeA);
+    router.addReading(0, 60.0f, 0);
+    CHECK(router.getZone(0) == ProbeRouter::kNoZone);
+    CHECK(sinks[0].readings.empty());
+    CHECK(sinks[1].readings.empty());
+
+    zone1.stop();
+    router.addReading(0, 60.0f, 1000);
+    CHECK(router.getZone(0) == 0);
+    CHECK(sinks[0].readings.size() == 1);
+  }
+
+  SUBCASE("Gives a returning probe back to its zone") {
+    zone0.start();
+    router.addProbe(0, kProbeA);
+    zone1.start();
+    router.addProbe(1, kProbeB);
+    REQUIRE(router.getZone(0) == 0);
+    REQUIRE(router.getZone(1) == 1);
+
+    // Both drop out, and come back on each other's links.
+    router.removeProbe(0);
+    router.removeProbe(1);
+    router.addProbe(0, kProbeB);
+    router.addReading(0, 70.0f, 1000);
+    CHECK(router.getZone(0) == 1);
+    REQUIRE(sinks[1].readings.size() == 1);
+    CHECK(sinks[1].readings[0].value == 70.0f);
+    CHECK(sinks[0].readings.empty());
+
+    router.addProbe(1, kProbeA);
+    router.addReading(1, 50.0f, 2000);
+    CHECK(router.getZone(1) == 0);
+    REQUIRE(sinks[0].readings.size() == 1);
+    CHECK(sinks[0].readings[0].value == 50.0f);
+  }
+
+  SUBCASE("Gives a stranger to the one zone still searching") {
+    zone0.start();
+    router.addProbe(0, kProbeA);
+    zone1.start();
+    router.addProbe(1, kProbeB);
+
+    // Zone 0's probe is replaced; zone 1 keeps its own.
+    router.removeProbe(0);
+    router.addProbe(0, kProbeC);
+    CHECK(router.getZone(0) == 0);
+
+    // The old probe now belongs to nobody.
+    router.removeProbe(1);
+    router.addProbe(1, kProbeA);
+    CHECK(router.getZone(1) == 1);
+  }
+
+  SUBCASE("Keeps a stopped zone's probe for it") {
+    zone0.start();
+    router.addProbe(0, kProbeA);
+    router.addReading(0, 60.0f, 0);
+    zone0.stop();
+    CHECK(sinks[0].removed == std::vector<size_t>{0});
+
+    zone1.start();
+    router.addReading(0, 60.0f, 1000);
+    CHECK(router.getZone(0) == 0);
+    CHECK(sinks[1].readings.empty());
+    CHECK(sinks[0].readings.size() == 1);
+
+    zone0.start();
+    router.addReading(0, 60.0f, 2000);
+    CHECK(sinks[0].readings.size() == 2);
+  }
+
+  SUBCASE("Frees a probe that disconnects") {
+    zone0.start();
+    router.addProbe(0, kProbeA);
+    router.addReading(0, 60.0f, 0);
+    router.removeProbe(0);
+    CHECK(sinks[0].removed == std::vector<size_t>{0});
+    CHECK(router.getZone(0) == ProbeRouter::kNoZone);
+    CHECK_FALSE(zone0.connected());
+
+    // Its zone is gone, so it goes where it is needed.
+    zone0.stop();
+    zone1.start();
+    router.addProbe(0, kProbeA);
+    CHECK(router.getZone(0) == 1);
+  }
+
+  SUBCASE("Keeps a late reading from taking a lost probe back") {
+    zone0.start();
+    router.addProbe(0, kProbeA);
+    router.removeProbe(0);
+    router.addReading(0, 60.0f, 1000);
+    CHECK(router.getZone(0) == ProbeRouter::kNoZone);
+    CHECK(sinks[0].readings.empty());
+    CHECK_FALSE(zone0.connected());
+
+    // So the zone still searches, and takes a replacement.
+    router.addProbe(1, kProbeB);
+    CHECK(router.getZone(1) == 0);
+  }
+
+  SUBCASE("Gives no probes to zones without a sink") {
+    router.getThermometer(2).start();
+    router.addProbe(0, kProbeA);
+    router.addReading(0, 60.0f, 0);
+    CHECK(router.getZone(0) == ProbeRouter::kNoZone);
+    CHECK(shared.is_started);
+  }
+
+  SUBCASE("Ignores unknown probes") {
+    zone0.start();
+    router.addProbe(ProbeRouter::kMaxProbes, kProbeA);
+    router.addReading(ProbeRouter::kMaxProbes, 60.0f, 0);
+    router.removeProbe(ProbeRouter::kMaxProbes);
+    CHECK(sinks[0].readings.empty());
+    CHECK(router.getZone(ProbeRouter::kMaxProbes) == ProbeRouter::kNoZone);
+  }
+}
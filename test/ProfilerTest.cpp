@@ -0,0 +1,68 @@
+#include <doctest.h>
+#define KRC_PROFILE
+#include "Profiler.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+
+class StringLogger final : public Logger {
+public:
+  void log(const char *msg, size_t length) override { text.append(msg, length); }
+  void log(long val) override { text += std::to_string(val); }
+  void log(unsigned long val) override { text += std::to_string(val); }
+  void log(float val) override { text += std::to_string(val); }
+  std::string text;
+};
+
+void sleepyFunction() {
+  PROFILE_SCOPE("sleepyFunction");
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+const Profiler::Scope *findScope(const char *name) {
+  for (size_t i = 0; i < Profiler::getScopeCount(); ++i) {
+    const Profiler::Scope *scope = Profiler::getScope(i);
+    if (scope && std::string(scope->name.load()) == name) {
+      return scope;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("Profiler Logic") {
+  Profiler::clear();
+
+  SUBCASE("Times a scope") {
+    sleepyFunction();
+    sleepyFunction();
+    const Profiler::Scope *scope = findScope("sleepyFunction");
+    REQUIRE(scope);
+    CHECK(scope->ticks.getCount() == 2);
+    // Nanoseconds on the host.
+    CHECK(scope->ticks.getMin() >= 2000000);
+    CHECK(scope->ticks.getMax() < 1000000000);
+
+    StringLogger out;
+    Profiler::dump(out, 1000);
+    CHECK(out.text.find("sleepyFunction: 2 ") != std::string::npos);
+  }
+
+  SUBCASE("Registers a scope once") {
+    sleepyFunction();
+    size_t count = Profiler::getScopeCount();
+    sleepyFunction();
+    CHECK(Profiler::getScopeCount() == count);
+  }
+
+  SUBCASE("Ignores scopes beyond the table") {
+    while (Profiler::getScopeCount() < Profiler::kMaxScopes) {
+      CHECK(Profiler::registerScope("filler"));
+    }
+    CHECK(Profiler::registerScope("one too many") == nullptr);
+    ProfileTimer timer(nullptr);
+  }
+}
@@ -0,0 +1,105 @@
+#include <doctest.h>
+#include "Beeper.h"
+#include "Blinker.h"
+#include "PwmSequence.h"
+#include <array>
+
+namespace {
+
+constexpr size_t kCapacity = 128;
+
+bool isSilent(const PwmEntry &entry) {
+  // Channel 0 never rises, channel 1 never falls.
+  return (entry.compare[0] & ~kPwmFallingEdge) > entry.top &&
+         entry.compare[1] == kPwmFallingEdge;
+}
+
+} // namespace
+
+TEST_CASE("PwmSequence Tones") {
+  std::array<PwmEntry, kCapacity> entries;
+
+  SUBCASE("Tones keep their pitch and duration") {
+    constexpr auto steps = loop(hold(800, 200), hold(1200, 200));
+    size_t size = compileTones(steps.get(), entries.data(),
+                               entries.size());
+    REQUIRE(size == 40);
+    CHECK(entries[0].top == 10000);
+    CHECK(entries[0].compare[0] == 5000);
+    CHECK(entries[0].compare[1] == (5000 | kPwmFallingEdge));
+    CHECK(getPwmDurationUs(entries.data(), 16) == 200000);
+    CHECK(entries[16].top == 6667);
+    CHECK(getPwmDurationUs(&entries[16], 24) == doctest::Approx(200000).epsilon(0.001));
+  }
+
+  SUBCASE("Silence is exact at any duration") {
+    constexpr auto steps = loop(hold(0, 1000), hold(0, 7));
+    size_t size = compileTones(steps.get(), entries.data(),
+                               entries.size());
+    REQUIRE(size > 0);
+    for (size_t i = 0; i < size; ++i) {
+      CHECK(isSilent(entries[i]));
+    }
+    CHECK(getPwmDurationUs(entries.data(), size) == 1007000);
+  }
+
+  SUBCASE("Ends silent unless it repeats") {
+    constexpr auto steps = once(hold(800, 200));
+    size_t size = compileTones(steps.get(), entries.data(),
+                               entries.size());
+    REQUIRE(size == 17);
+    CHECK_FALSE(isSilent(entries[15]));
+    CHECK(isSilent(entries[16]));
+  }
+
+  SUBCASE("Fails rather than truncate") {
+    constexpr auto steps = once(hold(1200, 2000));
+    CHECK(compileTones(steps.get(), entries.data(),
+                       entries.size()) == 0);
+    constexpr auto low = once(hold(100, 200));
+    CHECK(compileTones(low.get(), entries.data(),
+                       entries.size()) == 0);
+  }
+
+  SUBCASE("Every beep fits and lasts as long as its pattern") {
+    for (auto signal : {Beeper::Signal::ACCEPT, Beeper::Signal::REJECT,
+                        Beeper::Signal::ERROR}) {
+      const Pattern &pattern = Beeper::getPattern(signal);
+      size_t size = compileTones(pattern, entries.data(), entries.size());
+      REQUIRE(size > 0);
+      uint64_t duration_us = 0;
+      for (size_t i = 0; i < pattern.size; ++i) {
+        duration_us += pattern.steps[i].duration_ms * 1000;
+      }
+      size_t played = pattern.repeat ? size : size - 1;
+      CHECK(getPwmDurationUs(entries.data(), played) ==
+            doctest::Approx(duration_us).epsilon(0.001));
+    }
+  }
+}
+
+TEST_CASE("PwmSequence Brightness") {
+  std::array<PwmEntry, kCapacity> entries;
+
+  SUBCASE("Levels") {
+    constexpr auto steps =
+        loop(hold(Led::kOn, 10), hold(Led::kOff, 10), hold(128, 10));
+    size_t size = compileBrightness(steps.get(), entries.data(),
+                                    entries.size());
+    REQUIRE(size == 3);
+    // Lit while low, which a compare value beyond the top keeps it.
+    CHECK(entries[0].compare[0] > entries[0].top);
+    CHECK(entries[1].compare[0] == 0);
+    CHECK(entries[2].compare[0] == doctest::Approx(entries[2].top / 2).epsilon(0.01));
+  }
+
+  SUBCASE("Every blink fits and ends dark") {
+    for (auto signal : {Blinker::Signal::ONCE, Blinker::Signal::REPEAT}) {
+      const Pattern &pattern = Blinker::getPattern(signal);
+      size_t size = compileBrightness(pattern, entries.data(), entries.size());
+      REQUIRE(size > 0);
+      // Dark as well where a repeat starts over.
+      CHECK(entries[size - 1].compare[0] == 0);
+    }
+  }
+}
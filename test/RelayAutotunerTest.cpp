@@ -0,0 +1,114 @@
+#include <doctest.h>
+#include "RelayAutotuner.h"
+#include "VirtualClock.h"
+#include <deque>
+
+namespace {
+
+constexpr float kAmbient = 20.0f;
+
+// First-order-plus-dead-time plant read once per second.
+struct Plant {
+  float gain = 200.0f;
+  float time_constant_ms = 600.0f * 1000;
+  uint32_t dead_time_ms = 15000;
+
+  float temp = kAmbient;
+  std::deque<float> powers;
+
+  TemperatureEstimator::Estimate step(uint32_t time_ms, float power) {
+    powers.push_back(power);
+    float delayed_power = 0.0f;
+    if (powers.size() > dead_time_ms / 1000) {
+      delayed_power = powers.front();
+      powers.pop_front();
+    }
+    float slope = (gain * delayed_power - (temp - kAmbient)) / time_constant_ms;
+    temp += slope * 1000;
+    TemperatureEstimator::Estimate estimate;
+    estimate.last_update_ms = time_ms;
+    estimate.value = temp;
+    estimate.slope = slope;
+    estimate.count = 1;
+    return estimate;
+  }
+};
+
+} // namespace
+
+TEST_CASE("RelayAutotuner Logic") {
+  VirtualClock clock;
+  Context context{clock, Log};
+  AutotuneConfig config;
+  RelayAutotuner autotuner(context, config);
+  Plant plant;
+  float target = 60.0f;
+
+  auto run = [&](uint32_t duration_ms) {
+    RelayAutotuner::Status status = RelayAutotuner::Status::kRunning;
+    for (uint32_t t = 0; t < duration_ms; t += 1000) {
+      clock.set(t);
+      status = autotuner.update(plant.step(t, autotuner.getPower()), target);
+      if (status != RelayAutotuner::Status::kRunning) {
+        break;
+      }
+    }
+    return status;
+  };
+
+  SUBCASE("Idle until started") {
+    CHECK(autotuner.getPower() == 0.0f);
+    CHECK(autotuner.update({}, target) == RelayAutotuner::Status::kFailed);
+  }
+
+  SUBCASE("Heats at full power first") {
+    autotuner.start();
+    CHECK(run(60 * 1000) == RelayAutotuner::Status::kRunning);
+    CHECK(autotuner.getPower() == config.max_power);
+  }
+
+  SUBCASE("Tunes the plant") {
+    autotuner.start();
+    REQUIRE(run(60 * 60 * 1000) == RelayAutotuner::Status::kDone);
+
+    RelayAutotuner::Measurement measurement = autotuner.getMeasurement();
+    CHECK(measurement.mean_temp ==
+          doctest::Approx(target).epsilon(0.01).scale(0));
+    // The power that holds the mean temperature.
+    CHECK(measurement.mean_power ==
+          doctest::Approx((measurement.mean_temp - kAmbient) / plant.gain)
+              .epsilon(0.02)
+              .scale(0));
+    // The dead time, plus the time the slope takes to turn.
+    CHECK(measurement.lag_ms >= plant.dead_time_ms);
+    CHECK(measurement.lag_ms < 2 * plant.dead_time_ms);
+    CHECK(measurement.period_ms > 4 * plant.dead_time_ms);
+
+    ThermalConfig base;
+    ThermalConfig tuned = autotuner.getTunedConfig(base);
+    CHECK(tuned.heat_loss_factor ==
+          doctest::Approx(1.0f / plant.gain).epsilon(0.02).scale(0));
+    CHECK(tuned.system_lag_ms == measurement.lag_ms);
+    CHECK(tuned.p_factor > 0.0f);
+    CHECK_FALSE(tuned.identify_plant);
+    CHECK(tuned.ambient_temp == base.ambient_temp);
+    CHECK(autotuner.getPower() == 0.0f);
+  }
+
+  SUBCASE("Fails when the target is out of reach") {
+    target = 300.0f;
+    autotuner.start();
+    CHECK(run(2 * 60 * 60 * 1000) == RelayAutotuner::Status::kFailed);
+    CHECK(autotuner.getPower() == 0.0f);
+  }
+
+  SUBCASE("Start restarts") {
+    autotuner.start();
+    REQUIRE(run(60 * 60 * 1000) == RelayAutotuner::Status::kDone);
+    clock.set(0);
+    plant = Plant();
+    autotuner.start();
+    CHECK(autotuner.getPower() == config.max_power);
+    CHECK(run(60 * 60 * 1000) == RelayAutotuner::Status::kDone);
+  }
+}
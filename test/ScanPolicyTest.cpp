@@ -0,0 +1,48 @@
+#include <doctest.h>
+#include "ScanPolicy.h"
+
+using Mode = ScanPolicy::Mode;
+
+TEST_CASE("ScanPolicy Logic") {
+  SUBCASE("Connects directly to the last probe first") {
+    ScanPolicy::Step step = ScanPolicy::getStep(0, true);
+    CHECK(step.mode == Mode::kDirect);
+    CHECK(step.end_ms == ScanPolicy::kDirectMs);
+    CHECK(ScanPolicy::getStep(ScanPolicy::kDirectMs, true).mode == Mode::kScan);
+  }
+
+  SUBCASE("Scans continuously without a last probe") {
+    ScanPolicy::Step step = ScanPolicy::getStep(0, false);
+    CHECK(step.mode == Mode::kScan);
+    CHECK(step.window_ms == step.interval_ms);
+    CHECK(step.end_ms == ScanPolicy::kFastScanMs);
+  }
+
+  SUBCASE("Backs off exponentially") {
+    uint32_t elapsed_ms = ScanPolicy::kFastScanMs;
+    for (uint16_t interval_ms : {200, 400, 800, 1600}) {
+      ScanPolicy::Step step = ScanPolicy::getStep(elapsed_ms, false);
+      CHECK(step.interval_ms == interval_ms);
+      CHECK(step.window_ms == ScanPolicy::kWindowMs);
+      CHECK(step.end_ms == elapsed_ms + ScanPolicy::kBackoffStepMs);
+      elapsed_ms = step.end_ms;
+    }
+    ScanPolicy::Step last = ScanPolicy::getStep(elapsed_ms, false);
+    CHECK(last.interval_ms == ScanPolicy::kMaxIntervalMs);
+    CHECK(last.end_ms == ScanPolicy::kForever);
+    CHECK(ScanPolicy::getStep(24 * 3600 * 1000, false) == last);
+  }
+
+  SUBCASE("Steps are contiguous") {
+    for (bool has_last_probe : {false, true}) {
+      uint32_t elapsed_ms = 0;
+      ScanPolicy::Step step = ScanPolicy::getStep(elapsed_ms, has_last_probe);
+      while (step.end_ms != ScanPolicy::kForever) {
+        CHECK(ScanPolicy::getStep(step.end_ms - 1, has_last_probe) == step);
+        ScanPolicy::Step next = ScanPolicy::getStep(step.end_ms, has_last_probe);
+        CHECK(next != step);
+        step = next;
+      }
+    }
+  }
+}
@@ -0,0 +1,44 @@
+#include <doctest.h>
+#include "Scheduler.h"
+#include "VirtualClock.h"
+
+TEST_CASE("Scheduler Logic") {
+  VirtualClock clock;
+  Scheduler scheduler(clock, 1000);
+  clock.set(5000);
+  scheduler.begin();
+
+  SUBCASE("Sleeps at most max_sleep_ms") {
+    CHECK(scheduler.getSleepMs() == 1000);
+    scheduler.requestUpdateIn(2000);
+    CHECK(scheduler.getSleepMs() == 1000);
+  }
+
+  SUBCASE("Earliest request wins") {
+    scheduler.requestUpdateAt(5300);
+    scheduler.requestUpdateIn(200);
+    scheduler.requestUpdateAt(5400);
+    CHECK(scheduler.getSleepMs() == 200);
+  }
+
+  SUBCASE("Overdue request does not sleep") {
+    scheduler.requestUpdateAt(4000);
+    CHECK(scheduler.getSleepMs() == 0);
+  }
+
+  SUBCASE("begin() discards previous requests") {
+    scheduler.requestUpdateIn(10);
+    clock.advance(10);
+    scheduler.begin();
+    CHECK(scheduler.getSleepMs() == 1000);
+  }
+
+  SUBCASE("Handles millis() wrap around") {
+    clock.set(0xFFFFFF00);
+    scheduler.begin();
+    scheduler.requestUpdateAt(0x00000010);
+    CHECK(scheduler.getSleepMs() == 0x110);
+    scheduler.requestUpdateAt(0xFFFFFE00);
+    CHECK(scheduler.getSleepMs() == 0);
+  }
+}
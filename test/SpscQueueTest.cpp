@@ -0,0 +1,74 @@
+#include <doctest.h>
+#include "SpscQueue.h"
+#include <thread>
+
+TEST_CASE("SpscQueue Logic") {
+  SpscQueue<int, 4> queue;
+  int value = 0;
+
+  SUBCASE("Initially empty") {
+    CHECK(queue.empty());
+    CHECK_FALSE(queue.pop(value));
+  }
+
+  SUBCASE("First in, first out") {
+    CHECK(queue.push(1));
+    CHECK(queue.push(2));
+    CHECK_FALSE(queue.empty());
+    CHECK(queue.pop(value));
+    CHECK(value == 1);
+    CHECK(queue.pop(value));
+    CHECK(value == 2);
+    CHECK(queue.empty());
+  }
+
+  SUBCASE("Full queue drops and counts") {
+    for (int i = 0; i < 4; ++i) {
+      CHECK(queue.push(i));
+    }
+    CHECK_FALSE(queue.push(4));
+    CHECK_FALSE(queue.push(5));
+    CHECK(queue.getOverflowCount() == 2);
+
+    CHECK(queue.pop(value));
+    CHECK(value == 0);
+    CHECK(queue.push(6));
+    for (int expected : {1, 2, 3, 6}) {
+      CHECK(queue.pop(value));
+      CHECK(value == expected);
+    }
+  }
+
+  SUBCASE("Wraps around") {
+    for (int i = 0; i < 10; ++i) {
+      CHECK(queue.push(i));
+      CHECK(queue.pop(value));
+      CHECK(value == i);
+    }
+    CHECK(queue.getOverflowCount() == 0);
+  }
+
+  SUBCASE("Producer and consumer threads") {
+    constexpr int kCount = 100000;
+    std::thread producer([&] {
+      for (int i = 0; i < kCount; ++i) {
+        while (!queue.push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    bool in_order = true;
+    for (int expected = 0; expected < kCount;) {
+      if (queue.pop(value)) {
+        in_order &= value == expected++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+
+    CHECK(in_order);
+    CHECK(queue.empty());
+  }
+}
@@ -9,7 +9,8 @@ using namespace fakeit;
 TEST_CASE("StoveActuator Logic") {
 
   Fake(Method(ArduinoFake(), delayMicroseconds));
-  Fake(Method(ArduinoFake(), millis));
+  Mock<Clock> clock_mock;
+  Fake(Method(clock_mock, millis));
   Mock<Potentiometer> potentiometer_mock;
   Mock<DigitalWritePin> bypass_mock;
 
@@ -18,7 +19,9 @@ TEST_CASE("StoveActuator Logic") {
 
   ThrottleConfig config;
 
-  StoveActuator actuator(potentiometer_mock.get(), bypass_mock.get(), config);
+  Context context{clock_mock.get(), Log};
+  StoveActuator actuator(context, potentiometer_mock.get(), bypass_mock.get(),
+                         config);
   // NOTE: After construction, actuator is in bypass mode.
 
   SUBCASE("setBypass sets bypass mode") {
@@ -37,7 +40,7 @@ TEST_CASE("StoveActuator Logic") {
   SUBCASE("Normal operation (no boost)") {
     StoveThrottle throttle{.position = 0.5f, .boost = 0};
 
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(2000);
+    When(Method(clock_mock, millis)).AlwaysReturn(2000);
 
     // First call is in bypass.
     actuator.setThrottle(throttle);
@@ -47,7 +50,7 @@ TEST_CASE("StoveActuator Logic") {
 
     // Call again, no longer in bypass.
     // throttle.boost (0) == current_boost_ (0)
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(3001); // > 1000ms later
+    When(Method(clock_mock, millis)).AlwaysReturn(3001); // > 1000ms later
     actuator.setThrottle(throttle);
     Verify(Method(potentiometer_mock, setValue).Using(0.5f * config.max)).Twice();
   }
@@ -58,36 +61,36 @@ TEST_CASE("StoveActuator Logic") {
     const float arm_value = config.max + (config.arm - config.max) / 2; // 0.84f
 
     // 1. First call. is_bypass_ = true.
-    When(Method(ArduinoFake(), millis)).Return(10000);
+    When(Method(clock_mock, millis)).Return(10000);
     actuator.setThrottle(throttle_reset);
     // Enters bypass, setting value and disabling bypass
     Verify(Method(potentiometer_mock, setValue).Using(config.max)).Once();
 
     // 2. Second call, start boosting.
-    When(Method(ArduinoFake(), millis)).Return(11001);
+    When(Method(clock_mock, millis)).Return(11001);
     actuator.setThrottle(throttle);
     Verify(Method(potentiometer_mock, setValue).Using(1.0f)).Once();
 
     // 3. Third call, continue boosting.
     // Logic toggles: High -> Low (arm_value)
-    When(Method(ArduinoFake(), millis)).Return(12002);
+    When(Method(clock_mock, millis)).Return(12002);
     actuator.setThrottle(throttle);
     Verify(Method(potentiometer_mock, setValue).Using(arm_value)).Once();
 
     // 4. Fourth call, pulse high again to reach boost 2
-    When(Method(ArduinoFake(), millis)).Return(13003);
+    When(Method(clock_mock, millis)).Return(13003);
     actuator.setThrottle(throttle);
     Verify(Method(potentiometer_mock, setValue).Using(1.0f)).Twice();
 
     // 5. Fifth call, finish pulse, increment boost to 2.
     // Logic toggles: High -> Low (arm_value)
-    When(Method(ArduinoFake(), millis)).Return(14004);
+    When(Method(clock_mock, millis)).Return(14004);
     actuator.setThrottle(throttle);
     Verify(Method(potentiometer_mock, setValue).Using(arm_value)).Twice();
 
     // 6. Sixth call, steady state (boost 2 == boost 2).
     // Should maintain value (arm_value) and NOT reset.
-    When(Method(ArduinoFake(), millis)).Return(15005);
+    When(Method(clock_mock, millis)).Return(15005);
     actuator.setThrottle(throttle);
     Verify(Method(potentiometer_mock, setValue).Using(arm_value)).Twice();
   }
@@ -99,18 +102,18 @@ TEST_CASE("StoveActuator Logic") {
     // 1. Get to boost state first
     StoveThrottle boost_throttle{.position = 1.0f, .boost = 1};
     // First call, bypass.
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(10000);
+    When(Method(clock_mock, millis)).AlwaysReturn(10000);
     actuator.setThrottle(boost_throttle);
     Verify(Method(potentiometer_mock, setValue).Using(deboost_value)).Once();
 
     // Second call, boosting
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(11001);
+    When(Method(clock_mock, millis)).AlwaysReturn(11001);
     actuator.setThrottle(boost_throttle);
     Verify(Method(potentiometer_mock, setValue).Using(1.0f)).Once(); // current_boost becomes 1
 
     // 2. Cancel boost
     StoveThrottle zero_throttle{.position = 0.5f, .boost = 0};
-    When(Method(ArduinoFake(), millis)).AlwaysReturn(11002);
+    When(Method(clock_mock, millis)).AlwaysReturn(11002);
     actuator.setThrottle(zero_throttle);
 
     // Logic: throttle.boost (0) < current_boost_ (1).
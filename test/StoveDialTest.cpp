@@ -1,19 +1,33 @@
 #include "StoveDial.h"
 #include "AnalogReadPin.h"
+#include "NullLogger.h"
+#include "SyntheticAnalogReadPin.h"
+#include "VirtualClock.h"
 #include <ArduinoFake.h>
+#include <cmath>
 #include <doctest.h>
+#include <random>
 
 using namespace fakeit;
 
 TEST_CASE("StoveDial Logic") {
+  Mock<Clock> clock_mock;
   Mock<AnalogReadPin> pin_mock;
   ThrottleConfig config;
-  StoveDial dial(pin_mock.get(), config);
+  Context context{clock_mock.get(), Log};
+  StoveDial dial(context, pin_mock.get(), config);
+  uint32_t now_ms = 0;
+  When(Method(clock_mock, millis)).AlwaysDo([&] { return now_ms; });
 
-  // Helper to stabilize the moving average (size 4)
+  // Helper to let the filter settle on a value, 10 ms per update
   auto set_reading = [&](float val) {
     When(Method(pin_mock, read)).AlwaysDo([&] { return val; });
-    for (int i = 0; i < 4; ++i) {
+    When(Method(pin_mock, readBlock)).AlwaysDo([&](float *samples, size_t) {
+      samples[0] = val;
+      return size_t{1};
+    });
+    for (int i = 0; i < 500; ++i) {
+      now_ms += 10;
       dial.update();
     }
   };
@@ -66,3 +80,107 @@ TEST_CASE("StoveDial Logic") {
     }
   }
 }
+
+TEST_CASE("StoveDial Blocks") {
+  VirtualClock clock;
+  NullLogger log;
+  SyntheticAnalogReadPin pin;
+  ThrottleConfig config;
+  Context context{clock, log};
+  StoveDial dial(context, pin, config);
+
+  auto update = [&]() {
+    clock.advance(10);
+    dial.update();
+  };
+
+  SUBCASE("Reduces a block to its mean") {
+    pin.pushBlock({0.30f, 0.40f, 0.50f, 0.60f, 0.70f});
+    update();
+    CHECK(dial.getPosition() == doctest::Approx(0.5f / config.max));
+  }
+
+  SUBCASE("Blocks of any size weigh the same") {
+    pin.pushBlock(std::vector<float>(StoveDial::kMaxBlockSize, 0.4f));
+    update();
+    pin.pushBlock({0.4f});
+    update();
+    CHECK(dial.getPosition() == doctest::Approx(0.4f / config.max));
+  }
+
+  SUBCASE("Holds the last block while none is new") {
+    pin.pushBlock({0.2f});
+    update();
+    pin.pushBlock({0.35f, 0.35f});
+    for (int i = 0; i < 500; ++i) {
+      update();
+    }
+    CHECK(dial.getPosition() == doctest::Approx(0.35f / config.max));
+  }
+}
+
+// ADC noise as seen on the dial input: a few LSB of white noise and the
+// odd glitch of 2% of the range.
+TEST_CASE("StoveDial Noise") {
+  VirtualClock clock;
+  NullLogger log;
+  SyntheticAnalogReadPin pin;
+  ThrottleConfig config;
+  Context context{clock, log};
+  StoveDial dial(context, pin, config);
+
+  std::minstd_rand rng(1);
+  std::normal_distribution<float> white(0.0f, 0.003f);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  auto noisy = [&](float value) {
+    float glitch = uniform(rng) < 0.02f ? 0.02f : 0.0f;
+    return value + white(rng) + (uniform(rng) < 0.5f ? glitch : -glitch);
+  };
+  auto update = [&](float value) {
+    pin.pushBlock({noisy(value)});
+    clock.advance(10);
+    dial.update();
+  };
+
+  SUBCASE("No flicker resting on a threshold") {
+    for (float threshold : {config.min, config.boil}) {
+      for (int i = 0; i < 100; ++i) {
+        update(threshold + 0.05f);
+      }
+      bool is_off = dial.isOff();
+      bool is_boil = dial.isBoil();
+      for (int i = 0; i < 6000; ++i) {
+        update(threshold);
+        CHECK(dial.isOff() == is_off);
+        CHECK(dial.isBoil() == is_boil);
+      }
+    }
+  }
+
+  SUBCASE("Little jitter at rest") {
+    for (int i = 0; i < 100; ++i) {
+      update(0.4f);
+    }
+    double squared_error_sum = 0.0;
+    for (int i = 0; i < 6000; ++i) {
+      update(0.4f);
+      float error = dial.getPosition() * config.max - 0.4f;
+      squared_error_sum += error * error;
+    }
+    // Half the input noise, which a 4-update average left at two thirds.
+    CHECK(std::sqrt(squared_error_sum / 6000) < 0.0015);
+  }
+
+  SUBCASE("Follows a spun knob") {
+    for (int i = 0; i < 100; ++i) {
+      update(0.2f);
+    }
+    // From 0.2 to 0.6 in 100 ms.
+    for (int t = 10; t <= 100; t += 10) {
+      update(0.2f + 0.4f * t / 100);
+    }
+    update(0.6f);
+    update(0.6f);
+    CHECK(dial.getPosition() * config.max == doctest::Approx(0.6f).epsilon(0.02));
+  }
+}
@@ -8,9 +8,11 @@
 #include "ThermalController.h"
 #include "Beeper.h"
 #include "Potentiometer.h"
-#include "TrendAnalyzer.h"
+#include "TemperatureEstimator.h"
 #include "Thermometer.h"
+#include "RelayAutotuner.h"
 #include "Logger.h"
+#include "Scheduler.h"
 
 // Interfaces
 #include "AnalogReadPin.h"
@@ -32,18 +34,22 @@ TEST_CASE("StoveSupervisor Logic") {
   Mock<StoveDial> dial_mock;
   Mock<StoveActuator> actuator_mock;
   Mock<Beeper> beeper_mock;
-  Mock<TrendAnalyzer> analyzer_mock;
+  Mock<TemperatureEstimator> estimator_mock;
   Mock<ThermalController> controller_mock;
   Mock<Thermometer> thermometer_mock;
+  Mock<RelayAutotuner> autotuner_mock;
+  Mock<Clock> clock_mock;
+  Context context{clock_mock.get(), Log};
 
   // --- DUT ---
-  StoveSupervisor supervisor(dial_mock.get(), actuator_mock.get(),
+  StoveSupervisor supervisor(context, dial_mock.get(), actuator_mock.get(),
                              controller_mock.get(), beeper_mock.get(),
-                             analyzer_mock.get(), thermometer_mock.get(),
-                             stove_config, throttle_config);
+                             estimator_mock.get(), thermometer_mock.get(),
+                             autotuner_mock.get(), stove_config,
+                             throttle_config);
 
   uint32_t current_time_ms = 0;
-  When(Method(ArduinoFake(), millis)).AlwaysDo([&]() { return current_time_ms; });
+  When(Method(clock_mock, millis)).AlwaysDo([&]() { return current_time_ms; });
   auto set_time = [&](uint32_t t) {
     current_time_ms = t;
   };
@@ -58,14 +64,14 @@ TEST_CASE("StoveSupervisor Logic") {
   Fake(Method(actuator_mock, setThrottle));
   Fake(Method(actuator_mock, update));
   Fake(Method(beeper_mock, beep));
-  Fake(Method(beeper_mock, update));
   When(Method(controller_mock, getPower)).AlwaysReturn(0.0f);
   Fake(Method(controller_mock, setTargetTemp));
   Fake(Method(controller_mock, update));
+  Fake(Method(controller_mock, reset));
   Fake(Method(thermometer_mock, start));
   Fake(Method(thermometer_mock, stop));
   When(Method(thermometer_mock, connected)).AlwaysReturn(false);
-  When(Method(analyzer_mock, getLastUpdateMs)).AlwaysReturn(0);
+  When(Method(estimator_mock, getLastUpdateMs)).AlwaysReturn(0);
 
   auto reset_actuator = [&]() {
     actuator_mock.Reset();
@@ -86,6 +92,7 @@ TEST_CASE("StoveSupervisor Logic") {
     When(Method(controller_mock, getPower)).AlwaysReturn(0.0f);
     Fake(Method(controller_mock, setTargetTemp));
     Fake(Method(controller_mock, update));
+    Fake(Method(controller_mock, reset));
   };
 
   SUBCASE("Initial state is SLEEP") {
@@ -147,7 +154,6 @@ TEST_CASE("StoveSupervisor Logic") {
       When(Method(dial_mock, isBoil)).AlwaysReturn(true);
       beeper_mock.Reset();
       Fake(Method(beeper_mock, beep));
-      Fake(Method(beeper_mock, update));
 
       supervisor.update();
 
@@ -164,7 +170,6 @@ TEST_CASE("StoveSupervisor Logic") {
       When(Method(thermometer_mock, connected)).AlwaysReturn(true);
       beeper_mock.Reset();
       Fake(Method(beeper_mock, beep));
-      Fake(Method(beeper_mock, update));
       supervisor.update(); // CONNECTED
 
       Verify(Method(beeper_mock, beep)).Never();
@@ -203,6 +208,79 @@ TEST_CASE("StoveSupervisor Logic") {
       supervisor.update();
       // ACTIVE entry sets throttle to 0
       Verify(Method(actuator_mock, setThrottle)).Once();
+      // A new session identifies the pot afresh
+      Verify(Method(controller_mock, reset)).Once();
+    }
+
+    SUBCASE("Flick off auto and back starts AUTOTUNE") {
+      Fake(Method(autotuner_mock, start));
+      set_time(1000);
+      When(Method(dial_mock, isBoil)).AlwaysReturn(false);
+      supervisor.update();
+      set_time(1500);
+      When(Method(dial_mock, isBoil)).AlwaysReturn(true);
+      supervisor.update();
+
+      Verify(Method(autotuner_mock, start)).Once();
+      Verify(Method(controller_mock, reset)).Once();
+      Verify(Method(beeper_mock, beep).Using(Beeper::Signal::ACCEPT))
+          .AtLeastOnce();
+      Verify(Method(actuator_mock, setBypass)).Never();
+
+      When(Method(estimator_mock, getLastUpdateMs)).AlwaysReturn(1500);
+      When(Method(estimator_mock, getEstimate))
+          .AlwaysReturn(TemperatureEstimator::Estimate{});
+      When(Method(controller_mock, getTargetTemp)).AlwaysReturn(60.0f);
+
+      SUBCASE("Relay drives the throttle") {
+        When(Method(autotuner_mock, update))
+            .AlwaysReturn(RelayAutotuner::Status::kRunning);
+        When(Method(autotuner_mock, getPower)).AlwaysReturn(0.4f);
+        reset_actuator();
+        set_time(1500 + 301);
+        supervisor.update();
+        Verify(Method(actuator_mock, setThrottle)
+                   .Matching([](StoveThrottle throttle) {
+                     // 0.4 of power is half the base level.
+                     return isNear(throttle, {0.5f, 0});
+                   }))
+            .Once();
+        Verify(Method(controller_mock, update)).Never();
+      }
+
+      SUBCASE("Applies the tuned config and goes ACTIVE") {
+        ThermalConfig tuned;
+        tuned.p_factor = 0.3f;
+        When(Method(autotuner_mock, update))
+            .AlwaysReturn(RelayAutotuner::Status::kDone);
+        When(Method(autotuner_mock, getTunedConfig)).AlwaysReturn(tuned);
+        ThermalConfig current;
+        When(Method(controller_mock, getConfig))
+            .AlwaysDo([&]() -> const ThermalConfig & { return current; });
+        Fake(Method(controller_mock, setConfig));
+        set_time(1500 + 301);
+        supervisor.update();
+        Verify(Method(controller_mock, setConfig)
+                   .Matching([](const ThermalConfig &config) {
+                     return config.p_factor == 0.3f;
+                   }))
+            .Once();
+
+        // Now under thermal control.
+        set_time(1500 + 301 + 301);
+        supervisor.update();
+        Verify(Method(controller_mock, update)).Once();
+      }
+
+      SUBCASE("Falls back to ACTIVE on failure") {
+        Fake(Method(controller_mock, setConfig));
+        When(Method(autotuner_mock, update))
+            .AlwaysReturn(RelayAutotuner::Status::kFailed);
+        set_time(1500 + 301);
+        supervisor.update();
+        Verify(Method(controller_mock, setConfig)).Never();
+        Verify(Method(beeper_mock, beep).Using(Beeper::Signal::ERROR)).Once();
+      }
     }
   }
 
@@ -242,7 +320,6 @@ TEST_CASE("StoveSupervisor Logic") {
     SUBCASE("Transition ACTIVE -> DISCONNECTED on signal loss") {
       set_time(3001 + 30001);
       beeper_mock.Reset();
-      Fake(Method(beeper_mock, update));
       Fake(Method(beeper_mock, beep));
 
       When(Method(beeper_mock, beep)).AlwaysDo([&](Beeper::Signal s) {
@@ -259,7 +336,7 @@ TEST_CASE("StoveSupervisor Logic") {
       Verify(Method(beeper_mock, beep)).Once();
 
       SUBCASE("Transition DISCONNECTED -> ACTIVE on signal recovery") {
-        When(Method(analyzer_mock, getLastUpdateMs)).AlwaysReturn(3001 + 30001);
+        When(Method(estimator_mock, getLastUpdateMs)).AlwaysReturn(3001 + 30001);
         When(Method(dial_mock, getPosition)).AlwaysReturn(0.5f);
 
         When(Method(actuator_mock, setThrottle)).AlwaysDo([&](const StoveThrottle &t) {
@@ -302,4 +379,37 @@ TEST_CASE("StoveSupervisor Logic") {
       Verify(Method(thermometer_mock, start)).Once();
     }
   }
+
+  SUBCASE("Scheduling") {
+    Scheduler scheduler(clock_mock.get(), 1000);
+    Fake(Method(actuator_mock, schedule));
+
+    SUBCASE("Polls the dial slowly while asleep") {
+      scheduler.begin();
+      supervisor.schedule(scheduler);
+      CHECK(scheduler.getSleepMs() == 100);
+      CHECK(supervisor.isIdle());
+      Verify(Method(actuator_mock, schedule)).Once();
+    }
+
+    SUBCASE("Polls the dial quickly while in use") {
+      supervisor.update(); // SCANNING
+      scheduler.begin();
+      supervisor.schedule(scheduler);
+      CHECK(scheduler.getSleepMs() == 10);
+      CHECK(!supervisor.isIdle());
+    }
+
+    SUBCASE("Wakes up for the COOLDOWN timeout") {
+      supervisor.update(); // SCANNING
+      When(Method(dial_mock, isOff)).AlwaysReturn(true);
+      set_time(1001);
+      supervisor.update(); // COOLDOWN
+      set_time(1001 + 10 * 1000 - 20);
+      scheduler.begin();
+      supervisor.schedule(scheduler);
+      CHECK(scheduler.getSleepMs() == 21);
+      CHECK(supervisor.isIdle());
+    }
+  }
 }
@@ -0,0 +1,119 @@
+#include <doctest.h>
+#include "TelemetryFramer.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+uint16_t u16(const std::vector<uint8_t> &frame, size_t offset) {
+  return frame[offset] | frame[offset + 1] << 8;
+}
+
+int16_t i16(const std::vector<uint8_t> &frame, size_t offset) {
+  return static_cast<int16_t>(u16(frame, offset));
+}
+
+uint32_t u32(const std::vector<uint8_t> &frame, size_t offset) {
+  return u16(frame, offset) | static_cast<uint32_t>(u16(frame, offset + 2))
+                                  << 16;
+}
+
+std::vector<uint8_t> pack(TelemetryFramer &framer, size_t frame_size) {
+  std::vector<uint8_t> frame(frame_size);
+  frame.resize(framer.pack(frame.data(), frame.size()));
+  return frame;
+}
+
+TelemetrySample makeSample(uint32_t time_ms) {
+  TelemetrySample sample;
+  sample.time_ms = time_ms;
+  sample.target_temp = 85.0f;
+  sample.temp = 21.375f;
+  sample.slope = 0.0005f;
+  sample.power = 0.5f;
+  sample.state = 4;
+  sample.flags = TelemetryFramer::kLidOpen;
+  return sample;
+}
+
+} // namespace
+
+TEST_CASE("TelemetryFramer Logic") {
+  TelemetryFramer framer;
+
+  SUBCASE("Packs the header and samples") {
+    framer.addSample(makeSample(5000));
+    framer.addSample(makeSample(5100));
+    std::vector<uint8_t> frame = pack(framer, 244);
+
+    REQUIRE(frame.size() == TelemetryFramer::kHeaderSize +
+                                2 * TelemetryFramer::kSampleSize);
+    CHECK(frame[0] == TelemetryFramer::kVersion);
+    CHECK(frame[1] == 2);
+    CHECK(u16(frame, 2) == 0);
+    CHECK(u32(frame, 4) == 5000);
+
+    size_t second = TelemetryFramer::kHeaderSize + TelemetryFramer::kSampleSize;
+    CHECK(u16(frame, second) == 100);
+    CHECK(i16(frame, second + 2) == 8500);
+    CHECK(i16(frame, second + 4) == 2138);
+    CHECK(i16(frame, second + 6) == 500); // 0.5 °C/s
+    CHECK(frame[second + 8] == 128);
+    CHECK(frame[second + 9] == 4);
+    CHECK(frame[second + 10] == TelemetryFramer::kLidOpen);
+    CHECK(framer.getSampleCount() == 0);
+  }
+
+  SUBCASE("Fits the negotiated MTU") {
+    for (uint32_t i = 0; i < 5; ++i) {
+      framer.addSample(makeSample(i * 100));
+    }
+    // The default ATT MTU of 23 leaves 20 bytes, one sample.
+    CHECK(TelemetryFramer::getCapacity(20) == 1);
+    CHECK(TelemetryFramer::getCapacity(1000) == TelemetryFramer::kMaxSamples);
+
+    std::vector<uint8_t> first = pack(framer, 20);
+    CHECK(first.size() == 19);
+    CHECK(first[1] == 1);
+    std::vector<uint8_t> rest = pack(framer, 244);
+    CHECK(rest[1] == 4);
+    CHECK(u16(rest, 2) == 1);
+    CHECK(u32(rest, 4) == 100);
+    CHECK(pack(framer, 244).empty());
+  }
+
+  SUBCASE("Ready when full or old") {
+    framer.addSample(makeSample(1000));
+    CHECK_FALSE(framer.isFrameReady(244, 1500, 2000));
+    CHECK(framer.isFrameReady(244, 3000, 2000));
+    CHECK(framer.isFrameReady(20, 1000, 2000));
+  }
+
+  SUBCASE("Drops the oldest samples when full") {
+    for (uint32_t i = 0; i < TelemetryFramer::kMaxSamples + 3; ++i) {
+      framer.addSample(makeSample(i * 100));
+    }
+    std::vector<uint8_t> frame = pack(framer, 244);
+    CHECK(frame[1] == TelemetryFramer::kMaxSamples);
+    CHECK(u32(frame, 4) == 300);
+  }
+
+  SUBCASE("Starts a new frame where offsets overflow") {
+    framer.addSample(makeSample(0));
+    framer.addSample(makeSample(70000));
+    CHECK(pack(framer, 244)[1] == 1);
+    CHECK(u32(pack(framer, 244), 4) == 70000);
+  }
+
+  SUBCASE("Saturates and marks missing values") {
+    TelemetrySample sample = makeSample(0);
+    sample.temp = NAN;
+    sample.target_temp = 1000.0f;
+    sample.power = 2.0f;
+    framer.addSample(sample);
+    std::vector<uint8_t> frame = pack(framer, 244);
+    CHECK(i16(frame, 10) == INT16_MAX);
+    CHECK(i16(frame, 12) == TelemetryFramer::kNoValue);
+    CHECK(frame[16] == 255);
+  }
+}
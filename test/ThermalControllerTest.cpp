@@ -0,0 +1,113 @@
+#include <doctest.h>
+#include "ThermalController.h"
+#include "VirtualClock.h"
+#include <deque>
+
+namespace {
+
+constexpr float kAmbient = 20.0f;
+
+// Reports an exact first-order-plus-dead-time plant, stepped once per second.
+class PlantEstimator : public TemperatureEstimator {
+public:
+  void step(uint32_t time_ms, float power) {
+    powers_.push_back(power);
+    float delayed_power = 0.0f;
+    if (powers_.size() > kDeadTimeMs / 1000) {
+      delayed_power = powers_.front();
+      powers_.pop_front();
+    }
+    float slope =
+        (kGain * delayed_power - (estimate_.value - kAmbient)) / kTimeConstantMs;
+    estimate_.value += slope * 1000;
+    estimate_.last_update_ms = time_ms;
+    estimate_.slope = slope;
+    estimate_.count = 1;
+  }
+
+  void addReading(float, uint32_t) override {}
+  void clear() override {}
+  Estimate getEstimate() const override { return estimate_; }
+
+private:
+  static constexpr float kGain = 200.0f;
+  static constexpr float kTimeConstantMs = 600.0f * 1000;
+  static constexpr uint32_t kDeadTimeMs = 15000;
+
+  Estimate estimate_{0, kAmbient};
+  std::deque<float> powers_;
+};
+
+} // namespace
+
+TEST_CASE("ThermalController Config") {
+  VirtualClock clock;
+  Context context{clock, Log};
+  PlantEstimator estimator;
+  ThermalConfig base;
+  ThermalController controller(context, estimator, base);
+  controller.setTargetTemp(70.0f);
+
+  auto run = [&](ThermalController &c, uint32_t from_ms, uint32_t to_ms) {
+    for (uint32_t t = from_ms; t < to_ms; t += 1000) {
+      clock.set(t);
+      estimator.step(t, c.getPower());
+      c.update();
+    }
+  };
+
+  // What an autotune would hand over.
+  ThermalConfig tuned = base;
+  tuned.p_factor = 0.05f;
+  tuned.system_lag_ms = 40000;
+  tuned.heat_loss_factor = 0.004f;
+  tuned.identify_plant = false;
+
+  SUBCASE("Tuned values win over the identified plant") {
+    run(controller, 0, 60 * 60 * 1000);
+    REQUIRE(controller.isPlantIdentified());
+
+    controller.setConfig(tuned);
+    CHECK_FALSE(controller.isPlantIdentified());
+
+    // Same estimate, same power as a controller that only ever had the tune.
+    ThermalController reference(context, estimator, tuned);
+    reference.setTargetTemp(70.0f);
+    uint32_t t = 60 * 60 * 1000;
+    clock.set(t);
+    controller.update();
+    reference.update();
+    CHECK(controller.getPower() == reference.getPower());
+
+    // And it stays that way while samples keep coming.
+    run(controller, t + 1000, t + 20 * 60 * 1000);
+    CHECK_FALSE(controller.isPlantIdentified());
+    CHECK(controller.getConfig().system_lag_ms == tuned.system_lag_ms);
+  }
+
+  SUBCASE("Takes a reading stamped after the latch as current") {
+    run(controller, 0, 60 * 1000);
+    REQUIRE(estimator.getEstimate().slope > 0.0f);
+
+    // Without lookahead, so the prediction is of now too.
+    ThermalConfig now_only = base;
+    now_only.system_lag_ms = 0;
+    ThermalController heating(context, estimator, now_only);
+    heating.setTargetTemp(70.0f);
+    clock.set(60 * 1000);
+    estimator.step(60 * 1000 + 1, 1.0f);
+    heating.update();
+    CHECK(heating.getPower() == 1.0f);
+  }
+
+  SUBCASE("Reset drops the tune") {
+    controller.setConfig(tuned);
+    CHECK(controller.getConfig().system_lag_ms == tuned.system_lag_ms);
+
+    controller.reset();
+    CHECK(controller.getConfig().p_factor == base.p_factor);
+    CHECK(controller.getConfig().system_lag_ms == base.system_lag_ms);
+    CHECK(controller.getConfig().heat_loss_factor == base.heat_loss_factor);
+    CHECK(controller.getConfig().identify_plant);
+  }
+}
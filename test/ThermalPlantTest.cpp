@@ -0,0 +1,139 @@
+#include "NullLogger.h"
+#include "Simulation.h"
+#include "ThermalPlant.h"
+#include <doctest.h>
+#include <vector>
+
+TEST_CASE("ThermalPlant Model") {
+  PlantConfig config;
+
+  SUBCASE("Settles where losses match the burner") {
+    ThermalPlant plant(config);
+    plant.setPower(0.25f);
+    for (int i = 0; i < 4 * 60 * 60; ++i) {
+      plant.step(1000);
+    }
+    float expected = config.ambient_temp + 0.25f * config.max_power_w *
+                                               config.efficiency /
+                                               config.heat_loss_w_per_k;
+    CHECK(plant.getTemp() == doctest::Approx(expected).epsilon(0.01));
+    CHECK(plant.getProbeTemp() == doctest::Approx(plant.getTemp()));
+  }
+
+  SUBCASE("Does not heat beyond boiling") {
+    ThermalPlant plant(config);
+    plant.setPower(1.0f);
+    for (int i = 0; i < 4 * 60 * 60; ++i) {
+      plant.step(1000);
+    }
+    CHECK(plant.getTemp() == config.boiling_temp);
+  }
+
+  SUBCASE("Burner and probe lag") {
+    ThermalPlant plant(config);
+    plant.setPower(1.0f);
+    plant.step(static_cast<uint32_t>(config.burner_lag_ms));
+    CHECK(plant.getBurnerPowerW() ==
+          doctest::Approx(0.632f * config.max_power_w).epsilon(0.01));
+    CHECK(plant.getProbeTemp() < plant.getTemp());
+  }
+}
+
+TEST_CASE("StoveModel Knob Decoding") {
+  ThrottleConfig config;
+  StoveModel stove(config, 0.8f);
+
+  SUBCASE("Off below min") {
+    stove.setKnob(config.min / 2);
+    CHECK(stove.getPower() == 0.0f);
+  }
+
+  SUBCASE("Linear level up to max") {
+    stove.setKnob(config.max / 2);
+    CHECK(stove.getPower() == doctest::Approx(0.4f));
+  }
+
+  SUBCASE("Boost pulses") {
+    const float arm_value = (config.max + config.arm) / 2;
+    stove.setKnob(arm_value);
+    CHECK(stove.getPower() == doctest::Approx(0.8f));
+
+    stove.setKnob(1.0f);
+    CHECK(stove.getPower() == doctest::Approx(0.9f));
+
+    // Holding the pulse does not count twice.
+    stove.setKnob(1.0f);
+    CHECK(stove.getPower() == doctest::Approx(0.9f));
+
+    stove.setKnob(arm_value);
+    stove.setKnob(1.0f);
+    CHECK(stove.getPower() == doctest::Approx(1.0f));
+
+    stove.setKnob(config.max - 0.01f);
+    CHECK(stove.getPower() < 0.8f);
+  }
+}
+
+TEST_CASE("Closed Loop Simulation") {
+  Scenario scenario;
+  scenario.duration_ms = 30 * 60 * 1000;
+  SUBCASE("Regression") { scenario.estimator = EstimatorType::kRegression; }
+  SUBCASE("Kalman") { scenario.estimator = EstimatorType::kKalman; }
+  Simulation simulation(scenario, Log);
+
+  SimulationResult result = simulation.run();
+
+  CHECK(simulation.getTimeMs() == scenario.duration_ms);
+  CHECK_FALSE(simulation.isBypass());
+  CHECK(result.rise_time_ms > 0);
+  CHECK(result.overshoot < 10.0f);
+  CHECK(result.final_temp ==
+        doctest::Approx(scenario.target_temp).epsilon(0.1));
+  CHECK(result.estimate_rms_error < 0.1f);
+  REQUIRE(simulation.getController().isPlantIdentified());
+  // Full controller power is 1600 W without boost, lost at 8 W/K.
+  CHECK(simulation.getController().getPlantModel().gain ==
+        doctest::Approx(200.0f).epsilon(0.1));
+}
+
+TEST_CASE("Autotune Simulation") {
+  Scenario scenario;
+  scenario.autotune = true;
+  scenario.target_temp = 70.0f;
+  scenario.duration_ms = 60 * 60 * 1000;
+  Simulation simulation(scenario, Log);
+
+  SimulationResult result = simulation.run();
+
+  const ThermalConfig &config = simulation.getController().getConfig();
+  // Full controller power is 1600 W without boost, lost at 8 W/K.
+  CHECK(config.heat_loss_factor ==
+        doctest::Approx(1 / 200.0f).epsilon(0.05).scale(0));
+  CHECK(config.system_lag_ms > 5000);
+  CHECK(config.system_lag_ms < 30000);
+  CHECK(config.p_factor != ThermalConfig().p_factor);
+  CHECK_FALSE(config.identify_plant);
+  CHECK_FALSE(simulation.getController().isPlantIdentified());
+  CHECK(result.final_temp ==
+        doctest::Approx(scenario.target_temp).epsilon(0.01));
+}
+
+TEST_CASE("Parallel Simulations") {
+  NullLogger logger;
+  std::vector<Scenario> scenarios(8);
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    scenarios[i].duration_ms = 20 * 60 * 1000;
+    scenarios[i].target_temp = 50.0f + 5.0f * i;
+    scenarios[i].seed = i + 1;
+  }
+
+  std::vector<SimulationResult> results = runScenarios(scenarios, logger);
+
+  REQUIRE(results.size() == scenarios.size());
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    SimulationResult expected = Simulation(scenarios[i], logger).run();
+    CHECK(results[i].rise_time_ms == expected.rise_time_ms);
+    CHECK(results[i].final_temp == expected.final_temp);
+    CHECK(results[i].energy_wh == expected.energy_wh);
+  }
+}
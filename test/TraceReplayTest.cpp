@@ -0,0 +1,73 @@
+#include <doctest.h>
+#include "NullLogger.h"
+#include "Simulation.h"
+#include "TraceReplay.h"
+#include "VectorTraceWriter.h"
+#include <cstring>
+
+TEST_CASE("TraceReplay Logic") {
+  NullLogger log;
+  Scenario scenario;
+  scenario.duration_ms = 20 * 60 * 1000;
+  VectorTraceWriter trace;
+  Simulation(scenario, log, &trace).run();
+  std::vector<uint8_t> data = trace.getData();
+
+  SUBCASE("Reproduces a session") {
+    SUBCASE("Regression") {}
+    SUBCASE("Kalman with autotune") {
+      scenario.estimator = EstimatorType::kKalman;
+      scenario.autotune = true;
+      VectorTraceWriter other_trace;
+      Simulation(scenario, log, &other_trace).run();
+      data = other_trace.getData();
+    }
+
+    ReplayResult result = replayTrace(data.data(), data.size(), log);
+    CHECK(result.error.empty());
+    CHECK(result.updates == scenario.duration_ms / Simulation::kTickMs);
+    CHECK(result.duration_ms == scenario.duration_ms - Simulation::kTickMs);
+    CHECK(result.mismatches == 0);
+    CHECK(result.diffs.empty());
+  }
+
+  SUBCASE("Reports outputs that differ") {
+    TraceHeader header;
+    std::memcpy(static_cast<void *>(&header), data.data(), sizeof(header));
+    header.thermal.p_factor *= 2;
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    ReplayResult result = replayTrace(data.data(), data.size(), log);
+    CHECK(result.error.empty());
+    CHECK(result.mismatches > 0);
+    REQUIRE(!result.diffs.empty());
+    CHECK(result.diffs[0].find("potentiometer") != std::string::npos);
+  }
+
+  SUBCASE("Rejects what is not a trace") {
+    data[0] = 0;
+    CHECK(replayTrace(data.data(), data.size(), log).error == "Not a trace");
+  }
+
+  SUBCASE("Reports a truncated trace") {
+    data.resize(data.size() - 1);
+    ReplayResult result = replayTrace(data.data(), data.size(), log);
+    CHECK(result.error.find("Truncated record") == 0);
+  }
+
+  SUBCASE("Stops where records were lost") {
+    data.push_back(static_cast<uint8_t>(TraceTag::kLost));
+    data.insert(data.end(), {3, 0, 0, 0});
+    data.push_back(static_cast<uint8_t>(TraceTag::kTick));
+    data.insert(data.end(), {10, 0});
+    ReplayResult result = replayTrace(data.data(), data.size(), log);
+    CHECK(result.error.find("Trace breaks off") == 0);
+  }
+
+  SUBCASE("Replays many traces at once") {
+    std::vector<TraceData> traces(8, TraceData{data.data(), data.size()});
+    for (const ReplayResult &result : replayTraces(traces, log)) {
+      CHECK(result.mismatches == 0);
+    }
+  }
+}
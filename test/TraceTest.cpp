@@ -0,0 +1,201 @@
+#include <doctest.h>
+#include "TraceBuffer.h"
+#include "NullLogger.h"
+#include "StoveDial.h"
+#include "SyntheticAnalogReadPin.h"
+#include "TraceReader.h"
+#include "TracingDevices.h"
+#include "VirtualClock.h"
+#include "VectorTraceWriter.h"
+#include <vector>
+
+namespace {
+
+class ReplayDialPin final : public AnalogReadPin {
+public:
+  float read() const override { return value; }
+  float value = 0.0f;
+};
+
+std::vector<TraceRecord> readAll(const std::vector<uint8_t> &data) {
+  TraceReader reader(data.data(), data.size());
+  TraceHeader header;
+  REQUIRE(reader.readHeader(&header));
+  std::vector<TraceRecord> records;
+  for (TraceRecord record; reader.next(&record);) {
+    records.push_back(record);
+  }
+  CHECK(reader.getError() == nullptr);
+  return records;
+}
+
+} // namespace
+
+TEST_CASE("TraceWriter Logic") {
+  VectorTraceWriter writer;
+
+  SUBCASE("Drops records before the header") {
+    writer.update(1000);
+    writer.dial(0.5f);
+    CHECK(writer.getData().empty());
+    writer.header({});
+    CHECK(writer.getData().size() == sizeof(TraceHeader));
+  }
+
+  writer.header({});
+
+  SUBCASE("Round trip") {
+    writer.update(1000);
+    writer.reading(25.5f, 990);
+    writer.dial(0.25f);
+    writer.connected(true);
+    writer.target(60.0f);
+    writer.potentiometer(0.7f);
+    writer.bypass(PinState::High);
+    writer.state(StoveSupervisor::State::ACTIVE);
+
+    std::vector<TraceRecord> records = readAll(writer.getData());
+    REQUIRE(records.size() == 8);
+    CHECK(records[0].tag == TraceTag::kTime);
+    CHECK(records[0].time_ms == 1000);
+    CHECK(records[1].tag == TraceTag::kReading);
+    CHECK(records[1].value == 25.5f);
+    CHECK(records[1].time_ms == 990);
+    CHECK(records[2].tag == TraceTag::kDial);
+    CHECK(records[2].value == 0.25f);
+    CHECK(records[3].tag == TraceTag::kConnected);
+    CHECK(records[3].integer == 1);
+    CHECK(records[4].tag == TraceTag::kTarget);
+    CHECK(records[4].value == 60.0f);
+    CHECK(records[5].tag == TraceTag::kPotentiometer);
+    CHECK(records[5].value == 0.7f);
+    CHECK(records[6].tag == TraceTag::kBypass);
+    CHECK(records[6].integer == static_cast<uint32_t>(PinState::High));
+    CHECK(records[7].tag == TraceTag::kState);
+    CHECK(records[7].toString() == "state ACTIVE");
+  }
+
+  SUBCASE("Updates are deltas while they fit") {
+    writer.update(1000);
+    writer.update(1010);
+    writer.update(1010 + 70000);
+    writer.update(1010 + 70010);
+
+    std::vector<TraceRecord> records = readAll(writer.getData());
+    REQUIRE(records.size() == 4);
+    CHECK(records[0].tag == TraceTag::kTime);
+    CHECK(records[1].tag == TraceTag::kTick);
+    CHECK(records[1].size == 3);
+    CHECK(records[1].time_ms == 1010);
+    CHECK(records[2].tag == TraceTag::kTime);
+    CHECK(records[3].tag == TraceTag::kTick);
+    CHECK(records[3].time_ms == 1010 + 70010);
+  }
+
+  SUBCASE("Samples and outputs only when they change") {
+    writer.dial(0.5f);
+    writer.dial(0.5f);
+    writer.dial(0.6f);
+    writer.connected(false);
+    writer.connected(false);
+    writer.potentiometer(0.1f);
+    writer.potentiometer(0.1f);
+    writer.state(StoveSupervisor::State::SLEEP);
+    writer.state(StoveSupervisor::State::SLEEP);
+    // Every write to the bypass pin counts.
+    writer.bypass(PinState::Low);
+    writer.bypass(PinState::Low);
+
+    CHECK(readAll(writer.getData()).size() == 7);
+  }
+}
+
+TEST_CASE("TraceBuffer Logic") {
+  TraceBuffer buffer;
+  buffer.header({});
+  std::vector<uint8_t> data(buffer.available());
+  CHECK(buffer.read(data.data(), data.size()) == sizeof(TraceHeader));
+  CHECK(buffer.available() == 0);
+
+  auto drain = [&]() {
+    uint8_t chunk[100];
+    while (size_t size = buffer.read(chunk, sizeof(chunk))) {
+      data.insert(data.end(), chunk, chunk + size);
+    }
+  };
+
+  SUBCASE("Passes records through") {
+    for (uint32_t t = 0; t < 10000; t += 10) {
+      buffer.update(t);
+      buffer.potentiometer(t / 10000.0f);
+      drain();
+    }
+    std::vector<TraceRecord> records = readAll(data);
+    REQUIRE(records.size() == 2000);
+    CHECK(records[1998].time_ms == 9990);
+    CHECK(records[1999].value == 0.999f);
+  }
+
+  SUBCASE("Marks lost records") {
+    // 5 + 3 bytes per update.
+    for (uint32_t t = 0; t < 20000; t += 10) {
+      buffer.update(t);
+      buffer.potentiometer(t / 20000.0f);
+    }
+    drain();
+    buffer.update(20000);
+    drain();
+
+    std::vector<TraceRecord> records = readAll(data);
+    REQUIRE(!records.empty());
+    CHECK(records.back().tag == TraceTag::kTick);
+    CHECK(records[records.size() - 2].tag == TraceTag::kLost);
+    CHECK(records[records.size() - 2].integer > 0);
+  }
+}
+
+TEST_CASE("TracingDialPin Logic") {
+  VirtualClock clock;
+  NullLogger log;
+  Context context{clock, log};
+  SyntheticAnalogReadPin pin;
+  SyntheticAnalogReadPin traced_source;
+  VectorTraceWriter writer;
+  writer.header({});
+  TracingDialPin traced_pin(traced_source, &writer);
+  StoveDial dial(context, pin, {});
+  StoveDial traced_dial(context, traced_pin, {});
+
+  // Blocks, with updates in between that find none.
+  for (int i = 0; i < 20; ++i) {
+    if (i % 3 != 2) {
+      std::vector<float> block;
+      for (int j = 0; j <= i % 5; ++j) {
+        block.push_back(0.1f + 0.013f * i + 0.007f * j);
+      }
+      pin.pushBlock(block);
+      traced_source.pushBlock(block);
+    }
+    writer.update(i * 10);
+    dial.update();
+    traced_dial.update();
+    // Reducing the blocks on the way changes nothing.
+    CHECK(traced_dial.getPosition() == dial.getPosition());
+  }
+
+  // At most one sample per update, holding while unchanged, which replays
+  // to the same position.
+  ReplayDialPin replay_pin;
+  StoveDial replay_dial(context, replay_pin, {});
+  std::vector<TraceRecord> records = readAll(writer.getData());
+  for (size_t i = 0; i < records.size(); ++i) {
+    if (records[i].tag == TraceTag::kDial) {
+      replay_pin.value = records[i].value;
+    }
+    if (i + 1 == records.size() || records[i + 1].isUpdate()) {
+      replay_dial.update();
+    }
+  }
+  CHECK(records.size() < 2 * 20);
+  CHECK(replay_dial.getPosition() == dial.getPosition());
+}
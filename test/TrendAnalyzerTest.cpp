@@ -1,8 +1,17 @@
 #include <doctest.h>
 #include "TrendAnalyzer.h"
+#include "NullLogger.h"
+#include "VirtualClock.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
 
 TEST_CASE("TrendAnalyzer Logic") {
-  TrendAnalyzer ta;
+  VirtualClock clock;
+  Context context{clock, Log};
+  TrendAnalyzer ta(context);
 
   SUBCASE("Initial state") {
     CHECK(ta.getValue(0) == 0.0f);
@@ -61,6 +70,42 @@ TEST_CASE("TrendAnalyzer Logic") {
     CHECK(ta.getSlope() == doctest::Approx(0.001f));
   }
 
+  SUBCASE("Reading older than a full window is dropped") {
+    for (int i = 1; i <= 15; ++i) {
+      ta.addReading(static_cast<float>(i), i * 1000);
+    }
+    ta.addReading(100.0f, 500);
+
+    CHECK(ta.getValue(15000) == doctest::Approx(15.0f));
+    CHECK(ta.getSlope() == doctest::Approx(0.001f));
+  }
+
+  SUBCASE("Out of order insertion into a full window") {
+    for (int i = 0; i < 15; ++i) {
+      ta.addReading(static_cast<float>(i), i * 2000);
+    }
+    // Lands between the two newest readings and evicts the oldest.
+    ta.addReading(13.5f, 27000);
+
+    CHECK(ta.getLastUpdateMs() == 28000);
+    CHECK(ta.getValue(28000) == doctest::Approx(14.0f));
+    CHECK(ta.getSlope() == doctest::Approx(0.0005f));
+  }
+
+  SUBCASE("Long session keeps precision") {
+    // Two hours of 1 Hz readings on a slow ramp, starting late in uptime.
+    const uint32_t start_ms = 4000000000u;
+    for (uint32_t i = 0; i < 2 * 60 * 60; ++i) {
+      float value = 20.0f + 0.01f * i + ((i % 2) ? 0.05f : -0.05f);
+      ta.addReading(value, start_ms + i * 1000);
+    }
+
+    uint32_t last_ms = start_ms + (2 * 60 * 60 - 1) * 1000;
+    CHECK(ta.getLastUpdateMs() == last_ms);
+    CHECK(ta.getValue(last_ms) == doctest::Approx(91.99f).epsilon(0.001));
+    CHECK(ta.getSlope() == doctest::Approx(0.00001f).epsilon(0.01).scale(0));
+  }
+
   SUBCASE("Out of order insertion") {
     // Insert 10, 30. Then insert 20.
     ta.addReading(10.0f, 1000);
@@ -85,7 +130,7 @@ TEST_CASE("TrendAnalyzer Logic") {
 
     CHECK(ta.getValue(t2) == doctest::Approx(20.0f));
     // Slope = (20 - 10) / 2001 ~= 0.0049975
-    CHECK(ta.getSlope() == doctest::Approx(0.0049975f).epsilon(0.001));
+    CHECK(ta.getSlope() == doctest::Approx(0.0049975f).epsilon(0.001).scale(0));
   }
   
   SUBCASE("Clear") {
@@ -98,4 +143,102 @@ TEST_CASE("TrendAnalyzer Logic") {
     CHECK(ta.getValue(2000) == 0.0f);
     CHECK(ta.getSlope() == 0.0f);
   }
-}
\ No newline at end of file
+
+  SUBCASE("Estimate") {
+    CHECK(ta.getEstimate().count == 0);
+    ta.addReading(10.0f, 1000);
+    ta.addReading(20.0f, 2000);
+
+    TrendAnalyzer::Estimate estimate = ta.getEstimate();
+    CHECK(estimate.last_update_ms == 2000);
+    CHECK(estimate.value == doctest::Approx(20.0f));
+    CHECK(estimate.slope == doctest::Approx(0.01f));
+    CHECK(estimate.count == 2);
+    CHECK(estimate.getValue(3000) == doctest::Approx(30.0f));
+    // Not before the newest reading, however close.
+    CHECK(estimate.getValue(1999) == doctest::Approx(20.0f));
+
+    ta.clear();
+    CHECK(ta.getEstimate().count == 0);
+  }
+
+  SUBCASE("Variances") {
+    ta.addReading(10.0f, 1000);
+    ta.addReading(20.0f, 2000);
+    CHECK(std::isinf(ta.getEstimate().slope_variance));
+
+    ta.addReading(30.0f, 3000);
+    CHECK(ta.getEstimate().value_variance == doctest::Approx(0.0f));
+    CHECK(ta.getEstimate().slope_variance == doctest::Approx(0.0f));
+
+    // Residuals of -0.1, 0.2, -0.1 around the line through 10, 20, 30.
+    ta.clear();
+    ta.addReading(9.9f, 1000);
+    ta.addReading(20.2f, 2000);
+    ta.addReading(29.9f, 3000);
+    TrendAnalyzer::Estimate estimate = ta.getEstimate();
+    // residual = 0.06 / (3 - 2), sum_xx = 2e6
+    CHECK(estimate.slope_variance ==
+          doctest::Approx(0.06f / 2e6f).epsilon(0.001).scale(0));
+    // residual * (1 / 3 + 1000^2 / sum_xx)
+    CHECK(estimate.value_variance ==
+          doctest::Approx(0.06f * (1 / 3.0f + 0.5f)));
+  }
+}
+
+TEST_CASE("TrendAnalyzer Concurrent Readers") {
+  VirtualClock clock;
+  NullLogger logger;
+  Context context{clock, logger};
+  TrendAnalyzer ta(context);
+
+  // Reading k is k at k seconds, and the window is cleared every 1000
+  // readings, so every field of an estimate follows from last_update_ms.
+  constexpr uint32_t kReadings = 200000;
+  constexpr uint32_t kClearEvery = 1000;
+  auto isConsistent = [](const TrendAnalyzer::Estimate &estimate) {
+    if (estimate.count == 0) {
+      return estimate.last_update_ms == 0 && estimate.value == 0.0f &&
+             estimate.slope == 0.0f;
+    }
+    uint32_t k = estimate.last_update_ms / 1000;
+    uint32_t count = std::min<uint32_t>(k % kClearEvery + 1,
+                                        TrendAnalyzer::kWindowSize);
+    float slope = count < 2 ? 0.0f : 0.001f;
+    return estimate.count == count &&
+           std::abs(estimate.value - k) <= 1e-6f * k &&
+           std::abs(estimate.slope - slope) <= 1e-6f;
+  };
+
+  std::atomic<bool> done = false;
+  std::atomic<uint32_t> inconsistent = 0;
+  std::atomic<uint32_t> snapshots = 0;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      uint32_t local_inconsistent = 0;
+      uint32_t local_snapshots = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        local_inconsistent += !isConsistent(ta.getEstimate());
+        ++local_snapshots;
+      }
+      inconsistent += local_inconsistent;
+      snapshots += local_snapshots;
+    });
+  }
+
+  for (uint32_t k = 1; k <= kReadings; ++k) {
+    if (k % kClearEvery == 0) {
+      ta.clear();
+    }
+    ta.addReading(k, k * 1000);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  CHECK(snapshots > 0);
+  CHECK(inconsistent == 0);
+  CHECK(isConsistent(ta.getEstimate()));
+}
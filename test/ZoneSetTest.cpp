@@ -0,0 +1,145 @@
+#include <doctest.h>
+#include "NullLogger.h"
+#include "ProbeRouter.h"
+#include "VirtualClock.h"
+#include "ZoneSet.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+class KnobPin final : public AnalogReadPin {
+public:
+  float read() const override { return value; }
+  float value = 0.0f;
+};
+
+class RecordingPotentiometer final : public Potentiometer {
+public:
+  void setValue(float new_value) override { value = new_value; }
+  float value = 0.0f;
+};
+
+class RecordingBypassPin final : public DigitalWritePin {
+public:
+  void set(PinState new_state) const override { state = new_state; }
+  mutable PinState state = PinState::High;
+};
+
+class QuietBuzzer final : public Buzzer {
+public:
+  void play(const Pattern &) override {}
+  void stop() override {}
+};
+
+class SharedThermometer final : public Thermometer {
+public:
+  void start() override { is_started = true; }
+  void stop() override { is_started = false; }
+  bool connected() override { return is_started; }
+  bool is_started = false;
+};
+
+// One burner's devices and its Zone, on `router` as zone `index`.
+struct Burner {
+  Burner(const Context &context, QuietBuzzer &buzzer, ProbeRouter &router,
+         size_t index)
+      : zone(context,
+             {dial_pin, potentiometer, bypass_pin, buzzer,
+              router.getThermometer(index)},
+             {}) {
+    router.setProbes(index, zone.getProbes());
+    zone.begin();
+  }
+
+  KnobPin dial_pin;
+  RecordingPotentiometer potentiometer;
+  RecordingBypassPin bypass_pin;
+  Zone zone;
+};
+
+} // namespace
+
+TEST_CASE("ZoneSet Logic") {
+  VirtualClock clock;
+  NullLogger log;
+  Context context{clock, log};
+  QuietBuzzer buzzer;
+  SharedThermometer shared;
+  ProbeRouter router(context, shared);
+  Burner left(context, buzzer, router, 0);
+  Burner right(context, buzzer, router, 1);
+  ZoneSet<2> zones(clock, 1000, {&left.zone, &right.zone});
+
+  // Runs the loop for `duration_ms`, waking when ZoneSet asks to, and
+  // returns how many zone updates it made.
+  auto run = [&](uint32_t duration_ms) {
+    size_t updates = 0;
+    for (uint32_t end = clock.millis() + duration_ms;
+         static_cast<int32_t>(clock.millis() - end) < 0;) {
+      updates += zones.update();
+      Scheduler scheduler(clock, 1000);
+      scheduler.begin();
+      zones.schedule(scheduler);
+      clock.advance(std::max<uint32_t>(scheduler.getSleepMs(), 1));
+    }
+    return updates;
+  };
+  using State = StoveSupervisor::State;
+
+  SUBCASE("Updates zones only when due") {
+    CHECK(zones.update() == 2);
+    CHECK(zones.update() == 0);
+    clock.advance(99);
+    CHECK(zones.update() == 0);
+    clock.advance(1);
+    CHECK(zones.update() == 2);
+    CHECK(zones.getDueMs(0) == 200);
+  }
+
+  SUBCASE("Updates a zone with new input before it is due") {
+    CHECK(zones.update() == 2);
+    clock.advance(10);
+    left.zone.getProbes().addReading(0, 40.0f, clock.millis());
+    CHECK(left.zone.hasInput());
+    CHECK(zones.update() == 1);
+    CHECK(!left.zone.hasInput());
+    CHECK(zones.update() == 0);
+    CHECK(zones.getDueMs(0) == 110);
+    CHECK(zones.getDueMs(1) == 100);
+
+    left.zone.getProbes().removeProbe(0);
+    CHECK(zones.update() == 1);
+  }
+
+  SUBCASE("Polls an idle zone sparsely") {
+    CHECK(run(10 * 1000) == 2 * 100);
+  }
+
+  SUBCASE("Controls one zone while the other sleeps") {
+    ThrottleConfig throttle;
+    left.dial_pin.value = (throttle.boil + 1.0f) / 2; // Auto
+    run(1000);
+    CHECK(left.zone.getSupervisor().getState() == State::SCANNING);
+    CHECK(shared.is_started);
+
+    // The probe goes to the zone searching for one.
+    router.addProbe(0, PeerAddress{});
+    for (uint32_t i = 0; i < 10; ++i) {
+      router.addReading(0, 40.0f, clock.millis());
+      run(1000);
+    }
+    CHECK(router.getZone(0) == 0);
+    CHECK(left.zone.getAnalyzer().getEstimate().count == 10);
+    CHECK(left.zone.getSupervisor().getState() == State::ACTIVE);
+    CHECK(left.bypass_pin.state == PinState::High);
+
+    CHECK(right.zone.getSupervisor().getState() == State::SLEEP);
+    CHECK(right.bypass_pin.state == PinState::Low);
+    CHECK(right.zone.getAnalyzer().getEstimate().count == 0);
+
+    // Cooking, the idle zone costs a tenth of the updates.
+    size_t updates = run(1000);
+    CHECK(updates == 100 + 10);
+  }
+}
@@ -0,0 +1,573 @@
+// Measures the cost of the hot paths in lib/src on the host, in ns per
+// operation and heap allocations per operation.
+//
+//   pio run -e bench && .pio/build/bench/program [options]
+//
+//   --filter <text>        Only run benchmarks whose name contains text
+//   --csv                  Print machine-readable results
+//   --compare <file>       Compare with results saved from --csv, and exit
+//                          with 1 if a benchmark got slower than the
+//                          threshold or allocates more
+//   --threshold <percent>  Allowed slowdown for --compare (default 10)
+//
+// Save a baseline with --csv before a change and compare after it:
+//
+//   .pio/build/bench/program --csv > before.csv
+//   .pio/build/bench/program --compare before.csv
+//
+// Host timings only rank changes against each other; the firmware runs the
+// same code an order of magnitude slower.
+
+#include "AnalogReadPin.h"
+#include "Beeper.h"
+#include "BinaryLogger.h"
+#include "Buzzer.h"
+#include "Context.h"
+#include "DigitalWritePin.h"
+#include "KalmanEstimator.h"
+#include "NullLogger.h"
+#include "Potentiometer.h"
+#include "RelayAutotuner.h"
+#include "StoveActuator.h"
+#include "StoveDial.h"
+#include "StoveSupervisor.h"
+#include "ThermalController.h"
+#include "Thermometer.h"
+#include "TrendAnalyzer.h"
+#include "VirtualClock.h"
+#include "Zone.h"
+#include "ZoneSet.h"
+#include "sfloat.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Counts every heap allocation of the process.
+namespace {
+std::atomic<uint64_t> allocations{0};
+} // namespace
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr auto kMinRunTime = std::chrono::milliseconds(100);
+constexpr int kRuns = 5;
+constexpr uint64_t kMaxIterations = 1000000000;
+
+// Keeps the compiler from optimizing away a result.
+template <typename T> void keep(const T &value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Hides where a pointer comes from, so calls through it stay virtual.
+template <typename T> T *opaque(T *pointer) {
+  asm volatile("" : "+r"(pointer));
+  return pointer;
+}
+
+struct BenchResult {
+  std::string name;
+  double ns_per_op = 0.0;
+  double allocs_per_op = 0.0;
+  uint64_t iterations = 0;
+};
+
+// Runs `op` for `iterations` and returns the elapsed nanoseconds.
+double timeOps(const std::function<void(uint64_t)> &op, uint64_t iterations) {
+  auto start = std::chrono::steady_clock::now();
+  op(iterations);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// `op(n)` performs n operations, so that the loop lives next to the code
+// under test. Reports the fastest of several runs, which is the least
+// disturbed by the rest of the machine.
+BenchResult measure(const char *name,
+                    const std::function<void(uint64_t)> &op) {
+  const double min_ns =
+      std::chrono::duration<double, std::nano>(kMinRunTime).count();
+  uint64_t iterations = 1;
+  for (double ns = timeOps(op, iterations);
+       ns < min_ns / 10 && iterations < kMaxIterations;
+       ns = timeOps(op, iterations)) {
+    iterations *= 10;
+  }
+  iterations = std::clamp<uint64_t>(
+      iterations * min_ns / std::max(1.0, timeOps(op, iterations)), 1,
+      kMaxIterations);
+
+  BenchResult result{name};
+  result.ns_per_op = 1e300;
+  uint64_t allocations_before = allocations.load();
+  for (int run = 0; run < kRuns; ++run) {
+    result.ns_per_op =
+        std::min(result.ns_per_op, timeOps(op, iterations) / iterations);
+  }
+  result.allocs_per_op =
+      static_cast<double>(allocations.load() - allocations_before) /
+      (iterations * kRuns);
+  result.iterations = iterations;
+  return result;
+}
+
+// Probe readings of a pot heating at 1°C/min, one per second, with noise.
+std::vector<float> makeReadings() {
+  std::minstd_rand rng(1);
+  std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+  std::vector<float> readings(1024);
+  for (size_t i = 0; i < readings.size(); ++i) {
+    readings[i] = 20.0f + i / 60.0f + noise(rng);
+  }
+  return readings;
+}
+
+class BenchPin final : public AnalogReadPin {
+public:
+  float read() const override { return value; }
+  float value = 0.0f;
+};
+
+class BenchPotentiometer final : public Potentiometer {
+public:
+  void setValue(float new_value) override { value = new_value; }
+  float value = 0.0f;
+};
+
+class BenchBypassPin final : public DigitalWritePin {
+public:
+  void set(PinState) const override {}
+};
+
+class BenchBuzzer final : public Buzzer {
+public:
+  void play(const Pattern &) override {}
+  void stop() override {}
+};
+
+class BenchThermometer final : public Thermometer {
+public:
+  void start() override {}
+  void stop() override {}
+  bool connected() override { return true; }
+};
+
+// A new estimate on every call, so the controller does its per-reading work.
+class SteppingEstimator final : public TemperatureEstimator {
+public:
+  explicit SteppingEstimator(const Clock &clock) : clock_(clock) {}
+
+  void addReading(float, uint32_t) override {}
+  void clear() override {}
+  Estimate getEstimate() const override {
+    Estimate estimate;
+    estimate.last_update_ms = clock_.millis();
+    estimate.value = 60.0f + (clock_.millis() / 1000 % 64) * 0.01f;
+    estimate.slope = 1e-5f;
+    estimate.count = 15;
+    return estimate;
+  }
+
+private:
+  const Clock &clock_;
+};
+
+// Passes everything on to nowhere, to time the << chain itself.
+class CountingLogger final : public Logger {
+public:
+  void log(const char *, size_t length) override { bytes += length; }
+  void log(long) override { bytes += 4; }
+  void log(unsigned long) override { bytes += 4; }
+  void log(float) override { bytes += 4; }
+  size_t bytes = 0;
+};
+
+NullLogger null_logger;
+
+// One burner of a multi-zone bench, on its own devices.
+struct BenchZone {
+  BenchZone(const Context &context, Buzzer &buzzer)
+      : zone(context, {pin, potentiometer, bypass_pin, buzzer, thermometer},
+             {}) {
+    zone.begin();
+  }
+
+  BenchPin pin;
+  BenchPotentiometer potentiometer;
+  BenchBypassPin bypass_pin;
+  BenchThermometer thermometer;
+  Zone zone;
+};
+
+// A 10 ms main loop over N zones, the first `active` of them cooking at
+// 70°C with a reading every second: `op(n)` runs n iterations.
+template <size_t N>
+std::function<void(uint64_t)> makeZoneLoop(size_t active,
+                                           const std::vector<float> &readings) {
+  return [active, &readings](uint64_t n) {
+    VirtualClock loop_clock;
+    Context loop_context{loop_clock, null_logger};
+    ThrottleConfig throttle;
+    StoveConfig stove;
+    BenchBuzzer buzzer;
+    std::array<std::optional<BenchZone>, N> burners;
+    std::array<Zone *, N> zone_list;
+    for (size_t i = 0; i < N; ++i) {
+      burners[i].emplace(loop_context, buzzer);
+      zone_list[i] = &burners[i]->zone;
+    }
+    ZoneSet<N> zones(loop_clock, 1000, zone_list);
+
+    uint64_t tick = 0;
+    auto step = [&]() {
+      if (tick % 100 == 0) {
+        for (size_t i = 0; i < active; ++i) {
+          burners[i]->zone.getProbes().addReading(
+              0, readings[tick / 100 % readings.size()], loop_clock.millis());
+        }
+      }
+      zones.update();
+      loop_clock.advance(10);
+      ++tick;
+    };
+    auto isActive = [&](size_t i) {
+      return burners[i]->zone.getSupervisor().getState() ==
+             StoveSupervisor::State::ACTIVE;
+    };
+    for (size_t i = 0; i < active; ++i) {
+      burners[i]->pin.value = (throttle.boil + 1.0f) / 2;
+    }
+    for (size_t i = 0; i < active; ++i) {
+      while (!isActive(i) && tick < 100000) {
+        step();
+      }
+      burners[i]->pin.value = (70.0f - stove.min_temp_c) /
+                              (stove.max_temp_c - stove.min_temp_c) *
+                              throttle.max;
+    }
+    for (int i = 0; i < 1000; ++i) {
+      step();
+    }
+    for (size_t i = 0; i < active; ++i) {
+      if (!isActive(i)) {
+        fprintf(stderr, "Zone %zu did not reach ACTIVE\n", i);
+        std::exit(2);
+      }
+    }
+
+    for (uint64_t i = 0; i < n; ++i) {
+      step();
+    }
+  };
+}
+
+std::vector<BenchResult> runBenchmarks(const char *filter) {
+  std::vector<std::pair<const char *, std::function<BenchResult()>>> benches;
+  auto add = [&](const char *name, std::function<void(uint64_t)> op) {
+    benches.push_back({name, [name, op]() { return measure(name, op); }});
+  };
+
+  const std::vector<float> readings = makeReadings();
+  VirtualClock clock;
+  Context context{clock, null_logger};
+
+  // TrendAnalyzer keeps calculateRegression private: every reading slides
+  // the window and refits, which is what this measures.
+  add("TrendAnalyzer::addReading", [&](uint64_t n) {
+    TrendAnalyzer analyzer(context);
+    for (uint64_t i = 0; i < n; ++i) {
+      analyzer.addReading(readings[i % readings.size()],
+                          static_cast<uint32_t>(i * 1000));
+    }
+    keep(analyzer);
+  });
+
+  add("TrendAnalyzer::getEstimate", [&](uint64_t n) {
+    TrendAnalyzer analyzer(context);
+    for (uint32_t i = 0; i < TrendAnalyzer::kWindowSize; ++i) {
+      analyzer.addReading(readings[i], i * 1000);
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+      keep(analyzer.getEstimate());
+    }
+  });
+
+  add("KalmanEstimator::addReading", [&](uint64_t n) {
+    KalmanEstimator estimator(context, {});
+    for (uint64_t i = 0; i < n; ++i) {
+      estimator.addReading(readings[i % readings.size()],
+                           static_cast<uint32_t>(i * 1000));
+    }
+    keep(estimator);
+  });
+
+  add("encodeIEEE11073", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      keep(encodeIEEE11073(readings[i % readings.size()]));
+    }
+  });
+
+  std::vector<std::array<uint8_t, 5>> encoded;
+  for (float reading : readings) {
+    encoded.push_back(encodeIEEE11073(reading));
+  }
+  add("decodeIEEE11073", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      keep(decodeIEEE11073(encoded[i % encoded.size()].data(), 5));
+    }
+  });
+
+  add("StoveDial::update", [&](uint64_t n) {
+    BenchPin pin;
+    StoveDial dial(context, pin, {});
+    for (uint64_t i = 0; i < n; ++i) {
+      pin.value = 0.4f + (i % 16) * 0.001f;
+      dial.update();
+    }
+    keep(dial);
+  });
+
+  // The main loop runs every 10 ms, and a new reading arrives every second.
+  add("ThermalController::update (same estimate)", [&](uint64_t n) {
+    VirtualClock controller_clock;
+    Context controller_context{controller_clock, null_logger};
+    TrendAnalyzer analyzer(controller_context);
+    for (uint32_t i = 0; i < TrendAnalyzer::kWindowSize; ++i) {
+      analyzer.addReading(readings[i], i * 1000);
+    }
+    ThermalController controller(controller_context, analyzer, {});
+    controller.setTargetTemp(60.0f);
+    for (uint64_t i = 0; i < n; ++i) {
+      controller_clock.advance(10);
+      controller.update();
+    }
+    keep(controller);
+  });
+
+  add("ThermalController::update (new estimate)", [&](uint64_t n) {
+    VirtualClock controller_clock;
+    Context controller_context{controller_clock, null_logger};
+    SteppingEstimator estimator(controller_clock);
+    ThermalController controller(controller_context, estimator, {});
+    controller.setTargetTemp(60.0f);
+    for (uint64_t i = 0; i < n; ++i) {
+      controller_clock.advance(1000);
+      controller.update();
+    }
+    keep(controller);
+  });
+
+  // A 10 ms main loop while cooking, with a reading every second.
+  add("StoveSupervisor::update (ACTIVE)", [&](uint64_t n) {
+    VirtualClock loop_clock;
+    Context loop_context{loop_clock, null_logger};
+    ThrottleConfig throttle;
+    StoveConfig stove;
+    BenchPin dial_pin;
+    BenchPotentiometer potentiometer;
+    BenchBypassPin bypass_pin;
+    BenchBuzzer buzzer;
+    BenchThermometer thermometer;
+    StoveActuator actuator(loop_context, potentiometer, bypass_pin, throttle);
+    StoveDial dial(loop_context, dial_pin, throttle);
+    Beeper beeper(loop_context, buzzer);
+    TrendAnalyzer analyzer(loop_context);
+    ThermalController controller(loop_context, analyzer, {});
+    RelayAutotuner autotuner(loop_context, {});
+    StoveSupervisor supervisor(loop_context, dial, actuator, controller, beeper,
+                               analyzer, thermometer, autotuner, stove,
+                               throttle);
+    actuator.setBypass();
+
+    uint64_t tick = 0;
+    auto step = [&]() {
+      if (tick % 100 == 0) {
+        analyzer.addReading(readings[tick / 100 % readings.size()],
+                            loop_clock.millis());
+      }
+      supervisor.update();
+      loop_clock.advance(10);
+      ++tick;
+    };
+    // Hold the knob at auto to activate, then turn it to 70°C.
+    dial_pin.value = (throttle.boil + 1.0f) / 2;
+    while (supervisor.getState() != StoveSupervisor::State::ACTIVE &&
+           tick < 100000) {
+      step();
+    }
+    dial_pin.value = (70.0f - stove.min_temp_c) /
+                     (stove.max_temp_c - stove.min_temp_c) * throttle.max;
+    for (int i = 0; i < 1000; ++i) {
+      step();
+    }
+    if (supervisor.getState() != StoveSupervisor::State::ACTIVE) {
+      fprintf(stderr, "StoveSupervisor did not reach ACTIVE\n");
+      std::exit(2);
+    }
+
+    for (uint64_t i = 0; i < n; ++i) {
+      step();
+    }
+  });
+
+  // Per loop iteration, whether a board with several burners is viable.
+  add("ZoneSet::update (1 zone, ACTIVE)", makeZoneLoop<1>(1, readings));
+  add("ZoneSet::update (4 zones, 1 ACTIVE)", makeZoneLoop<4>(1, readings));
+  add("ZoneSet::update (4 zones, ACTIVE)", makeZoneLoop<4>(4, readings));
+
+  // The level check only: the barrier keeps it from being hoisted out.
+  add("Logger << chain (disabled)", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      LOG_INFO(null_logger, kController)
+          << "Power " << readings[i % readings.size()] << " at "
+          << static_cast<uint32_t>(i) << "ms\n";
+      keep(i);
+    }
+  });
+
+  add("Logger << chain (virtual sink)", [&](uint64_t n) {
+    CountingLogger counting_logger;
+    Logger &logger = *opaque<Logger>(&counting_logger);
+    for (uint64_t i = 0; i < n; ++i) {
+      LOG_INFO(logger, kController)
+          << "Power " << readings[i % readings.size()] << " at "
+          << static_cast<uint32_t>(i) << "ms\n";
+    }
+    keep(counting_logger.bytes);
+  });
+
+  // Drained as the firmware does from idle time, so records are not lost.
+  add("Logger << chain (BinaryLogger)", [&](uint64_t n) {
+    static BinaryLogger logger;
+    std::array<uint8_t, 256> drain;
+    for (uint64_t i = 0; i < n; ++i) {
+      LOG_INFO(logger, kController)
+          << "Power " << readings[i % readings.size()] << " at "
+          << static_cast<uint32_t>(i) << "ms\n";
+      if (logger.available() > BinaryLogger::kCapacity / 2) {
+        while (logger.read(drain.data(), drain.size()) != 0) {
+        }
+      }
+    }
+  });
+
+  std::vector<BenchResult> results;
+  for (auto &[name, bench] : benches) {
+    if (!filter || strstr(name, filter)) {
+      results.push_back(bench());
+    }
+  }
+  return results;
+}
+
+// Reads results printed with --csv, by name.
+bool readBaseline(const char *path, std::map<std::string, BenchResult> *out) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    char *ns = strchr(line, ',');
+    if (!ns || strncmp(line, "benchmark,", 10) == 0) {
+      continue;
+    }
+    *ns++ = '\0';
+    BenchResult result{line};
+    char *end;
+    result.ns_per_op = strtod(ns, &end);
+    result.allocs_per_op = strtod(end + 1, &end);
+    result.iterations = strtoull(end + 1, nullptr, 10);
+    (*out)[result.name] = result;
+  }
+  fclose(file);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const char *filter = nullptr;
+  const char *baseline_path = nullptr;
+  bool csv = false;
+  double threshold = 10.0;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--filter") == 0 && has_value) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if (strcmp(argv[i], "--compare") == 0 && has_value) {
+      baseline_path = argv[++i];
+    } else if (strcmp(argv[i], "--threshold") == 0 && has_value) {
+      threshold = strtod(argv[++i], nullptr);
+    } else {
+      fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+      return 1;
+    }
+  }
+
+  std::map<std::string, BenchResult> baseline;
+  if (baseline_path && !readBaseline(baseline_path, &baseline)) {
+    fprintf(stderr, "Cannot read '%s'\n", baseline_path);
+    return 1;
+  }
+
+  std::vector<BenchResult> results = runBenchmarks(filter);
+
+  if (csv) {
+    printf("benchmark,ns_per_op,allocs_per_op,iterations\n");
+    for (const BenchResult &result : results) {
+      printf("%s,%.2f,%.3f,%llu\n", result.name.c_str(), result.ns_per_op,
+             result.allocs_per_op,
+             static_cast<unsigned long long>(result.iterations));
+    }
+    return 0;
+  }
+
+  bool regressed = false;
+  printf("%-44s %10s %10s", "benchmark", "ns/op", "allocs/op");
+  if (baseline_path) {
+    printf(" %10s %8s", "before", "change");
+  }
+  printf("\n");
+  for (const BenchResult &result : results) {
+    printf("%-44s %10.2f %10.3f", result.name.c_str(), result.ns_per_op,
+           result.allocs_per_op);
+    if (auto it = baseline.find(result.name); it != baseline.end()) {
+      const BenchResult &before = it->second;
+      double change = (result.ns_per_op / before.ns_per_op - 1.0) * 100.0;
+      bool slower = change > threshold;
+      bool allocates = result.allocs_per_op > before.allocs_per_op;
+      regressed |= slower || allocates;
+      printf(" %10.2f %+7.1f%%%s", before.ns_per_op, change,
+             slower ? " SLOWER" : allocates ? " ALLOCATES" : "");
+    }
+    printf("\n");
+  }
+  return regressed ? 1 : 0;
+}
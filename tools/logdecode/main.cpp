@@ -0,0 +1,129 @@
+// Decodes the log of a firmware built with KRC_BINARY_LOG back to text.
+//
+//   pio run -e logdecode
+//   stty -F /dev/ttyACM0 raw
+//   .pio/build/logdecode/program firmware.elf < /dev/ttyACM0
+//
+// where firmware.elf is .pio/build/xiaonrf52840_binlog/firmware.elf.
+//
+// Reads the binary log from the file given as second argument, or from stdin.
+// String literals are looked up in the ELF the firmware was built from; a
+// different build prints them as addresses.
+
+#include "LogDecoder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Maps addresses to the contents of the loadable sections of an ELF32 file.
+class ElfImage {
+public:
+  bool load(const char *path) {
+    std::ifstream file(path, std::ios::binary);
+    data_.assign(std::istreambuf_iterator<char>(file), {});
+    if (data_.size() < 52 || memcmp(data_.data(), "\x7f" "ELF", 4) != 0 ||
+        data_[4] != 1 /* ELFCLASS32 */ || data_[5] != 1 /* ELFDATA2LSB */) {
+      return false;
+    }
+    uint32_t shoff = read<uint32_t>(32);
+    uint16_t shentsize = read<uint16_t>(46);
+    uint16_t shnum = read<uint16_t>(48);
+    for (uint16_t i = 0; i < shnum; ++i) {
+      size_t header = shoff + i * shentsize;
+      if (header + 40 > data_.size()) {
+        return false;
+      }
+      uint32_t type = read<uint32_t>(header + 4);
+      uint32_t flags = read<uint32_t>(header + 8);
+      constexpr uint32_t kProgBits = 1;
+      constexpr uint32_t kAlloc = 2;
+      if (type != kProgBits || !(flags & kAlloc)) {
+        continue;
+      }
+      Section section{read<uint32_t>(header + 12), read<uint32_t>(header + 16),
+                      read<uint32_t>(header + 20)};
+      if (section.offset + section.size <= data_.size()) {
+        sections_.push_back(section);
+      }
+    }
+    return true;
+  }
+
+  std::optional<std::string> getString(uint32_t address) const {
+    for (const Section &section : sections_) {
+      if (address < section.address ||
+          address - section.address >= section.size) {
+        continue;
+      }
+      const char *begin = &data_[section.offset + address - section.address];
+      const char *end = &data_[section.offset + section.size];
+      return std::string(begin, std::find(begin, end, '\0'));
+    }
+    return std::nullopt;
+  }
+
+private:
+  struct Section {
+    uint32_t address;
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  template <typename T> T read(size_t offset) const {
+    T value;
+    memcpy(&value, &data_[offset], sizeof(value));
+    return value;
+  }
+
+  std::vector<char> data_;
+  std::vector<Section> sections_;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s <firmware.elf> [log]\n", argv[0]);
+    return 1;
+  }
+
+  ElfImage image;
+  if (!image.load(argv[1])) {
+    fprintf(stderr, "%s: not a little-endian ELF32 file\n", argv[1]);
+    return 1;
+  }
+
+  std::ifstream file;
+  if (argc == 3) {
+    file.open(argv[2], std::ios::binary);
+    if (!file) {
+      fprintf(stderr, "%s: cannot open\n", argv[2]);
+      return 1;
+    }
+  }
+  std::istream &input = argc == 3 ? file : std::cin;
+
+  LogDecoder decoder(
+      [&](uint32_t address) { return image.getString(address); });
+  // Byte by byte, to print each record as soon as it arrives from a port.
+  for (char c; input.get(c);) {
+    uint8_t byte = c;
+    if (std::string text = decoder.decode(&byte, 1); !text.empty()) {
+      std::cout << text << std::flush;
+    }
+  }
+
+  if (size_t errors = decoder.getErrorCount()) {
+    fprintf(stderr, "%zu malformed records\n", errors);
+  }
+  return 0;
+}
@@ -0,0 +1,137 @@
+// Replays recorded sessions through the control stack and diffs the outputs
+// against the recording.
+//
+//   pio run -e replay && .pio/build/replay/program [--verbose] trace...
+//
+// Traces come from a firmware built with KRC_TRACE, captured from Serial:
+//
+//   stty -F /dev/ttyACM0 raw
+//   cat /dev/ttyACM0 > session.trace
+//
+// or from the simulator with --trace. Each trace is replayed on its own
+// thread. Exits with 1 if any output differs or any trace is broken.
+
+#include "Logger.h"
+#include "NullLogger.h"
+#include "TraceReplay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Prints the firmware log of a single replay with --verbose.
+class ReplayLogger final : public Logger {
+public:
+  void log(const char *msg, size_t length) override {
+    std::cout.write(msg, length);
+  }
+  void log(long val) override { std::cout << val; }
+  void log(unsigned long val) override { std::cout << val; }
+  void log(float val) override { std::cout << val; }
+};
+
+// A read-only mapping of a whole file.
+class MappedFile {
+public:
+  explicit MappedFile(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+      void *data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const uint8_t *>(data);
+        size_ = status.st_size;
+      }
+    }
+    close(fd);
+  }
+  ~MappedFile() {
+    if (data_) {
+      munmap(const_cast<uint8_t *>(data_), size_);
+    }
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const uint8_t *getData() const { return data_; }
+  size_t getSize() const { return size_; }
+
+private:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool verbose = false;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+      return 1;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty()) {
+    fprintf(stderr, "Usage: %s [--verbose] trace...\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<MappedFile>> files;
+  std::vector<TraceData> traces;
+  for (const char *path : paths) {
+    files.push_back(std::make_unique<MappedFile>(path));
+    if (!files.back()->getData()) {
+      fprintf(stderr, "Cannot read '%s'\n", path);
+      return 1;
+    }
+    traces.push_back({files.back()->getData(), files.back()->getSize()});
+  }
+
+  ReplayLogger replay_logger;
+  NullLogger null_logger;
+  Logger &log = verbose && traces.size() == 1
+                    ? static_cast<Logger &>(replay_logger)
+                    : null_logger;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<ReplayResult> results = replayTraces(traces, log);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  int exit_code = 0;
+  uint64_t session_ms = 0;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const ReplayResult &result = results[i];
+    bool passed = result.error.empty() && result.mismatches == 0;
+    printf("%s %s: %u updates, %u records, %.0f s, %u mismatches\n",
+           passed ? "PASS" : "FAIL", paths[i], result.updates, result.records,
+           result.duration_ms / 1000.0f, result.mismatches);
+    if (!result.error.empty()) {
+      printf("  %s\n", result.error.c_str());
+    }
+    for (const std::string &diff : result.diffs) {
+      printf("  %s\n", diff.c_str());
+    }
+    exit_code |= !passed;
+    session_ms += result.duration_ms;
+  }
+  fprintf(stderr, "%zu traces, %.1f h of sessions in %.1f ms\n", results.size(),
+          session_ms / 3600e3,
+          std::chrono::duration<double, std::milli>(elapsed).count());
+  return exit_code;
+}
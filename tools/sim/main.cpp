@@ -0,0 +1,204 @@
+// Replays a cooking session against the thermal plant model, faster than
+// real time.
+//
+//   pio run -e sim && .pio/build/sim/program [options]
+//
+//   --pot milk|pot|stock   Pot preset (default pot)
+//   --estimator regression|kalman
+//                          Temperature estimator (default regression)
+//   --autotune             Flick the knob for a relay autotune first, and
+//                          print the tuned config
+//   --fixed-plant          Keep the configured lag and heat loss instead of
+//                          identifying the pot
+//   --target <°C>          Temperature set with the knob (default 90)
+//   --minutes <n>          Session length (default 120)
+//   --csv                  Print a time series every second
+//   --trace <file>         Record the session for tools/replay
+//   --verbose              Print the firmware log
+//   --sweep                Run every pot preset at targets from 40 to 100°C
+//                          in parallel and print one line per session
+
+#include "Logger.h"
+#include "NullLogger.h"
+#include "Simulation.h"
+#include "VectorTraceWriter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Prints the firmware log, disabled unless --verbose.
+class SimLogger final : public Logger {
+public:
+  SimLogger() { setLevel(LogLevel::kNone); }
+
+  void log(const char *msg, size_t length) override {
+    std::cout.write(msg, length);
+  }
+  void log(long val) override { std::cout << val; }
+  void log(unsigned long val) override { std::cout << val; }
+  void log(float val) override { std::cout << val; }
+};
+
+SimLogger logger;
+
+constexpr const char *kPots[] = {"milk", "pot", "stock"};
+
+bool applyPotPreset(const char *name, PlantConfig &plant) {
+  if (strcmp(name, "milk") == 0) {
+    plant.heat_capacity_j_per_k = 2500.0f; // 0.5 l in a small pan
+    plant.heat_loss_w_per_k = 3.0f;
+    plant.burner_lag_ms = 8000.0f;
+    return true;
+  }
+  if (strcmp(name, "pot") == 0) {
+    return true;
+  }
+  if (strcmp(name, "stock") == 0) {
+    plant.heat_capacity_j_per_k = 44000.0f; // 10 l stock pot
+    plant.heat_loss_w_per_k = 20.0f;
+    plant.probe_lag_ms = 10000.0f;
+    return true;
+  }
+  return false;
+}
+
+int runSweep(const Scenario &base) {
+  std::vector<Scenario> scenarios;
+  std::vector<const char *> pots;
+  for (const char *pot : kPots) {
+    for (float target = 40.0f; target <= 100.0f; target += 5.0f) {
+      Scenario scenario = base;
+      applyPotPreset(pot, scenario.plant);
+      scenario.target_temp = target;
+      scenarios.push_back(scenario);
+      pots.push_back(pot);
+    }
+  }
+
+  NullLogger null_logger;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<SimulationResult> results = runScenarios(scenarios, null_logger);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  printf("pot,target_c,rise_time_s,overshoot_c,rms_error_c,energy_wh,"
+         "estimate_rms_error_c\n");
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    const SimulationResult &result = results[i];
+    printf("%s,%.0f,%.1f,%.2f,%.2f,%.1f,%.3f\n", pots[i],
+           scenarios[i].target_temp, result.rise_time_ms / 1000.0f,
+           result.overshoot, result.rms_error, result.energy_wh,
+           result.estimate_rms_error);
+  }
+  fprintf(stderr, "%zu sessions in %.1f ms\n", scenarios.size(),
+          std::chrono::duration<double, std::milli>(elapsed).count());
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Scenario scenario;
+  bool csv = false;
+  bool sweep = false;
+  const char *trace_path = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--pot") == 0 && has_value) {
+      if (!applyPotPreset(argv[++i], scenario.plant)) {
+        fprintf(stderr, "Unknown pot '%s'\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--estimator") == 0 && has_value) {
+      const char *name = argv[++i];
+      if (strcmp(name, "regression") == 0) {
+        scenario.estimator = EstimatorType::kRegression;
+      } else if (strcmp(name, "kalman") == 0) {
+        scenario.estimator = EstimatorType::kKalman;
+      } else {
+        fprintf(stderr, "Unknown estimator '%s'\n", name);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--autotune") == 0) {
+      scenario.autotune = true;
+    } else if (strcmp(argv[i], "--fixed-plant") == 0) {
+      scenario.thermal.identify_plant = false;
+    } else if (strcmp(argv[i], "--target") == 0 && has_value) {
+      scenario.target_temp = strtof(argv[++i], nullptr);
+    } else if (strcmp(argv[i], "--minutes") == 0 && has_value) {
+      scenario.duration_ms = strtoul(argv[++i], nullptr, 10) * 60 * 1000;
+    } else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+      trace_path = argv[++i];
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if (strcmp(argv[i], "--sweep") == 0) {
+      sweep = true;
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      logger.setLevel(LogLevel::kDebug);
+    } else {
+      fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+      return 1;
+    }
+  }
+
+  if (sweep) {
+    return runSweep(scenario);
+  }
+
+  VectorTraceWriter trace;
+  Simulation simulation(scenario, logger, trace_path ? &trace : nullptr);
+
+  if (csv) {
+    printf("time_s,knob,bypass,power,burner_w,temp,probe_temp\n");
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  while (simulation.getTimeMs() < scenario.duration_ms) {
+    simulation.step();
+    if (csv && simulation.getTimeMs() % 1000 == 0) {
+      const ThermalPlant &plant = simulation.getPlant();
+      printf("%u,%.3f,%d,%.3f,%.0f,%.2f,%.2f\n",
+             simulation.getTimeMs() / 1000, simulation.getKnob(),
+             simulation.isBypass(), simulation.getController().getPower(),
+             plant.getBurnerPowerW(), plant.getTemp(), plant.getProbeTemp());
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  if (trace_path) {
+    FILE *file = fopen(trace_path, "wb");
+    if (!file || fwrite(trace.getData().data(), 1, trace.getData().size(),
+                        file) != trace.getData().size()) {
+      fprintf(stderr, "Cannot write '%s'\n", trace_path);
+      return 1;
+    }
+    fclose(file);
+  }
+
+  const SimulationResult &result = simulation.getResult();
+  printf("rise_time_s %.1f\n", result.rise_time_ms / 1000.0f);
+  printf("overshoot_c %.2f\n", result.overshoot);
+  printf("rms_error_c %.2f\n", result.rms_error);
+  printf("energy_wh %.1f\n", result.energy_wh);
+  printf("estimate_rms_error_c %.3f\n", result.estimate_rms_error);
+  printf("final_temp_c %.2f\n", result.final_temp);
+  if (scenario.autotune) {
+    const ThermalConfig &config = simulation.getController().getConfig();
+    printf("tuned_p_factor %.3f\n", config.p_factor);
+    printf("tuned_system_lag_s %.1f\n", config.system_lag_ms / 1000.0f);
+    printf("tuned_heat_loss_factor %.5f\n", config.heat_loss_factor);
+  }
+  if (simulation.getController().isPlantIdentified()) {
+    PlantModel model = simulation.getController().getPlantModel();
+    printf("plant_gain_c %.0f\n", model.gain);
+    printf("plant_time_constant_s %.0f\n", model.time_constant_ms / 1000);
+    printf("plant_dead_time_s %u\n", model.dead_time_ms / 1000);
+  }
+  printf("wall_time_ms %.1f\n",
+         std::chrono::duration<double, std::milli>(elapsed).count());
+  return 0;
+}